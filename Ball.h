@@ -2,17 +2,34 @@
 #define PHYSICSENGINE_BALL_H
 
 #include <SFML/Graphics.hpp>
+#include <cstddef>
 #include <cstdint>
 #include "Object.h"
+#include "PhysicsThread.h"
+#include "PhysicsWorld.h"
 
 struct Ball {
     Object physics;
     sf::CircleShape shape;
+    BodyHandle renderBody;   // render side copy of physics.body when a PhysicsThread owns the world
+    std::size_t listIndex = NotListed;   // slot in the game's ball list, for swap-and-pop removal
+
+    static constexpr std::size_t NotListed = static_cast<std::size_t>(-1);
 
     Ball(float x, float y, float r, sf::Color c) {
+        Reset(x, y, r, c);
+    }
+
+    // Reuse a ball from a free list as a new one. The shape keeps its vertex
+    // buffer, so this doesn't allocate.
+    void Reset(float x, float y, float r, sf::Color c) {
+        physics = Object{};
         physics.position = {x, y};
         physics.InitVerlet();  // Initialize oldPosition = position (starts at rest)
         physics.SetCircleCollider(r);
+        physics.userData = this;   // query results -> Ball
+        renderBody = BodyHandle{};
+        listIndex = NotListed;
         
         // Soften color
         sf::Color softened(
@@ -36,6 +53,18 @@ struct Ball {
         shape.setPosition(physics.position);
         w.draw(shape);
     }
+
+    // Ball behind a snapshot body, nullptr for bodies that aren't balls
+    static Ball* FromSnapshot(const RenderSnapshot& snapshot, BodyHandle body) {
+        if (!snapshot.Contains(body)) return nullptr;
+        return static_cast<Ball*>(snapshot.userData[body.id]);
+    }
+
+    // Render side: finds this ball's body in the snapshot once, then keeps the handle
+    bool FindIn(const RenderSnapshot& snapshot) {
+        if (!snapshot.Contains(renderBody)) renderBody = snapshot.FindLinked(&physics);
+        return renderBody.IsValid();
+    }
     
     float GetRadius() const {
         if (auto* circle = physics.GetCircleCollider()) {
@@ -0,0 +1,121 @@
+#ifndef PHYSICSENGINE_BALLBATCH_H
+#define PHYSICSENGINE_BALLBATCH_H
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "Ball.h"
+#include "PhysicsThread.h"
+#include "PhysicsWorld.h"
+#include "TrajectoryRecorder.h"
+
+/**
+ * Every ball in one vertex array, one draw call per frame
+ *
+ * Each ball is a triangle fan for the fill plus a ring for the outline,
+ * both flattened to plain triangles so they can share one array. The array
+ * is kept between frames and only resized when the ball count changes;
+ * positions are read straight from the world's body storage (interpolated).
+ */
+class BallBatch : public sf::Drawable {
+private:
+    std::size_t m_segments;
+    std::vector<sf::Vector2f> m_unitCircle;   // m_segments + 1 points, last == first
+    sf::VertexArray m_vertices;
+    std::size_t m_ballCount = 0;
+
+    std::size_t VerticesPerBall() const { return m_segments * 9; }   // 3 fill + 6 outline per segment
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        target.draw(m_vertices, states);
+    }
+
+    void WriteBall(std::size_t ball, sf::Vector2f center, float radius, float outline,
+                   sf::Color fillColor, sf::Color outlineColor) {
+        sf::Vertex* v = &m_vertices[ball * VerticesPerBall()];
+        const float outer = radius + outline;   // SFML outlines grow outwards
+
+        for (std::size_t s = 0; s < m_segments; ++s) {
+            const sf::Vector2f a = m_unitCircle[s];
+            const sf::Vector2f b = m_unitCircle[s + 1];
+
+            v[0] = {center, fillColor};
+            v[1] = {center + a * radius, fillColor};
+            v[2] = {center + b * radius, fillColor};
+
+            v[3] = {center + a * radius, outlineColor};
+            v[4] = {center + a * outer, outlineColor};
+            v[5] = {center + b * outer, outlineColor};
+            v[6] = {center + a * radius, outlineColor};
+            v[7] = {center + b * outer, outlineColor};
+            v[8] = {center + b * radius, outlineColor};
+            v += 9;
+        }
+    }
+
+public:
+    explicit BallBatch(std::size_t segments = 24)
+        : m_segments(segments), m_vertices(sf::PrimitiveType::Triangles) {
+        for (std::size_t s = 0; s <= m_segments; ++s) {
+            const float angle = 6.2831853f * static_cast<float>(s % m_segments) / static_cast<float>(m_segments);
+            m_unitCircle.push_back({std::cos(angle), std::sin(angle)});
+        }
+    }
+
+    // Once per frame before drawing
+    void update(const PhysicsWorld& world, const std::vector<std::unique_ptr<Ball>>& balls) {
+        if (balls.size() != m_ballCount) {
+            m_ballCount = balls.size();
+            m_vertices.resize(m_ballCount * VerticesPerBall());
+        }
+
+        const BodyStore& bodies = world.GetBodies();
+        const float alpha = world.GetInterpolationAlpha();
+
+        for (std::size_t i = 0; i < balls.size(); ++i) {
+            const Ball& ball = *balls[i];
+            sf::Vector2f center = ball.physics.position;
+            std::uint32_t index = bodies.IndexOf(ball.physics.body);
+            if (index != BodyStore::InvalidIndex) {
+                const sf::Vector2f previous = bodies.previousPositions[index];
+                center = previous + (bodies.positions[index] - previous) * alpha;
+            }
+
+            WriteBall(i, center, ball.GetRadius(), ball.shape.getOutlineThickness(),
+                      ball.shape.getFillColor(), ball.shape.getOutlineColor());
+        }
+    }
+
+    // Snapshot version, never touches the world or ball->physics positions.
+    // Balls the physics side hasn't added yet aren't drawn.
+    void update(const RenderSnapshot& snapshot, std::vector<std::unique_ptr<Ball>>& balls) {
+        m_ballCount = 0;
+        std::size_t needed = balls.size() * VerticesPerBall();
+        if (m_vertices.getVertexCount() < needed) m_vertices.resize(needed);
+
+        for (auto& ball : balls) {
+            if (!ball->FindIn(snapshot)) continue;
+            WriteBall(m_ballCount++, snapshot.Position(ball->renderBody), ball->shape.getRadius(),
+                      ball->shape.getOutlineThickness(), ball->shape.getFillColor(), ball->shape.getOutlineColor());
+        }
+        m_vertices.resize(m_ballCount * VerticesPerBall());
+    }
+
+    // Recorded frame (TrajectoryReader), every circle body in one color
+    void update(const TrajectoryFrame& frame, sf::Color fillColor, sf::Color outlineColor, float outline = 1.f) {
+        m_ballCount = 0;
+        std::size_t needed = frame.bodies.size() * VerticesPerBall();
+        if (m_vertices.getVertexCount() < needed) m_vertices.resize(needed);
+
+        for (const TrajectoryFrame::Body& body : frame.bodies) {
+            if (body.collider.type != ColliderType::Circle) continue;
+            WriteBall(m_ballCount++, body.position, body.collider.circle.radius, outline, fillColor, outlineColor);
+        }
+        m_vertices.resize(m_ballCount * VerticesPerBall());
+    }
+
+    std::size_t GetBallCount() const { return m_ballCount; }
+};
+
+#endif //PHYSICSENGINE_BALLBATCH_H
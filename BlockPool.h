@@ -0,0 +1,176 @@
+#ifndef PHYSICSENGINE_BLOCKPOOL_H
+#define PHYSICSENGINE_BLOCKPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Storage in fixed size blocks that never move
+ *
+ * Pointers to elements stay valid until the element is removed, but the
+ * elements still sit next to each other for the solver loops. Removed slots
+ * go on a free list and get reused by the next Emplace.
+ */
+template <typename T, std::size_t BlockSize = 256>
+class BlockPool {
+private:
+    struct Block {
+        alignas(T) unsigned char storage[BlockSize * sizeof(T)];
+        bool alive[BlockSize] = {};
+    };
+
+    std::vector<std::unique_ptr<Block>> m_blocks;
+    std::vector<std::pair<const unsigned char*, std::uint32_t>> m_blocksByAddress;  // for SlotOf
+    std::vector<std::uint32_t> m_free;
+    std::uint32_t m_slotCount = 0;   // high water mark
+    std::size_t m_size = 0;
+
+    T* Get(std::uint32_t slot) const {
+        Block& block = *m_blocks[slot / BlockSize];
+        return std::launder(reinterpret_cast<T*>(block.storage + (slot % BlockSize) * sizeof(T)));
+    }
+
+    void AddBlock() {
+        m_blocks.push_back(std::make_unique<Block>());
+        std::pair<const unsigned char*, std::uint32_t> entry = {
+            m_blocks.back()->storage, static_cast<std::uint32_t>(m_blocks.size() - 1)};
+        auto it = std::lower_bound(m_blocksByAddress.begin(), m_blocksByAddress.end(), entry,
+            [](const auto& a, const auto& b) { return std::less<const unsigned char*>()(a.first, b.first); });
+        m_blocksByAddress.insert(it, entry);
+    }
+
+public:
+    static constexpr std::uint32_t InvalidSlot = 0xFFFFFFFFu;
+
+    BlockPool() = default;
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    ~BlockPool() { Clear(); }
+
+    template <typename... Args>
+    T* Emplace(Args&&... args) {
+        std::uint32_t slot;
+        if (!m_free.empty()) {
+            slot = m_free.back();
+            m_free.pop_back();
+        } else {
+            slot = m_slotCount++;
+            if (slot / BlockSize >= m_blocks.size()) AddBlock();
+        }
+
+        Block& block = *m_blocks[slot / BlockSize];
+        T* item = new (block.storage + (slot % BlockSize) * sizeof(T)) T(std::forward<Args>(args)...);
+        block.alive[slot % BlockSize] = true;
+        ++m_size;
+        return item;
+    }
+
+    // Blocks for count slots up front, plus room on the free list for all of them
+    void Reserve(std::size_t count) {
+        while (m_blocks.size() * BlockSize < count) AddBlock();
+        m_free.reserve(count);
+    }
+
+    // Replaces everything with count elements, make(i) returning element i. Filled block
+    // by block into slots 0..count-1, no free list or per element bookkeeping (bulk loads).
+    template <typename Make>
+    void Assign(std::size_t count, Make&& make) {
+        Clear();
+        while (m_blocks.size() * BlockSize < count) AddBlock();
+        for (std::size_t b = 0; b * BlockSize < count; ++b) {
+            Block& block = *m_blocks[b];
+            const std::size_t end = std::min(BlockSize, count - b * BlockSize);
+            for (std::size_t i = 0; i < end; ++i) new (block.storage + i * sizeof(T)) T(make(b * BlockSize + i));
+            std::fill_n(block.alive, end, true);
+        }
+        m_slotCount = static_cast<std::uint32_t>(count);
+        m_size = count;
+    }
+
+    void RemoveSlot(std::uint32_t slot) {
+        if (!IsAlive(slot)) return;
+        Get(slot)->~T();
+        m_blocks[slot / BlockSize]->alive[slot % BlockSize] = false;
+        m_free.push_back(slot);
+        --m_size;
+    }
+
+    void Remove(const T* item) { RemoveSlot(SlotOf(item)); }
+
+    // O(log blocks)
+    std::uint32_t SlotOf(const T* item) const {
+        auto* address = reinterpret_cast<const unsigned char*>(item);
+        auto it = std::upper_bound(m_blocksByAddress.begin(), m_blocksByAddress.end(), address,
+            [](const unsigned char* a, const auto& b) { return std::less<const unsigned char*>()(a, b.first); });
+        if (it == m_blocksByAddress.begin()) return InvalidSlot;
+        --it;
+
+        std::size_t offset = static_cast<std::size_t>(address - it->first);
+        if (offset >= BlockSize * sizeof(T) || offset % sizeof(T) != 0) return InvalidSlot;
+        return it->second * static_cast<std::uint32_t>(BlockSize) + static_cast<std::uint32_t>(offset / sizeof(T));
+    }
+
+    bool IsAlive(std::uint32_t slot) const {
+        return slot < m_slotCount && m_blocks[slot / BlockSize]->alive[slot % BlockSize];
+    }
+
+    T& At(std::uint32_t slot) { return *Get(slot); }
+    const T& At(std::uint32_t slot) const { return *Get(slot); }
+
+    std::size_t Size() const { return m_size; }
+    bool Empty() const { return m_size == 0; }
+    std::uint32_t SlotCount() const { return m_slotCount; }
+
+    // fn(T&), every live element in slot order
+    template <typename Fn>
+    void ForEach(Fn&& fn) {
+        for (std::uint32_t b = 0; b * BlockSize < m_slotCount; ++b) {
+            Block& block = *m_blocks[b];
+            T* items = std::launder(reinterpret_cast<T*>(block.storage));
+            const std::uint32_t end = std::min<std::uint32_t>(BlockSize, m_slotCount - b * BlockSize);
+            for (std::uint32_t i = 0; i < end; ++i) {
+                if (block.alive[i]) fn(items[i]);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (std::uint32_t b = 0; b * BlockSize < m_slotCount; ++b) {
+            const Block& block = *m_blocks[b];
+            const T* items = std::launder(reinterpret_cast<const T*>(block.storage));
+            const std::uint32_t end = std::min<std::uint32_t>(BlockSize, m_slotCount - b * BlockSize);
+            for (std::uint32_t i = 0; i < end; ++i) {
+                if (block.alive[i]) fn(items[i]);
+            }
+        }
+    }
+
+    // fn(slot, T&)
+    template <typename Fn>
+    void ForEachSlot(Fn&& fn) {
+        for (std::uint32_t slot = 0; slot < m_slotCount; ++slot) {
+            if (IsAlive(slot)) fn(slot, *Get(slot));
+        }
+    }
+
+    void Clear() {
+        for (std::uint32_t slot = 0; slot < m_slotCount; ++slot) {
+            if (IsAlive(slot)) Get(slot)->~T();
+        }
+        m_blocks.clear();
+        m_blocksByAddress.clear();
+        m_free.clear();
+        m_slotCount = 0;
+        m_size = 0;
+    }
+};
+
+#endif //PHYSICSENGINE_BLOCKPOOL_H
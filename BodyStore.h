@@ -0,0 +1,262 @@
+#ifndef PHYSICSENGINE_BODYSTORE_H
+#define PHYSICSENGINE_BODYSTORE_H
+
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "Collider.h"
+
+struct Object;
+
+/**
+ * Handle to a body owned by a PhysicsWorld
+ *
+ * id is a slot in the sparse table, so it stays valid while other
+ * bodies get added/removed and the dense arrays shift around. The slot's
+ * generation goes up every time its body is removed, so a handle kept
+ * past RemoveBody() is stale (IsValid() in the world says no) instead of
+ * quietly pointing at whatever body reuses the slot.
+ */
+struct BodyHandle {
+    static constexpr std::uint32_t InvalidId = 0xFFFFFFFFu;
+
+    std::uint32_t id = InvalidId;
+    std::uint32_t generation = 0;
+
+    bool IsValid() const { return id != InvalidId; }
+    bool operator==(const BodyHandle& other) const { return id == other.id && generation == other.generation; }
+    bool operator!=(const BodyHandle& other) const { return !(*this == other); }
+};
+
+// Everything needed to create a body directly in the world. Every field has a
+// default, so partial designated initializers ({.position = p}) are warning free.
+struct BodyDesc {
+    sf::Vector2f position{};
+    float mass = 1.0f;
+    float bounciness = 0.7f;
+    bool isStatic = false;
+    Collider collider{};
+};
+
+/**
+ * Structure of arrays body storage
+ *
+ * Every column is indexed by the same dense index, so the Step loops just
+ * walk them front to back. Use IndexOf() to go from a handle to a dense index;
+ * dense indices are only good until the next Add/Remove/Permute.
+ *
+ * Remove is swap-and-pop: the last body moves into the hole, O(1). So the
+ * dense order depends on the add/remove history, but the same history gives
+ * the same order (and the same results) every run.
+ */
+class BodyStore {
+public:
+    static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+    // Sparse table entry per handle id
+    struct Slot {
+        std::uint32_t index = InvalidIndex;    // dense index, InvalidIndex while free
+        std::uint32_t generation = 0;
+    };
+
+    std::vector<sf::Vector2f> positions;
+    std::vector<sf::Vector2f> oldPositions;    // Verlet
+    std::vector<sf::Vector2f> accelerations;
+    std::vector<sf::Vector2f> previousPositions;   // start of the last fixed step, for render interpolation
+    std::vector<float> masses;
+    std::vector<float> bounciness;
+    std::vector<std::uint8_t> isStatic;
+    std::vector<Collider> colliders;           // inline shapes, no pointer per body
+    std::vector<Object*> linked;               // AddObject() compat, nullptr for plain bodies
+
+    // Sleeping
+    std::vector<std::uint8_t> asleep;
+    std::vector<std::uint16_t> restSteps;      // steps in a row below the sleep speed
+    std::vector<std::uint32_t> islands;        // island it fell asleep with, NoIsland while awake
+    std::vector<std::uint8_t> fixed;           // isStatic | asleep, kept up to date by whoever flips either
+
+    static constexpr std::uint32_t NoIsland = 0xFFFFFFFFu;
+
+    std::size_t Size() const { return positions.size(); }
+
+    // Static or asleep: not integrated, never written by constraints or contacts
+    bool IsFixed(std::uint32_t index) const { return fixed[index]; }
+
+    // Capacity for count bodies in every column, so Add doesn't allocate until then
+    void Reserve(std::size_t count) {
+        positions.reserve(count);
+        oldPositions.reserve(count);
+        accelerations.reserve(count);
+        previousPositions.reserve(count);
+        masses.reserve(count);
+        bounciness.reserve(count);
+        isStatic.reserve(count);
+        colliders.reserve(count);
+        linked.reserve(count);
+        asleep.reserve(count);
+        restSteps.reserve(count);
+        islands.reserve(count);
+        fixed.reserve(count);
+        m_ids.reserve(count);
+        m_slots.reserve(count);
+        m_freeIds.reserve(count);
+    }
+
+    BodyHandle Add(const BodyDesc& desc) {
+        std::uint32_t id;
+        if (!m_freeIds.empty()) {
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
+        } else {
+            id = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back({});
+        }
+
+        m_slots[id].index = static_cast<std::uint32_t>(Size());
+        m_ids.push_back(id);
+
+        positions.push_back(desc.position);
+        oldPositions.push_back(desc.position);   // starts at rest
+        accelerations.push_back({0.f, 0.f});
+        previousPositions.push_back(desc.position);
+        masses.push_back(desc.mass);
+        bounciness.push_back(desc.bounciness);
+        isStatic.push_back(desc.isStatic ? 1 : 0);
+        colliders.push_back(desc.collider);
+        linked.push_back(nullptr);
+        asleep.push_back(0);
+        restSteps.push_back(0);
+        islands.push_back(NoIsland);
+        fixed.push_back(desc.isStatic ? 1 : 0);
+
+        return BodyHandle{id, m_slots[id].generation};
+    }
+
+    // Swap-and-pop, O(1). The last body takes over the removed one's dense index.
+    void Remove(BodyHandle handle) {
+        std::uint32_t index = IndexOf(handle);
+        if (index == InvalidIndex) return;
+
+        const std::uint32_t last = static_cast<std::uint32_t>(Size() - 1);
+        if (index != last) {
+            positions[index] = positions[last];
+            oldPositions[index] = oldPositions[last];
+            accelerations[index] = accelerations[last];
+            previousPositions[index] = previousPositions[last];
+            masses[index] = masses[last];
+            bounciness[index] = bounciness[last];
+            isStatic[index] = isStatic[last];
+            colliders[index] = colliders[last];
+            linked[index] = linked[last];
+            asleep[index] = asleep[last];
+            restSteps[index] = restSteps[last];
+            islands[index] = islands[last];
+            fixed[index] = fixed[last];
+            m_ids[index] = m_ids[last];
+            m_slots[m_ids[index]].index = index;
+        }
+
+        positions.pop_back();
+        oldPositions.pop_back();
+        accelerations.pop_back();
+        previousPositions.pop_back();
+        masses.pop_back();
+        bounciness.pop_back();
+        isStatic.pop_back();
+        colliders.pop_back();
+        linked.pop_back();
+        asleep.pop_back();
+        restSteps.pop_back();
+        islands.pop_back();
+        fixed.pop_back();
+        m_ids.pop_back();
+
+        m_slots[handle.id].index = InvalidIndex;
+        ++m_slots[handle.id].generation;   // every handle to it is stale now
+        m_freeIds.push_back(handle.id);
+    }
+
+    // Body order[i] moves to dense index i (order has to be a permutation of 0..Size()-1).
+    // Handles follow their bodies, only dense indices change. Gathers every column
+    // into a new one, so it allocates - meant for an occasional pass, not every Step.
+    void Permute(std::span<const std::uint32_t> order) {
+        auto gather = [&](auto& column) {
+            std::remove_reference_t<decltype(column)> sorted;
+            sorted.reserve(column.capacity());
+            for (std::uint32_t from : order) sorted.push_back(column[from]);
+            column.swap(sorted);
+        };
+        gather(positions);
+        gather(oldPositions);
+        gather(accelerations);
+        gather(previousPositions);
+        gather(masses);
+        gather(bounciness);
+        gather(isStatic);
+        gather(colliders);
+        gather(linked);
+        gather(asleep);
+        gather(restSteps);
+        gather(islands);
+        gather(fixed);
+        gather(m_ids);
+
+        for (std::uint32_t i = 0; i < m_ids.size(); ++i) m_slots[m_ids[i]].index = i;
+    }
+
+    std::uint32_t IndexOf(BodyHandle handle) const {
+        if (handle.id >= m_slots.size()) return InvalidIndex;
+        const Slot& slot = m_slots[handle.id];
+        return slot.generation == handle.generation ? slot.index : InvalidIndex;
+    }
+
+    BodyHandle HandleAt(std::uint32_t index) const {
+        const std::uint32_t id = m_ids[index];
+        return BodyHandle{id, m_slots[id].generation};
+    }
+
+    bool Contains(BodyHandle handle) const { return IndexOf(handle) != InvalidIndex; }
+
+    // Dense index of whatever lives in slot id now, InvalidIndex if it's free
+    std::uint32_t IndexOfId(std::uint32_t id) const { return m_slots[id].index; }
+
+    // One past the highest handle id handed out so far (live or free)
+    std::size_t IdCount() const { return m_slots.size(); }
+
+    // Handle tables as raw arrays, for WorldSnapshot
+    const std::vector<Slot>& GetSlots() const { return m_slots; }
+    const std::vector<std::uint32_t>& GetIds() const { return m_ids; }
+    const std::vector<std::uint32_t>& GetFreeIds() const { return m_freeIds; }
+
+    // Replaces the handle tables in bulk. The columns must already hold ids.size()
+    // bodies; false (nothing changed) if the tables don't describe each other, i.e.
+    // unless every slot is either live (in ids, once) or free (in freeIds, once).
+    bool RestoreHandles(std::span<const Slot> slots, std::span<const std::uint32_t> ids,
+                        std::span<const std::uint32_t> freeIds) {
+        if (ids.size() != Size() || ids.size() + freeIds.size() != slots.size()) return false;
+        for (std::uint32_t i = 0; i < ids.size(); ++i) {
+            if (ids[i] >= slots.size() || slots[ids[i]].index != i) return false;
+        }
+        // Live ids can't repeat (each slot points back at one dense index), free ones could,
+        // and the counts adding up would then leave a slot orphaned
+        std::vector<std::uint8_t> freed(slots.size(), 0);
+        for (std::uint32_t id : freeIds) {
+            if (id >= slots.size() || slots[id].index != InvalidIndex || freed[id]) return false;
+            freed[id] = 1;
+        }
+
+        m_slots.assign(slots.begin(), slots.end());
+        m_ids.assign(ids.begin(), ids.end());
+        m_freeIds.assign(freeIds.begin(), freeIds.end());
+        return true;
+    }
+
+private:
+    std::vector<Slot> m_slots;                 // handle id -> dense index + generation
+    std::vector<std::uint32_t> m_ids;          // dense index -> handle id
+    std::vector<std::uint32_t> m_freeIds;
+};
+
+#endif //PHYSICSENGINE_BODYSTORE_H
@@ -0,0 +1,365 @@
+#include "Broadphase.h"
+#include <algorithm>
+#include <cmath>
+
+std::unique_ptr<Broadphase> MakeBroadphase(BroadphaseType type) {
+    switch (type) {
+        case BroadphaseType::BruteForce:  return std::make_unique<BruteForceBroadphase>();
+        case BroadphaseType::UniformGrid: return std::make_unique<UniformGridBroadphase>();
+        case BroadphaseType::SweepAndPrune: return std::make_unique<SweepAndPruneBroadphase>();
+    }
+    return std::make_unique<BruteForceBroadphase>();
+}
+
+void Broadphase::Query(const std::vector<BroadphaseProxy>& proxies, sf::Vector2f min, sf::Vector2f max,
+                       std::vector<std::uint32_t>& out) const {
+    const BroadphaseProxy box{min, max};
+    for (std::uint32_t i = 0; i < proxies.size(); ++i) {
+        if (proxies[i].enabled && ProxiesOverlap(proxies[i], box)) out.push_back(i);
+    }
+}
+
+// ============ BRUTE FORCE ============
+
+void BruteForceBroadphase::FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) {
+    pairs.clear();
+    const auto count = static_cast<std::uint32_t>(proxies.size());
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const BroadphaseProxy& a = proxies[i];
+        if (!a.enabled) continue;
+
+        for (std::uint32_t j = i + 1; j < count; ++j) {
+            const BroadphaseProxy& b = proxies[j];
+            if (!b.enabled || (a.isStatic && b.isStatic)) continue;
+
+            if (ProxiesOverlap(a, b)) {
+                pairs.push_back({i, j});
+            }
+        }
+    }
+}
+
+// ============ UNIFORM GRID ============
+
+std::int32_t UniformGridBroadphase::CellCoord(float v, float invCellSize) const {
+    // Clamp so far away (or broken) bodies can't overflow the cast
+    float cell = std::floor(v * invCellSize);
+    cell = std::clamp(cell, -1.0e9f, 1.0e9f);
+    return static_cast<std::int32_t>(cell);
+}
+
+std::uint32_t UniformGridBroadphase::HashCell(std::int32_t x, std::int32_t y) {
+    // Two large primes, the usual spatial hash trick
+    return (static_cast<std::uint32_t>(x) * 73856093u) ^ (static_cast<std::uint32_t>(y) * 19349663u);
+}
+
+void UniformGridBroadphase::Build(const std::vector<BroadphaseProxy>& proxies) {
+    m_entries.clear();
+    m_sorted.clear();
+
+    // 1. Cell size: largest collider in the world, unless set by hand
+    float cellSize = m_cellSize;
+    if (cellSize <= 0.f) {
+        for (const BroadphaseProxy& p : proxies) {
+            if (!p.enabled) continue;
+            cellSize = std::max(cellSize, std::max(p.max.x - p.min.x, p.max.y - p.min.y));
+        }
+    }
+    if (cellSize <= 0.f) cellSize = 1.f;  // only points (or nothing) left
+    m_lastCellSize = cellSize;
+    const float inv = 1.f / cellSize;
+    m_invCellSize = inv;
+
+    // 2. Insert every proxy into each cell it touches
+    for (std::uint32_t i = 0; i < proxies.size(); ++i) {
+        const BroadphaseProxy& p = proxies[i];
+        if (!p.enabled) continue;
+
+        const std::int32_t x0 = CellCoord(p.min.x, inv);
+        const std::int32_t x1 = CellCoord(p.max.x, inv);
+        const std::int32_t y0 = CellCoord(p.min.y, inv);
+        const std::int32_t y1 = CellCoord(p.max.y, inv);
+
+        for (std::int32_t y = y0; y <= y1; ++y) {
+            for (std::int32_t x = x0; x <= x1; ++x) {
+                m_entries.push_back({x, y, i});
+            }
+        }
+    }
+
+    if (m_entries.empty()) return;
+
+    // 3. Counting sort entries into hash buckets (power of two table)
+    std::size_t bucketCount = 1;
+    while (bucketCount < m_entries.size() * 2) bucketCount <<= 1;
+    const std::uint32_t mask = static_cast<std::uint32_t>(bucketCount - 1);
+    m_bucketMask = mask;
+
+    m_bucketStart.assign(bucketCount + 1, 0);
+    for (const CellEntry& e : m_entries) {
+        ++m_bucketStart[(HashCell(e.cellX, e.cellY) & mask) + 1];
+    }
+    for (std::size_t b = 0; b < bucketCount; ++b) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    m_sorted.resize(m_entries.size());
+    {
+        // m_bucketStart[b] is used as the write cursor, then shifted back
+        for (const CellEntry& e : m_entries) {
+            std::uint32_t bucket = HashCell(e.cellX, e.cellY) & mask;
+            m_sorted[m_bucketStart[bucket]++] = e;
+        }
+        for (std::size_t b = bucketCount; b > 0; --b) {
+            m_bucketStart[b] = m_bucketStart[b - 1];
+        }
+        m_bucketStart[0] = 0;
+    }
+}
+
+void UniformGridBroadphase::FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) {
+    pairs.clear();
+    Build(proxies);
+    if (m_sorted.empty()) return;
+
+    const float inv = m_invCellSize;
+    const std::size_t bucketCount = m_bucketStart.size() - 1;
+
+    // 4. Test pairs sharing a cell. A pair can share up to 4 cells, so only the
+    //    cell holding the min corner of the overlap region reports it.
+    for (std::size_t b = 0; b < bucketCount; ++b) {
+        const std::uint32_t begin = m_bucketStart[b];
+        const std::uint32_t end = m_bucketStart[b + 1];
+
+        for (std::uint32_t i = begin; i < end; ++i) {
+            const CellEntry& ea = m_sorted[i];
+            const BroadphaseProxy& a = proxies[ea.proxy];
+
+            for (std::uint32_t j = i + 1; j < end; ++j) {
+                const CellEntry& eb = m_sorted[j];
+                if (ea.cellX != eb.cellX || ea.cellY != eb.cellY) continue;  // hash collision
+
+                const BroadphaseProxy& pb = proxies[eb.proxy];
+                if (a.isStatic && pb.isStatic) continue;
+                if (!ProxiesOverlap(a, pb)) continue;
+
+                const std::int32_t ownerX = CellCoord(std::max(a.min.x, pb.min.x), inv);
+                const std::int32_t ownerY = CellCoord(std::max(a.min.y, pb.min.y), inv);
+                if (ownerX != ea.cellX || ownerY != ea.cellY) continue;
+
+                pairs.push_back({std::min(ea.proxy, eb.proxy), std::max(ea.proxy, eb.proxy)});
+            }
+        }
+    }
+
+    // Same order as brute force -> same simulation result
+    std::sort(pairs.begin(), pairs.end());
+}
+
+void UniformGridBroadphase::Query(const std::vector<BroadphaseProxy>& proxies, sf::Vector2f min, sf::Vector2f max,
+                                  std::vector<std::uint32_t>& out) const {
+    if (m_sorted.empty()) return;
+
+    const float inv = m_invCellSize;
+    const std::int32_t x0 = CellCoord(min.x, inv);
+    const std::int32_t x1 = CellCoord(max.x, inv);
+    const std::int32_t y0 = CellCoord(min.y, inv);
+    const std::int32_t y1 = CellCoord(max.y, inv);
+
+    // Huge box: looking at every proxy is cheaper than hashing every cell
+    const double cells = (static_cast<double>(x1) - x0 + 1.0) * (static_cast<double>(y1) - y0 + 1.0);
+    if (cells > static_cast<double>(m_sorted.size())) {
+        Broadphase::Query(proxies, min, max, out);
+        return;
+    }
+
+    const BroadphaseProxy box{min, max};
+    for (std::int32_t y = y0; y <= y1; ++y) {
+        for (std::int32_t x = x0; x <= x1; ++x) {
+            const std::uint32_t bucket = HashCell(x, y) & m_bucketMask;
+            for (std::uint32_t i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i) {
+                const CellEntry& e = m_sorted[i];
+                if (e.cellX != x || e.cellY != y) continue;  // hash collision
+
+                const BroadphaseProxy& p = proxies[e.proxy];
+                if (!ProxiesOverlap(p, box)) continue;
+
+                // Same trick as FindPairs: only the cell with the overlap's min corner reports it
+                if (CellCoord(std::max(p.min.x, min.x), inv) != x || CellCoord(std::max(p.min.y, min.y), inv) != y) continue;
+                out.push_back(e.proxy);
+            }
+        }
+    }
+}
+
+// ============ SWEEP AND PRUNE ============
+
+// Min before max on ties, so touching intervals still overlap
+bool SweepAndPruneBroadphase::Before(const Endpoint& a, const Endpoint& b) {
+    if (a.value != b.value) return a.value < b.value;
+    return a.isMin && !b.isMin;
+}
+
+void SweepAndPruneBroadphase::Rebuild(const std::vector<BroadphaseProxy>& proxies) {
+    m_endpoints.clear();
+    m_enabled.resize(proxies.size());
+
+    for (std::uint32_t i = 0; i < proxies.size(); ++i) {
+        const BroadphaseProxy& p = proxies[i];
+        m_enabled[i] = p.enabled ? 1 : 0;
+        if (!p.enabled) continue;
+
+        m_endpoints.push_back({p.min.x, i, true});
+        m_endpoints.push_back({p.max.x, i, false});
+    }
+
+    std::sort(m_endpoints.begin(), m_endpoints.end(), Before);
+    m_dirty = false;
+}
+
+void SweepAndPruneBroadphase::FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) {
+    pairs.clear();
+    m_lastSwaps = 0;
+
+    // Appended proxies don't renumber anything, so only fewer proxies or an enable flip
+    // (removal, reorder, collider change) needs the full sort
+    const std::size_t known = m_enabled.size();
+    bool needsRebuild = m_dirty || known > proxies.size();
+    for (std::size_t i = 0; !needsRebuild && i < known; ++i) {
+        needsRebuild = (m_enabled[i] != 0) != proxies[i].enabled;
+    }
+
+    if (needsRebuild) {
+        Rebuild(proxies);
+    } else {
+        // 1. Refresh endpoint values in place, new proxies go on the end
+        for (Endpoint& e : m_endpoints) {
+            const BroadphaseProxy& p = proxies[e.proxy];
+            e.value = e.isMin ? p.min.x : p.max.x;
+        }
+        m_enabled.resize(proxies.size());
+        for (std::uint32_t i = static_cast<std::uint32_t>(known); i < proxies.size(); ++i) {
+            m_enabled[i] = proxies[i].enabled ? 1 : 0;
+            if (!proxies[i].enabled) continue;
+            m_endpoints.push_back({proxies[i].min.x, i, true});
+            m_endpoints.push_back({proxies[i].max.x, i, false});
+        }
+
+        // 2. Insertion sort - cheap because last step's order is nearly right (an appended
+        //    endpoint walks down to its place once)
+        for (std::size_t i = 1; i < m_endpoints.size(); ++i) {
+            Endpoint key = m_endpoints[i];
+            std::size_t j = i;
+            while (j > 0 && Before(key, m_endpoints[j - 1])) {
+                m_endpoints[j] = m_endpoints[j - 1];
+                --j;
+                ++m_lastSwaps;
+            }
+            m_endpoints[j] = key;
+        }
+    }
+
+    // 3. Sweep: every interval open when a new one starts overlaps it on x
+    m_active.clear();
+    m_activeSlot.resize(proxies.size());
+
+    for (const Endpoint& e : m_endpoints) {
+        if (!e.isMin) {
+            // Swap-remove from the active list
+            std::uint32_t slot = m_activeSlot[e.proxy];
+            m_active[slot] = m_active.back();
+            m_activeSlot[m_active[slot]] = slot;
+            m_active.pop_back();
+            continue;
+        }
+
+        const BroadphaseProxy& a = proxies[e.proxy];
+        for (std::uint32_t other : m_active) {
+            const BroadphaseProxy& b = proxies[other];
+            if (a.isStatic && b.isStatic) continue;
+            if (a.min.y > b.max.y || b.min.y > a.max.y) continue;
+
+            pairs.push_back({std::min(e.proxy, other), std::max(e.proxy, other)});
+        }
+
+        m_activeSlot[e.proxy] = static_cast<std::uint32_t>(m_active.size());
+        m_active.push_back(e.proxy);
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+}
+
+// ============ STATIC BVH ============
+
+void StaticBVH::Clear() {
+    m_nodes.clear();
+    m_items.clear();
+}
+
+void StaticBVH::Build(const std::vector<BroadphaseProxy>& proxies, const std::vector<std::uint32_t>& indices) {
+    Clear();
+    if (indices.empty()) return;
+
+    m_items.reserve(indices.size());
+    for (std::uint32_t index : indices) m_items.push_back({proxies[index], index});
+    m_nodes.reserve(2 * indices.size() / LeafSize + 1);
+    BuildNode(0, static_cast<std::uint32_t>(m_items.size()));
+}
+
+void StaticBVH::BuildNode(std::uint32_t begin, std::uint32_t end) {
+    const std::uint32_t node = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.push_back({m_items[begin].bounds.min, m_items[begin].bounds.max, begin, end - begin});
+
+    // Bounds of the node, and of the centers to pick the split axis from
+    sf::Vector2f centerMin = (m_items[begin].bounds.min + m_items[begin].bounds.max) * 0.5f;
+    sf::Vector2f centerMax = centerMin;
+    for (std::uint32_t i = begin; i < end; ++i) {
+        const BroadphaseProxy& b = m_items[i].bounds;
+        Node& n = m_nodes[node];
+        n.min = {std::min(n.min.x, b.min.x), std::min(n.min.y, b.min.y)};
+        n.max = {std::max(n.max.x, b.max.x), std::max(n.max.y, b.max.y)};
+        const sf::Vector2f center = (b.min + b.max) * 0.5f;
+        centerMin = {std::min(centerMin.x, center.x), std::min(centerMin.y, center.y)};
+        centerMax = {std::max(centerMax.x, center.x), std::max(centerMax.y, center.y)};
+    }
+    if (end - begin <= LeafSize) return;
+
+    // Median split: both halves the same size, so depth stays log2(n / LeafSize)
+    const bool splitX = centerMax.x - centerMin.x >= centerMax.y - centerMin.y;
+    const std::uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(m_items.begin() + begin, m_items.begin() + mid, m_items.begin() + end,
+                     [splitX](const Item& a, const Item& b) {
+                         return splitX ? a.bounds.min.x + a.bounds.max.x < b.bounds.min.x + b.bounds.max.x
+                                       : a.bounds.min.y + a.bounds.max.y < b.bounds.min.y + b.bounds.max.y;
+                     });
+
+    m_nodes[node].count = 0;
+    BuildNode(begin, mid);
+    m_nodes[node].first = static_cast<std::uint32_t>(m_nodes.size());
+    BuildNode(mid, end);
+}
+
+void StaticBVH::Query(sf::Vector2f min, sf::Vector2f max, std::vector<std::uint32_t>& out) const {
+    if (m_nodes.empty()) return;
+
+    const BroadphaseProxy box{min, max};
+    std::uint32_t stack[64];   // balanced, so 64 levels is far more than 2^32 bodies need
+    std::uint32_t top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const std::uint32_t index = stack[--top];
+        const Node& node = m_nodes[index];
+        if (!ProxiesOverlap({node.min, node.max}, box)) continue;
+
+        if (node.count == 0) {
+            stack[top++] = node.first;
+            stack[top++] = index + 1;
+            continue;
+        }
+        for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+            if (ProxiesOverlap(m_items[i].bounds, box)) out.push_back(m_items[i].index);
+        }
+    }
+}
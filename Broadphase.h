@@ -0,0 +1,190 @@
+#ifndef PHYSICSENGINE_BROADPHASE_H
+#define PHYSICSENGINE_BROADPHASE_H
+
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Broadphase = cheap "could these two touch?" pass before the real
+ * collision functions run.
+ *
+ * The world hands over one proxy (world space bounds) per body, in body order,
+ * and gets back the candidate pairs. Pairs are always (a < b) and sorted, so
+ * every broadphase resolves collisions in the same order as brute force.
+ */
+
+enum class BroadphaseType {
+    BruteForce,
+    UniformGrid,
+    SweepAndPrune
+};
+
+struct BroadphaseProxy {
+    sf::Vector2f min;
+    sf::Vector2f max;
+    bool isStatic = false;
+    bool enabled = true;   // false if the body has no collider
+};
+
+struct BodyPair {
+    std::uint32_t a;
+    std::uint32_t b;
+
+    bool operator==(const BodyPair& other) const { return a == other.a && b == other.b; }
+    bool operator<(const BodyPair& other) const { return a != other.a ? a < other.a : b < other.b; }
+};
+
+// Inclusive on purpose: touching boxes still count as a collision
+inline bool ProxiesOverlap(const BroadphaseProxy& a, const BroadphaseProxy& b) {
+    return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+           a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+class Broadphase {
+public:
+    virtual ~Broadphase() = default;
+
+    virtual BroadphaseType GetType() const = 0;
+
+    // Replace pairs with every overlapping, non static-static pair
+    virtual void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) = 0;
+
+    // Bodies were removed or reordered, so proxy i may not be the same body anymore.
+    // Adding one doesn't renumber anything: new proxies just show up at the end.
+    virtual void Reset() {}
+
+    // Spatial queries. Build() sets up whatever Query() needs without looking for
+    // pairs (FindPairs does it too); Query() adds the index of every enabled proxy
+    // overlapping [min, max] to out, in no particular order. The default is a plain loop.
+    virtual void Build(const std::vector<BroadphaseProxy>& proxies) { (void)proxies; }
+    virtual void Query(const std::vector<BroadphaseProxy>& proxies, sf::Vector2f min, sf::Vector2f max,
+                       std::vector<std::uint32_t>& out) const;
+};
+
+// The old O(n^2) loop, kept around as the reference to compare against
+class BruteForceBroadphase : public Broadphase {
+public:
+    BroadphaseType GetType() const override { return BroadphaseType::BruteForce; }
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) override;
+};
+
+/**
+ * Uniform grid stored as a spatial hash
+ *
+ * Cell size defaults to the largest proxy extent (2 * biggest radius / halfExtent),
+ * so a body covers at most 2x2 cells. Entries are bucketed by a counting sort
+ * into a flat array every step - no per-cell allocations.
+ */
+class UniformGridBroadphase : public Broadphase {
+private:
+    struct CellEntry {
+        std::int32_t cellX;
+        std::int32_t cellY;
+        std::uint32_t proxy;
+    };
+
+    float m_cellSize = 0.f;        // 0 = pick from proxies every step
+    float m_lastCellSize = 0.f;
+
+    std::vector<CellEntry> m_entries;
+    std::vector<CellEntry> m_sorted;
+    std::vector<std::uint32_t> m_bucketStart;
+    std::uint32_t m_bucketMask = 0;
+    float m_invCellSize = 1.f;
+
+    std::int32_t CellCoord(float v, float invCellSize) const;
+    static std::uint32_t HashCell(std::int32_t x, std::int32_t y);
+
+public:
+    BroadphaseType GetType() const override { return BroadphaseType::UniformGrid; }
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) override;
+
+    // Only visits the cells under the box, unless it covers more cells than there are entries
+    void Build(const std::vector<BroadphaseProxy>& proxies) override;
+    void Query(const std::vector<BroadphaseProxy>& proxies, sf::Vector2f min, sf::Vector2f max,
+               std::vector<std::uint32_t>& out) const override;
+
+    void SetCellSize(float size) { m_cellSize = size; }
+    float GetCellSize() const { return m_lastCellSize; }
+};
+
+/**
+ * Sweep and prune on the x axis
+ *
+ * Keeps the sorted endpoint list between steps and fixes it up with an
+ * insertion sort. With 8 substeps per frame bodies barely move, so the list
+ * is almost sorted and the update is close to linear. Doesn't care about
+ * body size, so huge static floors next to tiny balls are fine.
+ */
+class SweepAndPruneBroadphase : public Broadphase {
+private:
+    struct Endpoint {
+        float value;
+        std::uint32_t proxy;
+        bool isMin;
+    };
+
+    std::vector<Endpoint> m_endpoints;
+    std::vector<std::uint8_t> m_enabled;    // per proxy, to notice collider changes
+    std::vector<std::uint32_t> m_active;    // proxies whose interval is open during the sweep
+    std::vector<std::uint32_t> m_activeSlot;
+    bool m_dirty = true;
+    std::size_t m_lastSwaps = 0;
+
+    void Rebuild(const std::vector<BroadphaseProxy>& proxies);
+    static bool Before(const Endpoint& a, const Endpoint& b);
+
+public:
+    BroadphaseType GetType() const override { return BroadphaseType::SweepAndPrune; }
+    void FindPairs(const std::vector<BroadphaseProxy>& proxies, std::vector<BodyPair>& pairs) override;
+    void Reset() override { m_dirty = true; }
+
+    // Insertion sort swaps done by the last FindPairs (0 after a rebuild)
+    std::size_t GetLastSwapCount() const { return m_lastSwaps; }
+};
+
+/**
+ * Bounding volume hierarchy over static geometry
+ *
+ * Not a Broadphase: it only holds the static bodies, which the world keeps out
+ * of its broadphase. Built top down (median split on the longer axis, up to
+ * LeafSize bodies per leaf) whenever the static set changes, and otherwise only
+ * queried - once per dynamic body per Step, so static-static pairs never come up.
+ */
+class StaticBVH {
+public:
+    static constexpr std::uint32_t LeafSize = 4;
+
+    // indices = the proxies to put in (enabled or not), bounds are copied
+    void Build(const std::vector<BroadphaseProxy>& proxies, const std::vector<std::uint32_t>& indices);
+    void Clear();
+
+    // Adds the index of every body overlapping [min, max] to out, in no particular order
+    void Query(sf::Vector2f min, sf::Vector2f max, std::vector<std::uint32_t>& out) const;
+
+    std::size_t Size() const { return m_items.size(); }
+    std::size_t GetNodeCount() const { return m_nodes.size(); }
+
+private:
+    struct Node {
+        sf::Vector2f min;
+        sf::Vector2f max;
+        std::uint32_t first;   // leaf: first item, inner: right child (left child is the next node)
+        std::uint32_t count;   // 0 = inner node
+    };
+    struct Item {
+        BroadphaseProxy bounds;
+        std::uint32_t index;
+    };
+
+    std::vector<Node> m_nodes;    // depth first
+    std::vector<Item> m_items;    // leaves point into this
+
+    void BuildNode(std::uint32_t begin, std::uint32_t end);
+};
+
+std::unique_ptr<Broadphase> MakeBroadphase(BroadphaseType type);
+
+#endif //PHYSICSENGINE_BROADPHASE_H
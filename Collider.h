@@ -2,49 +2,72 @@
 #define PHYSICSENGINE_COLLIDER_H
 
 #include <SFML/System/Vector2.hpp>
-#include <memory>
+#include <cstddef>
 
 enum class ColliderType {
+    None,
     Circle,
     AABB
 };
+constexpr std::size_t ColliderTypeCount = 3;   // keep in step with the enum
 
-struct Collider {
-    ColliderType type;
-    
-    explicit Collider(ColliderType t) : type(t) {}
-    virtual ~Collider() = default;
-};
+struct CircleCollider {
+    float radius = 0.f;
 
-struct CircleCollider : Collider {
-    float radius;
-    
-    explicit CircleCollider(float r) 
-        : Collider(ColliderType::Circle), radius(r) {}
+    CircleCollider() = default;
+    explicit CircleCollider(float r) : radius(r) {}
 };
 
-struct AABBCollider : Collider {
+struct AABBCollider {
     sf::Vector2f halfExtents;  // Half-width and half-height
-    
-    explicit AABBCollider(sf::Vector2f size) 
-        : Collider(ColliderType::AABB), halfExtents(size * 0.5f) {}
-    
-    AABBCollider(float width, float height) 
-        : Collider(ColliderType::AABB), halfExtents({width * 0.5f, height * 0.5f}) {}
+
+    AABBCollider() = default;
+    explicit AABBCollider(sf::Vector2f size) : halfExtents(size * 0.5f) {}
+
+    AABBCollider(float width, float height) : halfExtents({width * 0.5f, height * 0.5f}) {}
+};
+
+/**
+ * Tagged union of all shapes, stored by value (no allocation per body)
+ *
+ * New shape = new ColliderType + struct + union member, and a case in
+ * HalfExtents() so the broadphase can bound it.
+ */
+struct Collider {
+    ColliderType type = ColliderType::None;
+    union {
+        CircleCollider circle;
+        AABBCollider aabb;
+    };
+
+    Collider() : aabb() {}
+    Collider(const CircleCollider& c) : type(ColliderType::Circle), circle(c) {}
+    Collider(const AABBCollider& b) : type(ColliderType::AABB), aabb(b) {}
+
+    explicit operator bool() const { return type != ColliderType::None; }
+
+    // Bounding box half size, around the body position
+    sf::Vector2f HalfExtents() const {
+        switch (type) {
+            case ColliderType::Circle: return {circle.radius, circle.radius};
+            case ColliderType::AABB:   return aabb.halfExtents;
+            case ColliderType::None:   break;
+        }
+        return {0.f, 0.f};
+    }
 };
 
 // Helper to create colliders
-inline std::unique_ptr<Collider> MakeCircleCollider(float radius) {
-    return std::make_unique<CircleCollider>(radius);
+inline Collider MakeCircleCollider(float radius) {
+    return CircleCollider(radius);
 }
 
-inline std::unique_ptr<Collider> MakeAABBCollider(float width, float height) {
-    return std::make_unique<AABBCollider>(width, height);
+inline Collider MakeAABBCollider(float width, float height) {
+    return AABBCollider(width, height);
 }
 
-inline std::unique_ptr<Collider> MakeAABBCollider(sf::Vector2f size) {
-    return std::make_unique<AABBCollider>(size);
+inline Collider MakeAABBCollider(sf::Vector2f size) {
+    return AABBCollider(size);
 }
 
 #endif //PHYSICSENGINE_COLLIDER_H
-
@@ -19,17 +19,44 @@ enum class ConstraintType {
     Pin
 };
 
-// Base constraint interface
+// Common header, no vtable: the world keeps each type in its own array and
+// calls Solve() directly. Every constraint has:
+//   void Solve()                   on the Object pointers
+//   void Solve(BodyStore& bodies)  on the world's body arrays (uses the handles)
+// Custom types only need the second one (see PhysicsWorld::AddConstraint).
+// The built-in ones return their error before the correction (world units),
+// which the solver uses for its early exit.
 struct Constraint {
     ConstraintType type;
     
     explicit Constraint(ConstraintType t) : type(t) {}
-    virtual ~Constraint() = default;
-    
-    // Position adjuster
-    virtual void Solve() = 0;
 };
 
+// Distribute correction based on which objects can move
+// If one is static, the other takes full correction
+// Static bodies are never written, which lets the parallel solver share them
+inline void ApplyPairCorrection(sf::Vector2f& posA, sf::Vector2f& posB,
+                                bool staticA, bool staticB, sf::Vector2f correction) {
+    if (staticA && staticB) return;
+
+    if (staticA) {
+        posB -= correction;
+    } else if (staticB) {
+        posA += correction;
+    } else {
+        posA += correction * 0.5f;
+        posB -= correction * 0.5f;
+    }
+}
+
+// Both handles -> dense indices, false if either body is gone
+inline bool ResolvePair(const BodyStore& bodies, BodyHandle a, BodyHandle b,
+                        std::uint32_t& indexA, std::uint32_t& indexB) {
+    indexA = bodies.IndexOf(a);
+    indexB = bodies.IndexOf(b);
+    return indexA != BodyStore::InvalidIndex && indexB != BodyStore::InvalidIndex;
+}
+
 /**
  * Rigid link
  * 
@@ -42,8 +69,12 @@ struct Constraint {
 struct DistanceConstraint : Constraint {
     Object* objA;
     Object* objB;
+    BodyHandle bodyA;      // set by PhysicsWorld
+    BodyHandle bodyB;
     float restLength;      //dist to maintain
     float stiffness;       // 1.0 = fully rigid, <1.0 = slightly elastic
+    float compliance = 0.f;   // XPBD mode instead of stiffness: inverse stiffness, 0 = rigid
+    float lambda = 0.f;       // XPBD, accumulated over one Step's iterations
     
     // Explicit length constructor
     DistanceConstraint(Object* a, Object* b, float length, float stiff)
@@ -56,28 +87,73 @@ struct DistanceConstraint : Constraint {
         sf::Vector2f diff = objB->position - objA->position;
         restLength = std::sqrt(diff.x * diff.x + diff.y * diff.y);
     }
-    
-    void Solve() override {
-        sf::Vector2f diff = objB->position - objA->position;
+
+    // Between two world bodies (no Object behind them)
+    DistanceConstraint(BodyHandle a, BodyHandle b, float length, float stiff)
+        : Constraint(ConstraintType::Distance),
+          objA(nullptr), objB(nullptr), bodyA(a), bodyB(b), restLength(length), stiffness(stiff) {}
+
+    static float SolvePositions(sf::Vector2f& posA, sf::Vector2f& posB, bool staticA, bool staticB,
+                                float restLength, float stiffness) {
+        sf::Vector2f diff = posB - posA;
         float currentLength = std::sqrt(diff.x * diff.x + diff.y * diff.y);
         
-        if (currentLength < 0.0001f) return;  //No div by zero
+        if (currentLength < 0.0001f) return 0.f;  //No div by zero
         
         //Correct by this
         float error = currentLength - restLength;
         sf::Vector2f direction = diff / currentLength;
         sf::Vector2f correction = direction * (error * stiffness);
         
-        // Distribute correction based on which objects can move
-        // If one is static, the other takes full correction
-        if (objA->isStatic) {
-            objB->position -= correction;
-        } else if (objB->isStatic) {
-            objA->position += correction;
-        } else {
-            objA->position += correction * 0.5f;
-            objB->position -= correction * 0.5f;
-        }
+        ApplyPairCorrection(posA, posB, staticA, staticB, correction);
+        return std::abs(error);
+    }
+
+    /**
+     * XPBD: dLambda = (-C - a~ lambda) / (wA + wB + a~), a~ = compliance / dt^2
+     *
+     * Bodies move by their inverse mass, and lambda carries over between the
+     * iterations of one Step, so the stiffness you get depends on compliance
+     * only, not on how many iterations or substeps run.
+     */
+    static float SolveCompliant(sf::Vector2f& posA, sf::Vector2f& posB, float invMassA, float invMassB,
+                                float restLength, float alphaTilde, float& lambda) {
+        sf::Vector2f diff = posB - posA;
+        float currentLength = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+        if (currentLength < 0.0001f) return 0.f;
+
+        float error = currentLength - restLength;
+        float denominator = invMassA + invMassB + alphaTilde;
+        if (denominator <= 0.f) return 0.f;   // both fixed
+
+        float deltaLambda = (-error - alphaTilde * lambda) / denominator;
+        lambda += deltaLambda;
+
+        sf::Vector2f direction = diff / currentLength;   // gradient of C at B, -direction at A
+        posA -= direction * (invMassA * deltaLambda);
+        posB += direction * (invMassB * deltaLambda);
+        return std::abs(error);
+    }
+    
+    void Solve() {
+        SolvePositions(objA->position, objB->position, objA->isStatic, objB->isStatic, restLength, stiffness);
+    }
+
+    float Solve(BodyStore& bodies) {
+        std::uint32_t a, b;
+        if (!ResolvePair(bodies, bodyA, bodyB, a, b)) return 0.f;
+        return SolvePositions(bodies.positions[a], bodies.positions[b],
+                              bodies.IsFixed(a), bodies.IsFixed(b), restLength, stiffness);
+    }
+
+    // invDtSquared = 1 / dt^2 of the Step. Fixed bodies count as infinite mass.
+    float SolveCompliant(BodyStore& bodies, float invDtSquared) {
+        std::uint32_t a, b;
+        if (!ResolvePair(bodies, bodyA, bodyB, a, b)) return 0.f;
+        const float invMassA = bodies.IsFixed(a) ? 0.f : 1.f / bodies.masses[a];
+        const float invMassB = bodies.IsFixed(b) ? 0.f : 1.f / bodies.masses[b];
+        return SolveCompliant(bodies.positions[a], bodies.positions[b], invMassA, invMassB,
+                              restLength, compliance * invDtSquared, lambda);
     }
 };
 
@@ -90,6 +166,8 @@ struct DistanceConstraint : Constraint {
 struct SpringConstraint : Constraint {
     Object* objA;
     Object* objB;
+    BodyHandle bodyA;      // set by PhysicsWorld
+    BodyHandle bodyB;
     float restLength;      // Natural length of spring
     float stiffness;       // Spring constant 
     float damping;         // Energy loss 
@@ -103,20 +181,26 @@ struct SpringConstraint : Constraint {
         sf::Vector2f diff = objB->position - objA->position;
         restLength = std::sqrt(diff.x * diff.x + diff.y * diff.y);
     }
-    
-    void Solve() override {
-        sf::Vector2f diff = objB->position - objA->position;
+
+    SpringConstraint(BodyHandle a, BodyHandle b, float length, float stiff, float damp)
+        : Constraint(ConstraintType::Spring),
+          objA(nullptr), objB(nullptr), bodyA(a), bodyB(b), restLength(length), stiffness(stiff), damping(damp) {}
+
+    static float SolvePositions(sf::Vector2f& posA, sf::Vector2f& posB,
+                                sf::Vector2f oldPosA, sf::Vector2f oldPosB, bool staticA, bool staticB,
+                                float restLength, float stiffness, float damping) {
+        sf::Vector2f diff = posB - posA;
         float currentLength = std::sqrt(diff.x * diff.x + diff.y * diff.y);
         
-        if (currentLength < 0.0001f) return;
+        if (currentLength < 0.0001f) return 0.f;
         
         //(Hooke's Law)
         float displacement = currentLength - restLength;
         sf::Vector2f direction = diff / currentLength;
         
         // velocities 
-        sf::Vector2f velA = objA->position - objA->oldPosition;
-        sf::Vector2f velB = objB->position - objB->oldPosition;
+        sf::Vector2f velA = posA - oldPosA;
+        sf::Vector2f velB = posB - oldPosB;
         sf::Vector2f relativeVel = velB - velA;
         
         // Damping force 
@@ -125,14 +209,21 @@ struct SpringConstraint : Constraint {
         // Total correction = spring + damping
         sf::Vector2f correction = direction * (displacement * stiffness + dampingForce);
         
-        if (objA->isStatic) {
-            objB->position -= correction;
-        } else if (objB->isStatic) {
-            objA->position += correction;
-        } else {
-            objA->position += correction * 0.5f;
-            objB->position -= correction * 0.5f;
-        }
+        ApplyPairCorrection(posA, posB, staticA, staticB, correction);
+        return std::abs(displacement);
+    }
+    
+    void Solve() {
+        SolvePositions(objA->position, objB->position, objA->oldPosition, objB->oldPosition,
+                       objA->isStatic, objB->isStatic, restLength, stiffness, damping);
+    }
+
+    float Solve(BodyStore& bodies) {
+        std::uint32_t a, b;
+        if (!ResolvePair(bodies, bodyA, bodyB, a, b)) return 0.f;
+        return SolvePositions(bodies.positions[a], bodies.positions[b],
+                              bodies.oldPositions[a], bodies.oldPositions[b],
+                              bodies.IsFixed(a), bodies.IsFixed(b), restLength, stiffness, damping);
     }
 };
 
@@ -144,6 +235,7 @@ struct SpringConstraint : Constraint {
  */
 struct PinConstraint : Constraint {
     Object* obj;
+    BodyHandle body;       // set by PhysicsWorld
     sf::Vector2f anchor;   // Fixed point in world space
     
     PinConstraint(Object* o, sf::Vector2f point)
@@ -152,11 +244,22 @@ struct PinConstraint : Constraint {
     // Pin to current position
     explicit PinConstraint(Object* o)
         : Constraint(ConstraintType::Pin), obj(o), anchor(o->position) {}
+
+    PinConstraint(BodyHandle b, sf::Vector2f point)
+        : Constraint(ConstraintType::Pin), obj(nullptr), body(b), anchor(point) {}
     
-    void Solve() override {
+    void Solve() {
         //Force pos to error
         obj->position = anchor;
     }
+
+    float Solve(BodyStore& bodies) {
+        std::uint32_t i = bodies.IndexOf(body);
+        if (i == BodyStore::InvalidIndex || bodies.IsFixed(i)) return 0.f;
+        const sf::Vector2f offset = anchor - bodies.positions[i];
+        bodies.positions[i] = anchor;
+        return std::sqrt(offset.x * offset.x + offset.y * offset.y);
+    }
     
     //Move anchor if dragging/other
     void SetAnchor(sf::Vector2f newPos) {
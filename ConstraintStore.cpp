@@ -0,0 +1,271 @@
+#include "ConstraintStore.h"
+#include <algorithm>
+
+namespace {
+
+// Below this a batch isn't worth waking the workers for
+constexpr std::size_t MinParallelBatch = 256;
+
+template <typename Fn>
+void RunRange(ThreadPool& pool, std::size_t count, Fn&& fn) {
+    if (count < MinParallelBatch) {
+        fn(std::size_t{0}, count);
+    } else {
+        pool.ParallelFor(count, fn);
+    }
+}
+
+// Same, for fn(begin, end) -> largest error in the range. Every chunk writes its
+// own slot of chunkErrors, so the max doesn't depend on timing.
+template <typename Fn>
+float RunRangeMax(ThreadPool& pool, std::vector<float>& chunkErrors, std::size_t count, Fn&& fn) {
+    if (count < MinParallelBatch) return fn(std::size_t{0}, count);
+
+    chunkErrors.assign(pool.GetThreadCount(), 0.f);
+    pool.ParallelForChunks(count, [&](unsigned chunk, std::size_t begin, std::size_t end) {
+        chunkErrors[chunk] = fn(begin, end);
+    });
+    return *std::max_element(chunkErrors.begin(), chunkErrors.end());
+}
+
+// One built-in constraint the way the settings ask for, error before the correction
+float SolveOne(DistanceConstraint& c, BodyStore& bodies, const ConstraintSolveSettings& settings, float invDtSquared) {
+    return settings.xpbd ? c.SolveCompliant(bodies, invDtSquared) : c.Solve(bodies);
+}
+
+template <typename T>
+float SolveOne(T& c, BodyStore& bodies, const ConstraintSolveSettings&, float) {
+    return c.Solve(bodies);
+}
+
+}  // namespace
+
+std::size_t ConstraintStore::Size() const {
+    std::size_t total = distance.Size() + springs.Size() + pins.Size();
+    for (const auto& bucket : m_custom) {
+        if (bucket) total += bucket->Size();
+    }
+    return total;
+}
+
+void ConstraintStore::Clear() {
+    distance.Clear();
+    springs.Clear();
+    pins.Clear();
+    m_custom.clear();
+    m_colorsDirty = true;
+}
+
+void ConstraintStore::SolveCustom(BodyStore& bodies) {
+    for (auto& bucket : m_custom) {
+        if (bucket) bucket->SolveAll(bodies);
+    }
+}
+
+// XPBD lambdas start from zero every Step. Returns 1 / dt^2 for the compliance.
+float ConstraintStore::BeginSolve(const ConstraintSolveSettings& settings) {
+    if (!settings.xpbd) return 0.f;
+    distance.ForEach([](DistanceConstraint& c) { c.lambda = 0.f; });
+    return settings.dt > 0.f ? 1.f / (settings.dt * settings.dt) : 0.f;
+}
+
+//Uses Gauss-seidel relaxation (i.e. solve each constraint in each iteration)
+int ConstraintStore::SolveSequential(BodyStore& bodies, const ConstraintSolveSettings& settings) {
+    const float invDtSquared = BeginSolve(settings);
+    for (int i = 0; i < settings.iterations; ++i) {
+        float maxError = 0.f;
+        auto solve = [&](auto& c) { maxError = std::max(maxError, SolveOne(c, bodies, settings, invDtSquared)); };
+        distance.ForEach(solve);
+        springs.ForEach(solve);
+        pins.ForEach(solve);
+        SolveCustom(bodies);
+        if (maxError < settings.tolerance) return i + 1;
+    }
+    return settings.iterations;
+}
+
+// ============ PARALLEL (COLORED) SOLVER ============
+
+std::size_t ConstraintStore::GetColorCount(const BodyStore& bodies) {
+    if (m_colorsDirty) ColorConstraints(bodies);
+    return m_colorCount;
+}
+
+// Greedy coloring in solve order, so it's the same every time.
+// Static bodies are never written by constraints, so they don't conflict.
+// Custom types aren't colored, they always run serially after the colors.
+void ConstraintStore::ColorConstraints(const BodyStore& bodies) {
+    constexpr int MaxColors = 64;   // one bit each in a usedColors mask
+
+    // Batches are emptied, not freed, so recoloring after every add/remove doesn't allocate
+    std::vector<std::uint64_t>& usedColors = m_usedColors;   // per body
+    usedColors.assign(bodies.Size(), 0);
+    for (ColorBatch& batch : m_colors) batch.Clear();
+    m_uncolored.Clear();
+    m_colorCount = 0;
+
+    // Returns the color picked, or -1 if every color is taken
+    auto assign = [&](BodyHandle a, BodyHandle b) {
+        std::uint32_t indices[2];
+        int count = 0;
+        std::uint64_t taken = 0;
+        for (BodyHandle h : {a, b}) {
+            std::uint32_t index = bodies.IndexOf(h);
+            if (index == BodyStore::InvalidIndex || bodies.isStatic[index]) continue;
+            indices[count++] = index;
+            taken |= usedColors[index];
+        }
+        int color = 0;
+        while (color < MaxColors && (taken & (1ull << color))) ++color;
+        if (color == MaxColors) return -1;
+        for (int k = 0; k < count; ++k) usedColors[indices[k]] |= 1ull << color;
+
+        if (color >= static_cast<int>(m_colors.size())) m_colors.resize(color + 1);
+        m_colorCount = std::max<std::size_t>(m_colorCount, color + 1);
+        return color;
+    };
+
+    distance.ForEachSlot([&](std::uint32_t slot, DistanceConstraint& c) {
+        int color = assign(c.bodyA, c.bodyB);
+        (color < 0 ? m_uncolored : m_colors[color]).distance.push_back(slot);
+    });
+    springs.ForEachSlot([&](std::uint32_t slot, SpringConstraint& c) {
+        int color = assign(c.bodyA, c.bodyB);
+        (color < 0 ? m_uncolored : m_colors[color]).springs.push_back(slot);
+    });
+    pins.ForEachSlot([&](std::uint32_t slot, PinConstraint& c) {
+        int color = assign(c.body, BodyHandle{});
+        (color < 0 ? m_uncolored : m_colors[color]).pins.push_back(slot);
+    });
+
+    m_colorsDirty = false;
+}
+
+int ConstraintStore::SolveColored(BodyStore& bodies, const ConstraintSolveSettings& settings, ThreadPool& pool) {
+    if (m_colorsDirty) ColorConstraints(bodies);
+    const float invDtSquared = BeginSolve(settings);
+
+    auto run = [&](auto& constraints, const std::vector<std::uint32_t>& slots) {
+        return RunRangeMax(pool, m_chunkErrors, slots.size(), [&](std::size_t begin, std::size_t end) {
+            float maxError = 0.f;
+            for (std::size_t k = begin; k < end; ++k) {
+                maxError = std::max(maxError, SolveOne(constraints.At(slots[k]), bodies, settings, invDtSquared));
+            }
+            return maxError;
+        });
+    };
+
+    for (int i = 0; i < settings.iterations; ++i) {
+        float maxError = 0.f;
+
+        // Within a color the three types touch disjoint bodies too, so their order is free
+        for (std::size_t color = 0; color < m_colorCount; ++color) {
+            const ColorBatch& batch = m_colors[color];
+            maxError = std::max({maxError, run(distance, batch.distance), run(springs, batch.springs),
+                                 run(pins, batch.pins)});
+        }
+
+        auto solve = [&](auto& c) { maxError = std::max(maxError, SolveOne(c, bodies, settings, invDtSquared)); };
+        for (std::uint32_t slot : m_uncolored.distance) solve(distance.At(slot));
+        for (std::uint32_t slot : m_uncolored.springs) solve(springs.At(slot));
+        for (std::uint32_t slot : m_uncolored.pins) solve(pins.At(slot));
+        SolveCustom(bodies);
+        if (maxError < settings.tolerance) return i + 1;
+    }
+    return settings.iterations;
+}
+
+// ============ JACOBI SOLVER ============
+
+// Counting sort of the endpoints by body, O(constraints + bodies). Dense indices
+// move on every remove, so this is redone each Step instead of cached.
+void ConstraintStore::BuildJacobi(const BodyStore& bodies) {
+    JacobiScratch& s = m_jacobi;
+    s.distance.clear();
+    s.springs.clear();
+    s.endpoints.clear();
+
+    distance.ForEach([&](const DistanceConstraint& c) {
+        std::uint32_t a, b;
+        if (!ResolvePair(bodies, c.bodyA, c.bodyB, a, b)) return;
+        s.distance.push_back(&c);
+        s.endpoints.push_back(a);
+        s.endpoints.push_back(b);
+    });
+    springs.ForEach([&](const SpringConstraint& c) {
+        std::uint32_t a, b;
+        if (!ResolvePair(bodies, c.bodyA, c.bodyB, a, b)) return;
+        s.springs.push_back(&c);
+        s.endpoints.push_back(a);
+        s.endpoints.push_back(b);
+    });
+
+    s.bodyStart.assign(bodies.Size() + 1, 0);
+    for (std::uint32_t index : s.endpoints) ++s.bodyStart[index + 1];
+    for (std::size_t i = 0; i < bodies.Size(); ++i) s.bodyStart[i + 1] += s.bodyStart[i];
+
+    s.bodyFill.assign(s.bodyStart.begin(), s.bodyStart.end() - 1);
+    s.refs.resize(s.endpoints.size());
+    for (std::uint32_t e = 0; e < s.endpoints.size(); ++e) s.refs[s.bodyFill[s.endpoints[e]]++] = e;
+
+    // Fixed bodies never get corrections, leave them out of the apply pass
+    s.touched.clear();
+    for (std::uint32_t i = 0; i < bodies.Size(); ++i) {
+        if (s.bodyStart[i + 1] > s.bodyStart[i] && !bodies.IsFixed(i)) s.touched.push_back(i);
+    }
+    s.corrections.resize(s.endpoints.size());
+}
+
+// Both passes only write their own slots (corrections per endpoint, then positions
+// per body, summed in a fixed order), so any thread count gives the same result
+int ConstraintStore::SolveJacobi(BodyStore& bodies, const ConstraintSolveSettings& settings, ThreadPool& pool) {
+    BuildJacobi(bodies);
+    JacobiScratch& s = m_jacobi;
+    const std::size_t distanceCount = s.distance.size();
+    const std::size_t pairCount = s.endpoints.size() / 2;
+    const float relaxation = settings.jacobiRelaxation;
+
+    for (int i = 0; i < settings.iterations; ++i) {
+        // 1. Every constraint against the same positions, corrections out to its endpoints
+        float maxError = RunRangeMax(pool, m_chunkErrors, pairCount, [&](std::size_t begin, std::size_t end) {
+            float rangeError = 0.f;
+            for (std::size_t k = begin; k < end; ++k) {
+                const std::uint32_t a = s.endpoints[2 * k];
+                const std::uint32_t b = s.endpoints[2 * k + 1];
+                sf::Vector2f posA = bodies.positions[a];
+                sf::Vector2f posB = bodies.positions[b];
+                float error;
+                if (k < distanceCount) {
+                    const DistanceConstraint& c = *s.distance[k];
+                    error = DistanceConstraint::SolvePositions(posA, posB, bodies.IsFixed(a), bodies.IsFixed(b),
+                                                               c.restLength, c.stiffness);
+                } else {
+                    const SpringConstraint& c = *s.springs[k - distanceCount];
+                    error = SpringConstraint::SolvePositions(posA, posB, bodies.oldPositions[a], bodies.oldPositions[b],
+                                                             bodies.IsFixed(a), bodies.IsFixed(b),
+                                                             c.restLength, c.stiffness, c.damping);
+                }
+                s.corrections[2 * k] = posA - bodies.positions[a];
+                s.corrections[2 * k + 1] = posB - bodies.positions[b];
+                rangeError = std::max(rangeError, error);
+            }
+            return rangeError;
+        });
+
+        // 2. Per body: average of its corrections, over-relaxed
+        RunRange(pool, s.touched.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t t = begin; t < end; ++t) {
+                const std::uint32_t body = s.touched[t];
+                sf::Vector2f sum{0.f, 0.f};
+                for (std::uint32_t r = s.bodyStart[body]; r < s.bodyStart[body + 1]; ++r) sum += s.corrections[s.refs[r]];
+                const float count = static_cast<float>(s.bodyStart[body + 1] - s.bodyStart[body]);
+                bodies.positions[body] += sum * (relaxation / count);
+            }
+        });
+
+        pins.ForEach([&](PinConstraint& c) { maxError = std::max(maxError, c.Solve(bodies)); });
+        SolveCustom(bodies);
+        if (maxError < settings.tolerance) return i + 1;
+    }
+    return settings.iterations;
+}
@@ -0,0 +1,225 @@
+#ifndef PHYSICSENGINE_CONSTRAINTSTORE_H
+#define PHYSICSENGINE_CONSTRAINTSTORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "BlockPool.h"
+#include "BodyStore.h"
+#include "Constraint.h"
+#include "ThreadPool.h"
+
+enum class ConstraintSolverMode {
+    Sequential,        // plain Gauss-Seidel
+    ParallelColored,   // Gauss-Seidel per color, colors split over the thread pool
+    Jacobi             // every constraint against last iteration's positions, averaged per body
+};
+
+// What one solve does; PhysicsWorld fills it from its setters every Step
+struct ConstraintSolveSettings {
+    int iterations = 4;
+    float tolerance = 0.f;         // stop once no built-in constraint is off by more than this (0 = never)
+    bool xpbd = false;             // distance constraints use compliance + lambdas instead of stiffness
+    float dt = 0.f;                // the Step's, for the XPBD compliance
+    float jacobiRelaxation = 1.f;
+};
+
+// Custom constraint types get one bucket each; one virtual call per bucket, not per constraint
+struct ConstraintBucketBase {
+    virtual ~ConstraintBucketBase() = default;
+    virtual void SolveAll(BodyStore& bodies) = 0;
+    virtual std::size_t Size() const = 0;
+};
+
+template <typename T>
+struct ConstraintBucket : ConstraintBucketBase {
+    BlockPool<T> items;
+
+    void SolveAll(BodyStore& bodies) override {
+        items.ForEach([&](T& c) { c.Solve(bodies); });
+    }
+    std::size_t Size() const override { return items.Size(); }
+};
+
+template <typename T>
+constexpr bool IsBuiltinConstraint = std::is_same_v<T, DistanceConstraint> ||
+                                     std::is_same_v<T, SpringConstraint> ||
+                                     std::is_same_v<T, PinConstraint>;
+
+// Constraints built from Objects get the matching body handles
+inline void BindBodies(DistanceConstraint& c) {
+    if (c.objA) c.bodyA = c.objA->body;
+    if (c.objB) c.bodyB = c.objB->body;
+}
+
+inline void BindBodies(SpringConstraint& c) {
+    if (c.objA) c.bodyA = c.objA->body;
+    if (c.objB) c.bodyB = c.objB->body;
+}
+
+inline void BindBodies(PinConstraint& c) {
+    if (c.obj) c.body = c.obj->body;
+}
+
+/**
+ * Constraints bucketed by type
+ *
+ * Each built-in type has its own BlockPool and is solved in a tight loop
+ * with no virtual calls. Pointers handed out stay valid until the constraint
+ * is removed, so they double as handles.
+ *
+ * Solve order per iteration: distance -> spring -> pin -> custom. Pins go
+ * last so pinned bodies end each iteration exactly on their anchor.
+ */
+class ConstraintStore {
+public:
+    BlockPool<DistanceConstraint> distance;
+    BlockPool<SpringConstraint> springs;
+    BlockPool<PinConstraint> pins;
+
+    template <typename T, typename... Args>
+    T* Add(Args&&... args) {
+        m_colorsDirty = true;
+        if constexpr (IsBuiltinConstraint<T>) {
+            T* c = Pool<T>().Emplace(std::forward<Args>(args)...);
+            BindBodies(*c);
+            return c;
+        } else {
+            return Bucket<T>().items.Emplace(std::forward<Args>(args)...);
+        }
+    }
+
+    template <typename T>
+    void Remove(T* constraint) {
+        m_colorsDirty = true;
+        if constexpr (IsBuiltinConstraint<T>) {
+            Pool<T>().Remove(constraint);
+        } else if constexpr (std::is_same_v<T, Constraint>) {
+            switch (constraint->type) {
+                case ConstraintType::Distance: distance.Remove(static_cast<DistanceConstraint*>(constraint)); break;
+                case ConstraintType::Spring:   springs.Remove(static_cast<SpringConstraint*>(constraint)); break;
+                case ConstraintType::Pin:      pins.Remove(static_cast<PinConstraint*>(constraint)); break;
+            }
+        } else {
+            Bucket<T>().items.Remove(constraint);
+        }
+    }
+
+    // Optional, Add<T> registers on first use anyway
+    template <typename T>
+    void Register() { Bucket<T>(); }
+
+    // Room for count constraints of type T, so adding up to that many doesn't allocate
+    template <typename T>
+    void Reserve(std::size_t count) {
+        if constexpr (IsBuiltinConstraint<T>) Pool<T>().Reserve(count);
+        else Bucket<T>().items.Reserve(count);
+    }
+
+    // Replaces every constraint of a built-in type T, make(i) returning the i-th.
+    // One pass over the pool's blocks instead of an Add each (LoadSnapshot).
+    template <typename T, typename Make>
+    void Assign(std::size_t count, Make&& make) {
+        static_assert(IsBuiltinConstraint<T>, "custom types go through Add");
+        m_colorsDirty = true;
+        Pool<T>().Assign(count, std::forward<Make>(make));
+    }
+
+    std::size_t Size() const;
+
+    // Every constraint, custom ones included. Pointers handed out are dead after this.
+    void Clear();
+
+    // Static flags changed -> coloring has to be redone
+    void MarkColorsDirty() { m_colorsDirty = true; }
+
+    // All return the iterations actually run (fewer than asked once under tolerance).
+    // Custom types have no error to report, so they don't hold up the early exit.
+    int SolveSequential(BodyStore& bodies, const ConstraintSolveSettings& settings);
+    int SolveColored(BodyStore& bodies, const ConstraintSolveSettings& settings, ThreadPool& pool);
+    // Distance + spring corrections are summed per body, averaged and applied times
+    // relaxation (1 = plain average, up to ~2 converges faster). Pins and custom
+    // types run serially after each iteration, so pins still end on their anchor.
+    // Always the stiffness formulation: xpbd is ignored here.
+    int SolveJacobi(BodyStore& bodies, const ConstraintSolveSettings& settings, ThreadPool& pool);
+    std::size_t GetColorCount(const BodyStore& bodies);
+
+    // fn(BodyHandle a, BodyHandle b) for every built-in constraint, b is invalid for pins.
+    // Custom types are opaque, so they're not included.
+    template <typename Fn>
+    void ForEachBodyPair(Fn&& fn) {
+        distance.ForEach([&](DistanceConstraint& c) { fn(c.bodyA, c.bodyB); });
+        springs.ForEach([&](SpringConstraint& c) { fn(c.bodyA, c.bodyB); });
+        pins.ForEach([&](PinConstraint& c) { fn(c.body, BodyHandle{}); });
+    }
+
+private:
+    std::vector<std::unique_ptr<ConstraintBucketBase>> m_custom;   // indexed by CustomTypeId<T>()
+
+    // Graph coloring: constraints in one color share no dynamic body
+    struct ColorBatch {
+        std::vector<std::uint32_t> distance;
+        std::vector<std::uint32_t> springs;
+        std::vector<std::uint32_t> pins;
+
+        void Clear() { distance.clear(); springs.clear(); pins.clear(); }
+    };
+    std::vector<ColorBatch> m_colors;   // only the first m_colorCount are in use
+    std::size_t m_colorCount = 0;
+    std::vector<std::uint64_t> m_usedColors;
+    ColorBatch m_uncolored;    // ran out of colors -> solved serially
+    bool m_colorsDirty = true;
+
+    // Jacobi: constraints flattened to endpoint pairs (distance first, then springs),
+    // and per body which endpoints touch it. Rebuilt every Step, no coloring needed.
+    struct JacobiScratch {
+        std::vector<const DistanceConstraint*> distance;
+        std::vector<const SpringConstraint*> springs;
+        std::vector<std::uint32_t> endpoints;        // dense body index, 2 per constraint
+        std::vector<sf::Vector2f> corrections;       // one per endpoint
+        std::vector<std::uint32_t> bodyStart;        // per body + 1, into refs
+        std::vector<std::uint32_t> bodyFill;
+        std::vector<std::uint32_t> refs;             // endpoint indices grouped by body
+        std::vector<std::uint32_t> touched;          // dynamic bodies with at least one constraint
+    };
+    JacobiScratch m_jacobi;
+
+    std::vector<float> m_chunkErrors;   // per pool chunk, for the early exit
+
+    float BeginSolve(const ConstraintSolveSettings& settings);
+    void BuildJacobi(const BodyStore& bodies);
+    void ColorConstraints(const BodyStore& bodies);
+    void SolveCustom(BodyStore& bodies);
+
+    template <typename T>
+    BlockPool<T>& Pool() {
+        if constexpr (std::is_same_v<T, DistanceConstraint>) return distance;
+        else if constexpr (std::is_same_v<T, SpringConstraint>) return springs;
+        else return pins;
+    }
+
+    // Atomic: worlds in a WorldBatch can add their first custom constraint on different threads
+    static std::size_t NextCustomTypeId() {
+        static std::atomic<std::size_t> next{0};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static std::size_t CustomTypeId() {
+        static const std::size_t id = NextCustomTypeId();
+        return id;
+    }
+
+    template <typename T>
+    ConstraintBucket<T>& Bucket() {
+        const std::size_t id = CustomTypeId<T>();
+        if (id >= m_custom.size()) m_custom.resize(id + 1);
+        if (!m_custom[id]) m_custom[id] = std::make_unique<ConstraintBucket<T>>();
+        return static_cast<ConstraintBucket<T>&>(*m_custom[id]);
+    }
+};
+
+#endif //PHYSICSENGINE_CONSTRAINTSTORE_H
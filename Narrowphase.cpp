@@ -0,0 +1,463 @@
+#include "Narrowphase.h"
+#include <algorithm>
+#include <cmath>
+
+// ============ DETECTION ============
+
+bool DetectCircleCircle(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out) {
+    sf::Vector2f diff = bodies.positions[b] - bodies.positions[a];
+    float distSq = diff.x * diff.x + diff.y * diff.y;
+    float radiusSum = bodies.colliders[a].circle.radius + bodies.colliders[b].circle.radius;
+
+    if (distSq >= radiusSum * radiusSum) return false;
+
+    float distance = std::sqrt(distSq);
+    out.bodyA = a;
+    out.bodyB = b;
+    out.type = ContactType::CircleCircle;
+
+    if (distance < 0.0001f) {
+        out.normal = {1.f, 0.f};
+        out.penetration = radiusSum;
+    } else {
+        out.normal = diff / distance; //normal vector from center A to B
+        out.penetration = radiusSum - distance;
+    }
+    return true;
+}
+
+bool DetectCircleAABB(const BodyStore& bodies, std::uint32_t circle, std::uint32_t box, Contact& out) {
+    const sf::Vector2f circlePos = bodies.positions[circle];
+    const sf::Vector2f boxPos = bodies.positions[box];
+    const sf::Vector2f halfExtents = bodies.colliders[box].aabb.halfExtents;
+
+    sf::Vector2f boxMin = boxPos - halfExtents;
+    sf::Vector2f boxMax = boxPos + halfExtents;
+
+    sf::Vector2f closestPoint;
+    closestPoint.x = std::clamp(circlePos.x, boxMin.x, boxMax.x);
+    closestPoint.y = std::clamp(circlePos.y, boxMin.y, boxMax.y);
+
+    sf::Vector2f diff = circlePos - closestPoint;
+    float distSq = diff.x * diff.x + diff.y * diff.y;
+    float radius = bodies.colliders[circle].circle.radius;
+
+    if (distSq >= radius * radius) return false;
+
+    float distance = std::sqrt(distSq);
+    sf::Vector2f normal;   // box -> circle
+    float penetration;
+
+    if (distance < 0.0001f) {
+        // Center inside the box: push out along the shallow axis
+        float overlapX = halfExtents.x - std::abs(circlePos.x - boxPos.x);
+        float overlapY = halfExtents.y - std::abs(circlePos.y - boxPos.y);
+
+        if (overlapX < overlapY) {
+            normal = {(circlePos.x < boxPos.x) ? -1.f : 1.f, 0.f};
+            penetration = overlapX + radius;
+        } else {
+            normal = {0.f, (circlePos.y < boxPos.y) ? -1.f : 1.f};
+            penetration = overlapY + radius;
+        }
+    } else {
+        normal = diff / distance;
+        penetration = radius - distance;
+    }
+
+    out.bodyA = circle;
+    out.bodyB = box;
+    out.normal = -normal;
+    out.penetration = penetration;
+    out.type = ContactType::CircleAABB;
+    return true;
+}
+
+bool DetectAABBAABB(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out) {
+    const sf::Vector2f posA = bodies.positions[a];
+    const sf::Vector2f posB = bodies.positions[b];
+    const sf::Vector2f halfA = bodies.colliders[a].aabb.halfExtents;
+    const sf::Vector2f halfB = bodies.colliders[b].aabb.halfExtents;
+
+    sf::Vector2f aMin = posA - halfA;
+    sf::Vector2f aMax = posA + halfA;
+    sf::Vector2f bMin = posB - halfB;
+    sf::Vector2f bMax = posB + halfB;
+
+    if (aMax.x < bMin.x || aMin.x > bMax.x) return false;
+    if (aMax.y < bMin.y || aMin.y > bMax.y) return false;
+
+    float overlapX = std::min(aMax.x - bMin.x, bMax.x - aMin.x);
+    float overlapY = std::min(aMax.y - bMin.y, bMax.y - aMin.y);
+
+    out.bodyA = a;
+    out.bodyB = b;
+    out.type = ContactType::AABBAABB;
+
+    if (overlapX < overlapY) {
+        out.penetration = overlapX;
+        out.normal = (posA.x < posB.x) ? sf::Vector2f{1.f, 0.f} : sf::Vector2f{-1.f, 0.f};
+    } else {
+        out.penetration = overlapY;
+        out.normal = (posA.y < posB.y) ? sf::Vector2f{0.f, 1.f} : sf::Vector2f{0.f, -1.f};
+    }
+    return true;
+}
+
+// ============ CONTINUOUS ============
+
+static float Dot(sf::Vector2f a, sf::Vector2f b) { return a.x * b.x + a.y * b.y; }
+
+// First t in [0, 1] where |start + motion * t| = radius, start outside
+static bool SweepPointCircle(sf::Vector2f start, sf::Vector2f motion, float radius, float& time) {
+    const float a = Dot(motion, motion);
+    const float b = Dot(start, motion);
+    const float c = Dot(start, start) - radius * radius;
+    const float disc = b * b - a * c;
+    if (a < 1e-12f || b >= 0.f || disc < 0.f) return false;   // not moving closer / misses
+
+    const float t = (-b - std::sqrt(disc)) / a;
+    if (t < 0.f || t > 1.f) return false;
+    time = t;
+    return true;
+}
+
+bool SweepContact(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, float& time, Contact& out) {
+    ColliderType typeA = bodies.colliders[a].type;
+    ColliderType typeB = bodies.colliders[b].type;
+
+    if (typeA == ColliderType::Circle && typeB == ColliderType::Circle) return SweepCircleCircle(bodies, a, b, time, out);
+    if (typeA == ColliderType::Circle && typeB == ColliderType::AABB) return SweepCircleAABB(bodies, a, b, time, out);
+    if (typeA == ColliderType::AABB && typeB == ColliderType::Circle) return SweepCircleAABB(bodies, b, a, time, out);
+    return false;
+}
+
+// In A's frame: B sits still at its start and A moves by the relative motion
+bool SweepCircleCircle(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, float& time, Contact& out) {
+    const sf::Vector2f start = bodies.oldPositions[a] - bodies.oldPositions[b];
+    const sf::Vector2f motion = (bodies.positions[a] - bodies.oldPositions[a]) - (bodies.positions[b] - bodies.oldPositions[b]);
+    const float radiusSum = bodies.colliders[a].circle.radius + bodies.colliders[b].circle.radius;
+
+    if (Dot(start, start) < radiusSum * radiusSum) return false;   // overlapping already
+    if (!SweepPointCircle(start, motion, radiusSum, time)) return false;
+
+    out.bodyA = a;
+    out.bodyB = b;
+    out.type = ContactType::CircleCircle;
+    out.normal = -(start + motion * time) / radiusSum;   // A -> B
+    out.penetration = 0.f;
+    return true;
+}
+
+// Circle center as a ray against the box grown by the radius (corners rounded)
+bool SweepCircleAABB(const BodyStore& bodies, std::uint32_t circle, std::uint32_t box, float& time, Contact& out) {
+    const sf::Vector2f start = bodies.oldPositions[circle] - bodies.oldPositions[box];
+    const sf::Vector2f motion = (bodies.positions[circle] - bodies.oldPositions[circle]) - (bodies.positions[box] - bodies.oldPositions[box]);
+    const sf::Vector2f half = bodies.colliders[box].aabb.halfExtents;
+    const float radius = bodies.colliders[circle].circle.radius;
+
+    const sf::Vector2f closest = {std::clamp(start.x, -half.x, half.x), std::clamp(start.y, -half.y, half.y)};
+    const sf::Vector2f outside = start - closest;
+    if (Dot(outside, outside) < radius * radius) return false;   // overlapping already
+
+    // Slabs of the grown box
+    float enter = 0.f;
+    float exit = 1.f;
+    const float starts[2] = {start.x, start.y};
+    const float motions[2] = {motion.x, motion.y};
+    const float extents[2] = {half.x + radius, half.y + radius};
+    for (int axis = 0; axis < 2; ++axis) {
+        if (std::abs(motions[axis]) < 1e-8f) {
+            if (std::abs(starts[axis]) > extents[axis]) return false;
+            continue;
+        }
+        float t0 = (-extents[axis] - starts[axis]) / motions[axis];
+        float t1 = (extents[axis] - starts[axis]) / motions[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if (enter > exit) return false;
+    }
+
+    const sf::Vector2f hit = start + motion * enter;
+    sf::Vector2f normal;   // box -> circle
+    if (std::abs(hit.x) <= half.x) {
+        normal = {0.f, hit.y < 0.f ? -1.f : 1.f};
+    } else if (std::abs(hit.y) <= half.y) {
+        normal = {hit.x < 0.f ? -1.f : 1.f, 0.f};
+    } else {
+        // Entered through a corner region: the real surface there is the corner's circle
+        const sf::Vector2f corner = {hit.x < 0.f ? -half.x : half.x, hit.y < 0.f ? -half.y : half.y};
+        if (!SweepPointCircle(start - corner, motion, radius, enter)) return false;
+        normal = (start + motion * enter - corner) / radius;
+    }
+    if (Dot(motion, normal) >= 0.f) return false;   // touching at the start but moving off
+
+    time = enter;
+    out.bodyA = circle;
+    out.bodyB = box;
+    out.type = ContactType::CircleAABB;
+    out.normal = -normal;
+    out.penetration = 0.f;
+    return true;
+}
+
+// ============ RESOLUTION ============
+
+static void ResolveCircleCircle(BodyStore& bodies, const Contact& c, bool bounce) {
+    sf::Vector2f& posA = bodies.positions[c.bodyA];
+    sf::Vector2f& posB = bodies.positions[c.bodyB];
+    sf::Vector2f& oldA = bodies.oldPositions[c.bodyA];
+    sf::Vector2f& oldB = bodies.oldPositions[c.bodyB];
+    const bool staticA = bodies.isStatic[c.bodyA];
+    const bool staticB = bodies.isStatic[c.bodyB];
+    const sf::Vector2f normal = c.normal;
+
+    // Store velocities BEFORE any changes
+    sf::Vector2f velA = posA - oldA;
+    sf::Vector2f velB = posB - oldB;
+
+    // Positional correction - move BOTH to preserve velocity
+    sf::Vector2f correction = normal * (c.penetration * 0.5f);
+    if (!staticA) {
+        posA -= correction;
+        oldA -= correction;
+    }
+    if (!staticB) {
+        posB += correction;
+        oldB += correction;
+    }
+
+    // Elastic collision response
+    float bounceStrength = 0.5f;
+    sf::Vector2f relVel = velA - velB;
+    float relVelAlongNormal = relVel.x * normal.x + relVel.y * normal.y;
+    
+    // Only apply bounce if objects are approaching
+    if (bounce && relVelAlongNormal > 0) {
+        sf::Vector2f impulse = normal * (relVelAlongNormal * (1.f + bounceStrength) * 0.5f);
+        
+        // Adjust oldPosition to change velocity (not position)
+        if (!staticA) oldA += impulse;
+        if (!staticB) oldB -= impulse;
+    }
+}
+
+static void ResolveCircleAABB(BodyStore& bodies, const Contact& c, bool bounce) {
+    const std::uint32_t circle = c.bodyA;
+    const std::uint32_t box = c.bodyB;
+    sf::Vector2f& circlePos = bodies.positions[circle];
+    sf::Vector2f& circleOld = bodies.oldPositions[circle];
+    sf::Vector2f& boxPos = bodies.positions[box];
+    sf::Vector2f& boxOld = bodies.oldPositions[box];
+    const bool circleStatic = bodies.isStatic[circle];
+    const bool boxStatic = bodies.isStatic[box];
+    const sf::Vector2f normal = -c.normal;   // box -> circle
+
+    // Store velocity BEFORE any changes
+    sf::Vector2f vel = circlePos - circleOld;
+    float velAlongNormal = vel.x * normal.x + vel.y * normal.y;
+
+    // Positional correction - move BOTH to preserve velocity
+    sf::Vector2f correction = normal * c.penetration;
+    if (!circleStatic) {
+        circlePos += correction;
+        circleOld += correction;
+    }
+    if (!boxStatic) {
+        boxPos -= correction;
+        boxOld -= correction;
+    }
+
+    // Apply bounce if moving toward the surface
+    if (bounce && !circleStatic && velAlongNormal < 0) {
+        sf::Vector2f tangent = {-normal.y, normal.x};
+        float velAlongTangent = vel.x * tangent.x + vel.y * tangent.y;
+        
+        // Reflect: reverse normal component, apply friction to tangent
+        float newNormalVel = -velAlongNormal * bodies.bounciness[circle];
+        float newTangentVel = velAlongTangent * 0.98f;
+        
+        // Adjust oldPosition to create new velocity
+        // velocity change = newVel - oldVel
+        // oldPosition change = -(velocity change) = oldVel - newVel
+        sf::Vector2f oldNormalComp = normal * velAlongNormal;
+        sf::Vector2f oldTangentComp = tangent * velAlongTangent;
+        sf::Vector2f newNormalComp = normal * newNormalVel;
+        sf::Vector2f newTangentComp = tangent * newTangentVel;
+        
+        sf::Vector2f velChange = (newNormalComp + newTangentComp) - (oldNormalComp + oldTangentComp);
+        circleOld -= velChange;
+    }
+}
+
+static void ResolveAABBAABB(BodyStore& bodies, const Contact& c, bool bounce) {
+    sf::Vector2f& posA = bodies.positions[c.bodyA];
+    sf::Vector2f& posB = bodies.positions[c.bodyB];
+    sf::Vector2f& oldA = bodies.oldPositions[c.bodyA];
+    sf::Vector2f& oldB = bodies.oldPositions[c.bodyB];
+    const bool staticA = bodies.isStatic[c.bodyA];
+    const bool staticB = bodies.isStatic[c.bodyB];
+    const sf::Vector2f normal = -c.normal;   // direction A gets pushed
+
+    // Store velocities BEFORE any changes
+    sf::Vector2f velA = posA - oldA;
+    sf::Vector2f velB = posB - oldB;
+
+    // Positional correction - move BOTH to preserve velocity
+    sf::Vector2f correction = normal * (c.penetration * 0.5f);
+    if (!staticA) {
+        posA += correction;
+        oldA += correction;
+    }
+    if (!staticB) {
+        posB -= correction;
+        oldB -= correction;
+    }
+
+    // Bounce response
+    float bounceStrength = 0.5f;
+    sf::Vector2f relVel = velA - velB;
+    float relVelAlongNormal = relVel.x * normal.x + relVel.y * normal.y;
+    
+    if (bounce && relVelAlongNormal < 0) {
+        sf::Vector2f impulse = normal * (-relVelAlongNormal * (1.f + bounceStrength) * 0.5f);
+        
+        if (!staticA) oldA -= impulse;
+        if (!staticB) oldB += impulse;
+    }
+}
+
+// ============ SHAPE PAIRS ============
+
+bool ShapePair<ColliderType::Circle, ColliderType::Circle>::Detect(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out) {
+    return DetectCircleCircle(bodies, a, b, out);
+}
+void ShapePair<ColliderType::Circle, ColliderType::Circle>::Resolve(BodyStore& bodies, const Contact& contact, bool bounce) {
+    ResolveCircleCircle(bodies, contact, bounce);
+}
+
+bool ShapePair<ColliderType::Circle, ColliderType::AABB>::Detect(const BodyStore& bodies, std::uint32_t circle, std::uint32_t box, Contact& out) {
+    return DetectCircleAABB(bodies, circle, box, out);
+}
+void ShapePair<ColliderType::Circle, ColliderType::AABB>::Resolve(BodyStore& bodies, const Contact& contact, bool bounce) {
+    ResolveCircleAABB(bodies, contact, bounce);
+}
+
+bool ShapePair<ColliderType::AABB, ColliderType::AABB>::Detect(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out) {
+    return DetectAABBAABB(bodies, a, b, out);
+}
+void ShapePair<ColliderType::AABB, ColliderType::AABB>::Resolve(BodyStore& bodies, const Contact& contact, bool bounce) {
+    ResolveAABBAABB(bodies, contact, bounce);
+}
+
+// ============ BATCHES ============
+
+// The loops every batch runs, one instantiation per shape pair
+template <typename Pair>
+static void DetectAll(const BodyStore& bodies, std::span<const BodyPair> pairs, std::vector<Contact>& out) {
+    Contact contact;
+    for (const BodyPair& pair : pairs) {
+        if (Pair::Detect(bodies, pair.a, pair.b, contact)) out.push_back(contact);
+    }
+}
+
+template <typename Pair>
+static void ResolveAll(BodyStore& bodies, std::span<const Contact> contacts, bool bounce, bool refresh) {
+    for (Contact contact : contacts) {
+        if (refresh && !Pair::Detect(bodies, contact.bodyA, contact.bodyB, contact)) continue;
+        Pair::Resolve(bodies, contact, bounce);
+    }
+}
+
+// Function tables indexed by batch (= ContactType), built from ShapePairList
+template <typename List>
+struct ShapePairKernels;
+
+template <typename... Pairs>
+struct ShapePairKernels<ShapePairTypes<Pairs...>> {
+    using DetectOneFn = bool (*)(const BodyStore&, std::uint32_t, std::uint32_t, Contact&);
+    using ResolveOneFn = void (*)(BodyStore&, const Contact&, bool);
+    using DetectFn = void (*)(const BodyStore&, std::span<const BodyPair>, std::vector<Contact>&);
+    using ResolveFn = void (*)(BodyStore&, std::span<const Contact>, bool, bool);
+
+    static constexpr DetectOneFn DetectOne[] = {&Pairs::Detect...};
+    static constexpr ResolveOneFn ResolveOne[] = {&Pairs::Resolve...};
+    static constexpr DetectFn Detect[] = {&DetectAll<Pairs>...};
+    static constexpr ResolveFn Resolve[] = {&ResolveAll<Pairs>...};
+
+    static constexpr bool InContactTypeOrder() {
+        std::size_t index = 0;
+        return ((static_cast<std::size_t>(Pairs::Type) == index++) && ...);
+    }
+};
+
+using Kernels = ShapePairKernels<ShapePairList>;
+static_assert(Kernels::InContactTypeOrder(), "ShapePairList has to be in ContactType order");
+
+void SortPairsByShape(const BodyStore& bodies, std::span<const BodyPair> pairs, PairBatches& out) {
+    auto slotOf = [&](const BodyPair& pair) {
+        return FindShapePair(bodies.colliders[pair.a].type, bodies.colliders[pair.b].type);
+    };
+    auto finish = [&] {
+        out.start[0] = 0;
+        for (std::size_t k = 0; k < ShapePairCount; ++k) out.start[k + 1] = out.start[k] + out.views[k].size();
+    };
+
+    for (auto& batch : out.batches) batch.clear();
+    out.views.fill({});
+    if (pairs.empty()) {
+        finish();
+        return;
+    }
+
+    // Run of pairs that go into the first one's batch unswapped; if that's all of them, done
+    const ShapePairSlot head = slotOf(pairs[0]);
+    std::size_t run = 0;
+    if (head.batch != ShapePairSlot::None && !head.swap) {
+        while (run < pairs.size()) {
+            const ShapePairSlot slot = slotOf(pairs[run]);
+            if (slot.batch != head.batch || slot.swap) break;
+            ++run;
+        }
+    }
+    if (run == pairs.size()) {
+        out.views[head.batch] = pairs;
+        finish();
+        return;
+    }
+
+    // Mixed: the run goes in as is, then one bucket per pair
+    if (run > 0) out.batches[head.batch].assign(pairs.begin(), pairs.begin() + static_cast<std::ptrdiff_t>(run));
+    for (const BodyPair& pair : pairs.subspan(run)) {
+        const ShapePairSlot slot = slotOf(pair);
+        if (slot.batch == ShapePairSlot::None) continue;
+        out.batches[slot.batch].push_back(slot.swap ? BodyPair{pair.b, pair.a} : pair);
+    }
+    for (std::size_t k = 0; k < ShapePairCount; ++k) out.views[k] = out.batches[k];
+    finish();
+}
+
+void DetectBatch(std::size_t batch, const BodyStore& bodies, std::span<const BodyPair> pairs, std::vector<Contact>& out) {
+    Kernels::Detect[batch](bodies, pairs, out);
+}
+
+void ResolveBatch(std::size_t batch, BodyStore& bodies, std::span<const Contact> contacts, bool bounce, bool refresh) {
+    Kernels::Resolve[batch](bodies, contacts, bounce, refresh);
+}
+
+// One pair / contact at a time, same table
+bool DetectContact(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out) {
+    const ShapePairSlot slot = FindShapePair(bodies.colliders[a].type, bodies.colliders[b].type);
+    if (slot.batch == ShapePairSlot::None) return false;
+    return slot.swap ? Kernels::DetectOne[slot.batch](bodies, b, a, out)    // first shape goes first
+                     : Kernels::DetectOne[slot.batch](bodies, a, b, out);
+}
+
+bool RefreshContact(const BodyStore& bodies, Contact& contact) {
+    return Kernels::DetectOne[static_cast<std::size_t>(contact.type)](bodies, contact.bodyA, contact.bodyB, contact);
+}
+
+void ResolveContact(BodyStore& bodies, const Contact& contact, bool bounce) {
+    Kernels::ResolveOne[static_cast<std::size_t>(contact.type)](bodies, contact, bounce);
+}
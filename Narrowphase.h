@@ -0,0 +1,162 @@
+#ifndef PHYSICSENGINE_NARROWPHASE_H
+#define PHYSICSENGINE_NARROWPHASE_H
+
+#include <SFML/System/Vector2.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "BodyStore.h"
+#include "Broadphase.h"
+
+/**
+ * Narrowphase, split in two:
+ *   Detect*  - read only, turns a candidate pair into a Contact
+ *   Resolve  - moves the bodies for one Contact
+ *
+ * Detection doesn't write anything, so it can run on many threads at once.
+ * The Step goes through the batched versions at the bottom; the per pair
+ * functions are for everything else (queries, CCD, tests).
+ */
+
+enum class ContactType : std::uint8_t {   // = batch index in ShapePairList
+    CircleCircle,
+    CircleAABB,    // bodyA is always the circle
+    AABBAABB
+};
+
+struct Contact {
+    std::uint32_t bodyA;     // dense body indices
+    std::uint32_t bodyB;
+    sf::Vector2f normal;     // from A towards B (push B along it, A against it)
+    float penetration;
+    ContactType type;
+};
+
+bool DetectCircleCircle(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out);
+bool DetectCircleAABB(const BodyStore& bodies, std::uint32_t circle, std::uint32_t box, Contact& out);
+bool DetectAABBAABB(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out);
+
+// Picks the right Detect* for the two collider types
+bool DetectContact(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out);
+
+// Recompute normal/penetration of an existing contact from the current positions,
+// same pair, no broadphase. false = no longer touching.
+bool RefreshContact(const BodyStore& bodies, Contact& contact);
+
+// Swept tests for fast circles, read only like Detect*. Both bodies move from
+// oldPosition to position; time is where in that [0, 1] the circle first touches
+// the other shape and out is the contact at that moment (penetration 0). false if
+// they don't meet this step, or already overlap at the start (Detect* has those).
+bool SweepCircleCircle(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, float& time, Contact& out);
+bool SweepCircleAABB(const BodyStore& bodies, std::uint32_t circle, std::uint32_t box, float& time, Contact& out);
+
+// Picks the right Sweep* (bodyA is the circle, like Detect*); false for two AABBs
+bool SweepContact(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, float& time, Contact& out);
+
+// Positional correction + bounce (bounce = false -> only push apart, velocity is kept)
+void ResolveContact(BodyStore& bodies, const Contact& contact, bool bounce = true);
+
+// ============ BATCHES ============
+
+/**
+ * Compile time shape pair dispatch
+ *
+ * One ShapePair specialization per pair of shapes that can touch, First is the
+ * contact's bodyA. SortPairsByShape puts the candidate pairs into one batch per
+ * ShapePairList entry (First shape in .a), then each batch runs through its own
+ * instantiation of the loops in Narrowphase.cpp: no type check per pair, and the
+ * kernels inline into them.
+ *
+ * New shape: a ColliderType, a ContactType per pair it can touch, a ShapePair
+ * specialization for each of those (Type, Detect, Resolve, defined next to the
+ * others), and the pairs appended to ShapePairList in ContactType order.
+ */
+template <ColliderType A, ColliderType B>
+struct ShapePair;   // not specialized = these two never collide
+
+template <ColliderType A, ColliderType B>
+struct ShapePairShapes {
+    static constexpr ColliderType First = A;
+    static constexpr ColliderType Second = B;
+};
+
+template <>
+struct ShapePair<ColliderType::Circle, ColliderType::Circle> : ShapePairShapes<ColliderType::Circle, ColliderType::Circle> {
+    static constexpr ContactType Type = ContactType::CircleCircle;
+    static bool Detect(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out);
+    static void Resolve(BodyStore& bodies, const Contact& contact, bool bounce);
+};
+
+template <>
+struct ShapePair<ColliderType::Circle, ColliderType::AABB> : ShapePairShapes<ColliderType::Circle, ColliderType::AABB> {
+    static constexpr ContactType Type = ContactType::CircleAABB;
+    static bool Detect(const BodyStore& bodies, std::uint32_t circle, std::uint32_t box, Contact& out);
+    static void Resolve(BodyStore& bodies, const Contact& contact, bool bounce);
+};
+
+template <>
+struct ShapePair<ColliderType::AABB, ColliderType::AABB> : ShapePairShapes<ColliderType::AABB, ColliderType::AABB> {
+    static constexpr ContactType Type = ContactType::AABBAABB;
+    static bool Detect(const BodyStore& bodies, std::uint32_t a, std::uint32_t b, Contact& out);
+    static void Resolve(BodyStore& bodies, const Contact& contact, bool bounce);
+};
+
+template <typename... Pairs>
+struct ShapePairTypes {
+    static constexpr std::size_t Count = sizeof...(Pairs);
+};
+
+using ShapePairList = ShapePairTypes<ShapePair<ColliderType::Circle, ColliderType::Circle>,
+                                     ShapePair<ColliderType::Circle, ColliderType::AABB>,
+                                     ShapePair<ColliderType::AABB, ColliderType::AABB>>;
+constexpr std::size_t ShapePairCount = ShapePairList::Count;
+
+// Where a pair of collider types goes: its batch, and whether a and b trade places
+struct ShapePairSlot {
+    static constexpr std::uint8_t None = 0xFF;
+    std::uint8_t batch = None;
+    bool swap = false;
+};
+
+template <typename... Pairs>
+constexpr auto MakeShapePairTable(ShapePairTypes<Pairs...>) {
+    std::array<std::array<ShapePairSlot, ColliderTypeCount>, ColliderTypeCount> table{};
+    std::uint8_t batch = 0;
+    auto add = [&](ColliderType first, ColliderType second) {
+        table[static_cast<std::size_t>(first)][static_cast<std::size_t>(second)] = {batch, false};
+        if (first != second) table[static_cast<std::size_t>(second)][static_cast<std::size_t>(first)] = {batch, true};
+        ++batch;
+    };
+    (add(Pairs::First, Pairs::Second), ...);
+    return table;
+}
+
+inline constexpr auto ShapePairTable = MakeShapePairTable(ShapePairList{});
+
+inline ShapePairSlot FindShapePair(ColliderType a, ColliderType b) {
+    return ShapePairTable[static_cast<std::size_t>(a)][static_cast<std::size_t>(b)];
+}
+
+// Candidate pairs sorted into batches, kept between Steps so nothing reallocates
+struct PairBatches {
+    std::array<std::span<const BodyPair>, ShapePairCount> views;  // batch k's pairs, input order within one
+    std::array<std::size_t, ShapePairCount + 1> start{};          // batch k = [start[k], start[k + 1]) of all of them in a row
+    std::array<std::vector<BodyPair>, ShapePairCount> batches;    // what views point at, unless all pairs were one batch
+
+    std::size_t Size() const { return start[ShapePairCount]; }
+};
+
+// Bucket sort by shape pair (one table lookup per pair); pairs nothing collides for are left out.
+// When every pair lands in the same batch as is (all circles, say), that batch is a view of
+// the input and nothing is copied. The views are only good while pairs is.
+void SortPairsByShape(const BodyStore& bodies, std::span<const BodyPair> pairs, PairBatches& out);
+
+// Detect over pairs that are all in `batch` (a slice of one of PairBatches::batches), contacts appended to out
+void DetectBatch(std::size_t batch, const BodyStore& bodies, std::span<const BodyPair> pairs, std::vector<Contact>& out);
+
+// Resolve contacts that are all of ContactType `batch`, in order. refresh = re-measure each
+// one from the current positions first and skip it if apart (what RefreshContact does).
+void ResolveBatch(std::size_t batch, BodyStore& bodies, std::span<const Contact> contacts, bool bounce, bool refresh);
+
+#endif //PHYSICSENGINE_NARROWPHASE_H
@@ -2,8 +2,8 @@
 #define PHYSICSENGINE_OBJECT_H
 
 #include <SFML/System/Vector2.hpp>
-#include <memory>
 #include "Collider.h"
+#include "BodyStore.h"
 
 struct Object {
     sf::Vector2f position;
@@ -15,7 +15,10 @@ struct Object {
     float bounciness = 0.7f;
     bool isStatic = false;
     
-    std::unique_ptr<Collider> collider;
+    Collider collider;   // inline, type None = no collider
+
+    BodyHandle body;   // set by PhysicsWorld::AddObject, the world keeps its own copy of the state
+    void* userData = nullptr;   // game side back pointer, the world never writes it (PhysicsThread copies it into snapshots)
     
     // Initialize oldPosition to match position (object starts at rest)
     void InitVerlet() {
@@ -48,18 +51,20 @@ struct Object {
     }
     
     // Helper to get collider as specific type (returns nullptr if wrong type)
-    CircleCollider* GetCircleCollider() const {
-        if (collider && collider->type == ColliderType::Circle) {
-            return static_cast<CircleCollider*>(collider.get());
-        }
-        return nullptr;
+    CircleCollider* GetCircleCollider() {
+        return collider.type == ColliderType::Circle ? &collider.circle : nullptr;
+    }
+
+    const CircleCollider* GetCircleCollider() const {
+        return collider.type == ColliderType::Circle ? &collider.circle : nullptr;
     }
     
-    AABBCollider* GetAABBCollider() const {
-        if (collider && collider->type == ColliderType::AABB) {
-            return static_cast<AABBCollider*>(collider.get());
-        }
-        return nullptr;
+    AABBCollider* GetAABBCollider() {
+        return collider.type == ColliderType::AABB ? &collider.aabb : nullptr;
+    }
+
+    const AABBCollider* GetAABBCollider() const {
+        return collider.type == ColliderType::AABB ? &collider.aabb : nullptr;
     }
 };
 
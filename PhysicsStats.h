@@ -0,0 +1,160 @@
+#ifndef PHYSICSENGINE_PHYSICSSTATS_H
+#define PHYSICSENGINE_PHYSICSSTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set to 0 (CMake: -DPHYSICS_STATS=OFF) and all the timing/counting in Step compiles away
+#ifndef PHYSICS_ENABLE_STATS
+    #define PHYSICS_ENABLE_STATS 1
+#endif
+
+enum class StepPhase {
+    Integrate,      // gravity + Verlet, fused into one kernel
+    Constraints,
+    Broadphase,     // proxies + FindPairs
+    Narrowphase,    // contact detection
+    Resolve,        // contact resolution
+    Sleep,          // islands + sleep/wake
+    Record,         // TrajectoryRecorder encode, if one is set
+    Reorder,        // spatial reorder of body storage, on the Steps it runs
+    Count
+};
+
+inline const char* StepPhaseName(StepPhase phase) {
+    switch (phase) {
+        case StepPhase::Integrate:   return "integrate";
+        case StepPhase::Constraints: return "constraints";
+        case StepPhase::Broadphase:  return "broadphase";
+        case StepPhase::Narrowphase: return "narrowphase";
+        case StepPhase::Resolve:     return "resolve";
+        case StepPhase::Sleep:       return "sleep";
+        case StepPhase::Record:      return "record";
+        case StepPhase::Reorder:     return "reorder";
+        case StepPhase::Count:       break;
+    }
+    return "?";
+}
+
+// Everything measured for one Step
+struct StepStats {
+    static constexpr std::size_t PhaseCount = static_cast<std::size_t>(StepPhase::Count);
+
+    double phaseMs[PhaseCount] = {};
+    double totalMs = 0.0;
+    std::uint32_t pairsTested = 0;         // broadphase candidates handed to the narrowphase
+    std::uint32_t contactsFound = 0;
+    std::uint32_t constraintsSolved = 0;   // constraints * iterations
+    std::uint32_t constraintIterations = 0;   // run this Step, <= the set count with a tolerance
+    std::uint32_t bodiesSkipped = 0;       // static or asleep, not integrated
+    std::uint32_t bodiesSwept = 0;         // fast circles stopped at a time of impact (CCD)
+
+    double PhaseMs(StepPhase phase) const { return phaseMs[static_cast<std::size_t>(phase)]; }
+};
+
+/**
+ * Ring buffer of the last N Steps
+ *
+ * Always exists so callers don't need #ifs, it just stays empty when stats
+ * are compiled out (check PhysicsStats::Enabled).
+ */
+class PhysicsStats {
+public:
+    static constexpr bool Enabled = PHYSICS_ENABLE_STATS != 0;
+
+    explicit PhysicsStats(std::size_t historySize = 240) { SetHistorySize(historySize); }
+
+    void SetHistorySize(std::size_t size) {
+        m_history.assign(size > 0 ? size : 1, StepStats{});
+        m_next = 0;
+        m_count = 0;
+    }
+    std::size_t GetHistorySize() const { return m_history.size(); }
+
+    // Number of recorded steps in the history (<= history size)
+    std::size_t Count() const { return m_count; }
+
+    // 0 = most recent
+    const StepStats& Recent(std::size_t age) const {
+        return m_history[(m_next + m_history.size() - 1 - age) % m_history.size()];
+    }
+    const StepStats& Last() const { return Recent(0); }
+
+    // Mean over the history
+    StepStats Average() const {
+        StepStats avg;
+        if (m_count == 0) return avg;
+
+        double pairs = 0, contacts = 0, constraints = 0, iterations = 0, skipped = 0, swept = 0;
+        for (std::size_t i = 0; i < m_count; ++i) {
+            const StepStats& s = Recent(i);
+            for (std::size_t p = 0; p < StepStats::PhaseCount; ++p) avg.phaseMs[p] += s.phaseMs[p];
+            avg.totalMs += s.totalMs;
+            pairs += s.pairsTested;
+            contacts += s.contactsFound;
+            constraints += s.constraintsSolved;
+            iterations += s.constraintIterations;
+            skipped += s.bodiesSkipped;
+            swept += s.bodiesSwept;
+        }
+
+        const double n = static_cast<double>(m_count);
+        for (double& ms : avg.phaseMs) ms /= n;
+        avg.totalMs /= n;
+        avg.pairsTested = static_cast<std::uint32_t>(pairs / n);
+        avg.contactsFound = static_cast<std::uint32_t>(contacts / n);
+        avg.constraintsSolved = static_cast<std::uint32_t>(constraints / n);
+        avg.constraintIterations = static_cast<std::uint32_t>(iterations / n + 0.5);
+        avg.bodiesSkipped = static_cast<std::uint32_t>(skipped / n);
+        avg.bodiesSwept = static_cast<std::uint32_t>(swept / n + 0.5);
+        return avg;
+    }
+
+    void Record(const StepStats& stats) {
+        m_history[m_next] = stats;
+        m_next = (m_next + 1) % m_history.size();
+        if (m_count < m_history.size()) ++m_count;
+    }
+
+    void Clear() { SetHistorySize(m_history.size()); }
+
+private:
+    std::vector<StepStats> m_history;
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+};
+
+#if PHYSICS_ENABLE_STATS
+// Adds the time until the end of the scope to one phase
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(StepStats& stats, StepPhase phase)
+        : m_stats(stats), m_phase(phase), m_start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedPhaseTimer() {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_start;
+        m_stats.phaseMs[static_cast<std::size_t>(m_phase)] += elapsed.count();
+    }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    StepStats& m_stats;
+    StepPhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+    #define PHYSICS_STATS_CONCAT_(a, b) a##b
+    #define PHYSICS_STATS_CONCAT(a, b) PHYSICS_STATS_CONCAT_(a, b)
+    #define PHYSICS_TIME_PHASE(stats, phase) \
+        ScopedPhaseTimer PHYSICS_STATS_CONCAT(phaseTimer_, __LINE__)(stats, phase)
+    #define PHYSICS_STAT(statement) statement
+#else
+    #define PHYSICS_TIME_PHASE(stats, phase) ((void)0)
+    #define PHYSICS_STAT(statement) ((void)0)
+#endif
+
+#endif //PHYSICSENGINE_PHYSICSSTATS_H
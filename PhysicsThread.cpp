@@ -0,0 +1,151 @@
+#include "PhysicsThread.h"
+#include <bit>
+#include <chrono>
+
+PhysicsThread::PhysicsThread(PhysicsWorld& world) : m_world(world) {
+    Publish();   // so Latest() has the initial scene before the first step
+}
+
+PhysicsThread::~PhysicsThread() {
+    Stop();
+}
+
+void PhysicsThread::Start() {
+    if (IsRunning()) return;
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread([this] { Run(); });
+}
+
+void PhysicsThread::Stop() {
+    if (!IsRunning()) return;
+    m_stop.store(true, std::memory_order_release);
+    m_thread.join();
+    ApplyCommands();   // whatever was posted last still happens
+    Publish();         // and shows up in commandsApplied
+}
+
+std::uint64_t PhysicsThread::Post(Command command) {
+    while (!m_commands.TryPush(std::move(command))) {
+        if (!IsRunning()) ApplyCommands();   // nobody else will drain it
+        std::this_thread::yield();
+    }
+    return ++m_posted;
+}
+
+void PhysicsThread::Pump(float frameDt) {
+    ApplyCommands();
+    m_steps += static_cast<std::uint64_t>(m_world.Update(frameDt));
+    Publish();
+}
+
+void PhysicsThread::SetPickPoint(sf::Vector2f point) {
+    const std::uint64_t bits = (static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(point.x)) << 32) |
+                               std::bit_cast<std::uint32_t>(point.y);
+    m_pickPoint.store(bits, std::memory_order_relaxed);
+}
+
+void PhysicsThread::ClearPickPoint() {
+    m_pickPoint.store(NoPickPoint, std::memory_order_relaxed);
+}
+
+void PhysicsThread::SetCullBounds(sf::Vector2f min, sf::Vector2f max) {
+    Post([this, min, max](PhysicsWorld&) {
+        m_cullEnabled = true;
+        m_cullMin = min;
+        m_cullMax = max;
+    });
+}
+
+void PhysicsThread::ApplyCommands() {
+    Command command;
+    while (m_commands.TryPop(command)) {
+        command(m_world);
+        ++m_applied;
+    }
+}
+
+void PhysicsThread::Run() {
+    using Clock = std::chrono::steady_clock;
+    auto last = Clock::now();
+
+    while (!m_stop.load(std::memory_order_acquire)) {
+        const std::uint64_t appliedBefore = m_applied;
+        ApplyCommands();
+
+        const auto now = Clock::now();
+        const float elapsed = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        const int steps = m_world.Update(elapsed);
+        m_steps += static_cast<std::uint64_t>(steps);
+        if (steps > 0 || m_applied != appliedBefore) Publish();
+
+        // Sleep off what's left until the next fixed step is due
+        const float untilNext = m_world.GetFixedTimestep() * (1.f - m_world.GetInterpolationAlpha());
+        std::this_thread::sleep_until(now + std::chrono::duration<float>(untilNext));
+    }
+}
+
+void PhysicsThread::Publish() {
+    RenderSnapshot& snapshot = m_snapshots.Back();
+    const BodyStore& bodies = m_world.GetBodies();
+    const std::size_t ids = bodies.IdCount();
+    const float alpha = m_world.GetInterpolationAlpha();
+    const float step = m_world.GetFixedTimestep();
+
+    // resize/assign keep the capacity, steady state doesn't allocate
+    snapshot.positions.resize(ids);
+    snapshot.velocities.resize(ids);
+    snapshot.masses.resize(ids);
+    snapshot.linked.resize(ids);
+    snapshot.userData.resize(ids);
+    snapshot.generations.resize(ids);
+    snapshot.alive.assign(ids, 0);
+    snapshot.outside.clear();
+
+    for (std::uint32_t i = 0; i < bodies.Size(); ++i) {
+        const BodyHandle handle = bodies.HandleAt(i);
+        const std::uint32_t id = handle.id;
+        const sf::Vector2f previous = bodies.previousPositions[i];
+        snapshot.positions[id] = previous + (bodies.positions[i] - previous) * alpha;
+        snapshot.velocities[id] = (bodies.positions[i] - bodies.oldPositions[i]) / step;
+        snapshot.masses[id] = bodies.masses[i];
+        snapshot.linked[id] = bodies.linked[i];
+        snapshot.userData[id] = bodies.linked[i] ? bodies.linked[i]->userData : nullptr;
+        snapshot.generations[id] = handle.generation;
+        snapshot.alive[id] = 1;
+    }
+
+    // Only awake bodies can have left since the last publish
+    if (m_cullEnabled) {
+        for (std::uint32_t i : m_world.GetAwakeBodies()) {
+            const sf::Vector2f half = bodies.colliders[i].HalfExtents();
+            const sf::Vector2f p = bodies.positions[i];
+            if (p.x + half.x < m_cullMin.x || p.x - half.x > m_cullMax.x ||
+                p.y + half.y < m_cullMin.y || p.y - half.y > m_cullMax.y) {
+                snapshot.outside.push_back(bodies.HandleAt(i));
+            }
+        }
+    }
+
+    const std::uint64_t pick = m_pickPoint.load(std::memory_order_relaxed);
+    if (pick == NoPickPoint) {
+        snapshot.picked.clear();
+    } else {
+        const sf::Vector2f point = {std::bit_cast<float>(static_cast<std::uint32_t>(pick >> 32)),
+                                    std::bit_cast<float>(static_cast<std::uint32_t>(pick))};
+        m_world.QueryPoint(point, snapshot.picked);
+    }
+
+    snapshot.springs.clear();
+    m_world.GetConstraints().springs.ForEach([&](const SpringConstraint& c) {
+        snapshot.springs.push_back({c.bodyA, c.bodyB, c.restLength});
+    });
+
+    snapshot.stats = m_world.GetStats().Average();
+    snapshot.steps = m_steps;
+    snapshot.commandsApplied = m_applied;
+    snapshot.bodyCount = bodies.Size();
+
+    m_snapshots.Publish();
+}
@@ -0,0 +1,126 @@
+#ifndef PHYSICSENGINE_PHYSICSTHREAD_H
+#define PHYSICSENGINE_PHYSICSTHREAD_H
+
+#include <SFML/System/Vector2.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "PhysicsWorld.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+/**
+ * Everything the render side needs from one published step, by BodyHandle::id
+ *
+ * Read only for the renderer; it never has to touch the world or the
+ * linked Objects' state while the physics thread is running.
+ */
+struct RenderSnapshot {
+    struct SpringLine {
+        BodyHandle a;
+        BodyHandle b;
+        float restLength;
+    };
+
+    std::vector<sf::Vector2f> positions;      // interpolated with the world's alpha
+    std::vector<sf::Vector2f> velocities;     // units per second
+    std::vector<float> masses;
+    std::vector<std::uint8_t> alive;
+    std::vector<std::uint32_t> generations;   // stale handles don't match
+    std::vector<const Object*> linked;        // to find an Object's handle, never dereferenced
+    std::vector<void*> userData;              // the linked Object's userData, copied at publish
+    std::vector<SpringLine> springs;
+
+    // See PhysicsThread::SetPickPoint / SetCullBounds
+    std::vector<BodyHandle> picked;           // shapes under the pick point, body order
+    std::vector<BodyHandle> outside;          // awake dynamic bodies whose bounds left the cull box
+
+    StepStats stats;                          // average over the world's stats history
+    std::uint64_t steps = 0;                  // total Steps so far
+    std::uint64_t commandsApplied = 0;        // see PhysicsThread::Post
+    std::size_t bodyCount = 0;
+
+    bool Contains(BodyHandle body) const {
+        return body.id < alive.size() && alive[body.id] && generations[body.id] == body.generation;
+    }
+    sf::Vector2f Position(BodyHandle body) const { return Contains(body) ? positions[body.id] : sf::Vector2f{}; }
+    sf::Vector2f Velocity(BodyHandle body) const { return Contains(body) ? velocities[body.id] : sf::Vector2f{}; }
+
+    // O(ids), meant to be cached by the caller
+    BodyHandle FindLinked(const Object* object) const {
+        for (std::uint32_t id = 0; id < linked.size(); ++id) {
+            if (alive[id] && linked[id] == object) return BodyHandle{id, generations[id]};
+        }
+        return BodyHandle{};
+    }
+};
+
+/**
+ * Runs a PhysicsWorld on its own thread at the world's fixed timestep
+ *
+ * After Start() the world belongs to the physics thread: the only ways in
+ * are Post()ed commands (lock-free queue), the only way out is Latest()
+ * (lock-free triple buffer). Without Start(), Pump() does the same work on
+ * the calling thread, so the render code is identical in both modes.
+ */
+class PhysicsThread {
+public:
+    using Command = std::function<void(PhysicsWorld&)>;
+
+    explicit PhysicsThread(PhysicsWorld& world);
+    ~PhysicsThread();
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // Render side. Returns the command's sequence number; it has run once
+    // Latest().commandsApplied >= that. Yields while the queue is full.
+    std::uint64_t Post(Command command);
+
+    // Single threaded mode: apply commands, world.Update(frameDt), publish
+    void Pump(float frameDt);
+
+    // Render side
+    const RenderSnapshot& Latest() { return m_snapshots.Latest(); }
+
+    // Render side. Every publish runs world.QueryPoint at the last point set here and
+    // puts the hits in RenderSnapshot::picked, so picking doesn't scan anything.
+    void SetPickPoint(sf::Vector2f point);
+    void ClearPickPoint();
+
+    // Awake dynamic bodies entirely outside [min, max] get listed in RenderSnapshot::outside.
+    // Only PhysicsWorld::GetAwakeBodies() is checked: a body that falls asleep out there
+    // was listed while it was still moving.
+    void SetCullBounds(sf::Vector2f min, sf::Vector2f max);
+
+private:
+    PhysicsWorld& m_world;
+    SpscQueue<Command, 1024> m_commands;
+    TripleBuffer<RenderSnapshot> m_snapshots;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+
+    std::atomic<std::uint64_t> m_pickPoint{NoPickPoint};   // x/y float bits packed, lock-free
+    static constexpr std::uint64_t NoPickPoint = ~0ull;    // a NaN pair, never a real point
+
+    // Physics side, set through a posted command
+    bool m_cullEnabled = false;
+    sf::Vector2f m_cullMin;
+    sf::Vector2f m_cullMax;
+
+    std::uint64_t m_posted = 0;    // render side only
+    std::uint64_t m_applied = 0;   // physics side only
+    std::uint64_t m_steps = 0;
+
+    void Run();
+    void ApplyCommands();
+    void Publish();
+};
+
+#endif //PHYSICSENGINE_PHYSICSTHREAD_H
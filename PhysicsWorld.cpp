@@ -1,308 +1,1255 @@
 #include "PhysicsWorld.h"
+#include "VerletKernels.h"
+#include "TrajectoryRecorder.h"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 PhysicsWorld::PhysicsWorld() {
     m_gravity = {0.f, 1000.f};
+    m_broadphase = MakeBroadphase(BroadphaseType::UniformGrid);
 }
 
-void PhysicsWorld::AddObject(Object* object) {
-    m_objects.push_back(object);
+void PhysicsWorld::SetBroadphase(BroadphaseType type) {
+    m_broadphase = MakeBroadphase(type);
+    m_queryStale = true;
+}
+
+// ============ BODY MANAGEMENT ============
+
+BodyHandle PhysicsWorld::AddBody(const BodyDesc& desc) {
+    BodyHandle handle = m_bodies.Add(desc);
+    if (desc.isStatic) m_staticDirty = true;
+
+    m_awakeSlot.push_back(NotAwake);
+    if (!desc.isStatic) AddAwake(m_bodies.IndexOf(handle));
+    if (m_islandHead.size() < m_bodies.IdCount()) {
+        m_islandHead.resize(m_bodies.IdCount(), BodyStore::NoIsland);
+        m_islandNext.resize(m_bodies.IdCount(), BodyStore::NoIsland);
+        m_islandPrev.resize(m_bodies.IdCount(), BodyStore::NoIsland);
+    }
+    m_queryStale = true;   // no Reset(): the new body is the last proxy, nothing got renumbered
+    return handle;
+}
+
+void PhysicsWorld::ReserveBodies(std::size_t count) {
+    m_bodies.Reserve(count);
+    m_proxies.reserve(count);
+    m_awake.reserve(count);
+    m_awakeSlot.reserve(count);
+    m_islandHead.reserve(count);
+    m_islandNext.reserve(count);
+    m_islandPrev.reserve(count);
+    m_islandParent.reserve(count);
+    m_islandRest.reserve(count);
+    m_islandStamp.reserve(count);
+    m_islandTouched.reserve(count);
+    m_fallingAsleep.reserve(count);
+    m_wakeIslands.reserve(count);
+    m_removeScratch.reserve(count);
+}
+
+void PhysicsWorld::RemoveBody(BodyHandle body) {
+    RemoveBodies(std::span<const BodyHandle>(&body, 1));
+}
+
+void PhysicsWorld::RemoveBodies(std::span<const BodyHandle> bodies) {
+    // They may have been holding the rest of their islands up. Done first, while
+    // the dense indices are still the ones the wake queue expects.
+    bool removedAny = false;
+    for (BodyHandle body : bodies) {
+        std::uint32_t index = m_bodies.IndexOf(body);
+        if (index == BodyStore::InvalidIndex) continue;
+        QueueWake(index);
+        removedAny = true;
+    }
+    if (!removedAny) return;
+    FlushWakes();
+
+    // Last Step's contacts hold dense indices, which swap-and-pop is about to shuffle
+    m_contactBodies.resize(m_contacts.size() * 2);
+    for (std::size_t i = 0; i < m_contacts.size(); ++i) {
+        m_contactBodies[2 * i] = m_bodies.HandleAt(m_contacts[i].bodyA);
+        m_contactBodies[2 * i + 1] = m_bodies.HandleAt(m_contacts[i].bodyB);
+    }
+
+    for (BodyHandle body : bodies) {
+        std::uint32_t index = m_bodies.IndexOf(body);
+        if (index == BodyStore::InvalidIndex) continue;   // stale, or listed twice
+
+        if (Object* obj = m_bodies.linked[index]) {
+            obj->body = BodyHandle{};
+            --m_linkedCount;
+        }
+        if (m_bodies.asleep[index]) {   // only if static, dynamic ones were woken above
+            UnlinkIsland(index);
+            --m_sleepingCount;
+        }
+        // Same swap-and-pop on the awake list's back references
+        RemoveAwake(index);
+        const std::uint32_t last = static_cast<std::uint32_t>(m_bodies.Size() - 1);
+        if (index != last) {
+            m_awakeSlot[index] = m_awakeSlot[last];
+            if (m_awakeSlot[index] != NotAwake) m_awake[m_awakeSlot[index]] = index;
+        }
+        m_awakeSlot.pop_back();
+        // Swap-and-pop: the static layer only cares if a static body goes or moves index
+        if (m_bodies.isStatic[index] || m_bodies.isStatic[m_bodies.Size() - 1]) m_staticDirty = true;
+        if (m_bodies.asleep[index] || m_bodies.asleep[m_bodies.Size() - 1]) m_sleepingDirty = true;
+        m_bodies.Remove(body);
+    }
+
+    // Back to the new indices, dropping the ones that lost a body
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < m_contacts.size(); ++i) {
+        const std::uint32_t a = m_bodies.IndexOf(m_contactBodies[2 * i]);
+        const std::uint32_t b = m_bodies.IndexOf(m_contactBodies[2 * i + 1]);
+        if (a == BodyStore::InvalidIndex || b == BodyStore::InvalidIndex) continue;
+        m_contacts[kept] = m_contacts[i];
+        m_contacts[kept].bodyA = a;
+        m_contacts[kept].bodyB = b;
+        ++kept;
+    }
+    m_contacts.resize(kept);
+    m_pairs.clear();
+    m_broadphase->Reset();
+    m_queryStale = true;
+}
+
+sf::Vector2f PhysicsWorld::GetPosition(BodyHandle body) const {
+    std::uint32_t index = m_bodies.IndexOf(body);
+    return index == BodyStore::InvalidIndex ? sf::Vector2f{} : m_bodies.positions[index];
+}
+
+void PhysicsWorld::SetPosition(BodyHandle body, sf::Vector2f position) {
+    std::uint32_t index = m_bodies.IndexOf(body);
+    if (index == BodyStore::InvalidIndex) return;
+
+    m_bodies.positions[index] = position;
+    m_bodies.previousPositions[index] = position;   // teleport, don't blend from the old spot
+    if (Object* obj = m_bodies.linked[index]) obj->position = position;
+    if (m_bodies.isStatic[index]) m_staticDirty = true;
+    m_queryStale = true;
+    QueueWake(index);
+    FlushWakes();
+}
+
+void PhysicsWorld::SetVelocity(BodyHandle body, sf::Vector2f velocity, float dt) {
+    std::uint32_t index = m_bodies.IndexOf(body);
+    if (index == BodyStore::InvalidIndex) return;
+
+    m_bodies.oldPositions[index] = m_bodies.positions[index] - velocity * dt;
+    if (Object* obj = m_bodies.linked[index]) obj->oldPosition = m_bodies.oldPositions[index];
+    QueueWake(index);
+    FlushWakes();
+}
+
+BodyHandle PhysicsWorld::AddObject(Object* object) {
+    BodyDesc desc;
+    desc.position = object->position;
+    desc.mass = object->mass;
+    desc.bounciness = object->bounciness;
+    desc.isStatic = object->isStatic;
+    desc.collider = object->collider;
+
+    BodyHandle handle = AddBody(desc);
+    std::uint32_t index = m_bodies.IndexOf(handle);
+    m_bodies.oldPositions[index] = object->oldPosition;
+    m_bodies.accelerations[index] = object->acceleration;
+    m_bodies.linked[index] = object;
+    ++m_linkedCount;
+
+    object->body = handle;
+    return handle;
 }
 
 void PhysicsWorld::RemoveObject(Object *object) {
-    m_objects.erase(std::remove(m_objects.begin(), m_objects.end(), object), m_objects.end());
+    RemoveObjects(std::span<Object* const>(&object, 1));
 }
 
-// ============ CONSTRAINT MANAGEMENT ============
+void PhysicsWorld::RemoveObjects(std::span<Object* const> objects) {
+    m_removeScratch.clear();
+    for (Object* object : objects) {
+        std::uint32_t index = m_bodies.IndexOf(object->body);
+        if (index == BodyStore::InvalidIndex || m_bodies.linked[index] != object) continue;
+        m_removeScratch.push_back(object->body);
+    }
+    RemoveBodies(m_removeScratch);
+}
+
+// Objects can be poked from game code at any time, so copy them in before a step...
+void PhysicsWorld::PullLinkedObjects() {
+    if (m_linkedCount == 0) return;
+
+    for (std::size_t i = 0; i < m_bodies.Size(); ++i) {
+        const Object* obj = m_bodies.linked[i];
+        if (!obj) continue;
+
+        // Moved or reshaped from game code while asleep -> wake up
+        if (m_bodies.asleep[i] && (obj->position != m_bodies.positions[i] || obj->oldPosition != m_bodies.oldPositions[i] ||
+                                   obj->collider.type != m_bodies.colliders[i].type ||
+                                   obj->collider.HalfExtents() != m_bodies.colliders[i].HalfExtents())) {
+            QueueWake(static_cast<std::uint32_t>(i));
+        }
+
+        // Static ones moved or reshaped from game code -> the static layer is out of date
+        const std::uint8_t isStatic = obj->isStatic ? 1 : 0;
+        if ((isStatic || m_bodies.isStatic[i]) &&
+            (isStatic != m_bodies.isStatic[i] || obj->position != m_bodies.positions[i] ||
+             obj->collider.type != m_bodies.colliders[i].type || obj->collider.HalfExtents() != m_bodies.colliders[i].HalfExtents())) {
+            m_staticDirty = true;
+        }
+
+        m_bodies.positions[i] = obj->position;
+        m_bodies.oldPositions[i] = obj->oldPosition;
+        m_bodies.masses[i] = obj->mass;
+        m_bodies.bounciness[i] = obj->bounciness;
+        m_bodies.colliders[i] = obj->collider;
+
+        // Coloring ignores static bodies, so it has to be redone if one flips
+        if (m_bodies.isStatic[i] != isStatic) {
+            m_constraints.MarkColorsDirty();
+            m_bodies.isStatic[i] = isStatic;
+            m_bodies.fixed[i] = isStatic | m_bodies.asleep[i];
+            if (m_bodies.asleep[i]) m_sleepingDirty = true;
+            if (isStatic) RemoveAwake(static_cast<std::uint32_t>(i));
+            else if (!m_bodies.asleep[i]) AddAwake(static_cast<std::uint32_t>(i));
+        }
+    }
+    FlushWakes();
+}
 
-Constraint* PhysicsWorld::AddConstraint(std::unique_ptr<Constraint> constraint) {
-    m_constraints.push_back(std::move(constraint)); //cast so that we can move the constraint
-    return m_constraints.back().get();
+// ...and the results back out after
+void PhysicsWorld::PushLinkedObjects() {
+    if (m_linkedCount == 0) return;
+
+    for (std::size_t i = 0; i < m_bodies.Size(); ++i) {
+        Object* obj = m_bodies.linked[i];
+        if (!obj) continue;
+
+        obj->position = m_bodies.positions[i];
+        obj->oldPosition = m_bodies.oldPositions[i];
+        obj->acceleration = m_bodies.accelerations[i];
+    }
+}
+
+// ============ SPATIAL REORDER ============
+
+void PhysicsWorld::SetSpatialReorder(int interval) {
+    m_reorderInterval = std::max(0, interval);
+    m_stepsSinceReorder = 0;
 }
 
-void PhysicsWorld::RemoveConstraint(Constraint* constraint) {
-    m_constraints.erase(
-        std::remove_if(m_constraints.begin(), m_constraints.end(),
-            [constraint](const std::unique_ptr<Constraint>& c) { 
-                return c.get() == constraint; 
-            }),
-        m_constraints.end()
-    );
+// Bits of x spread out to the even positions, y goes in the odd ones
+static std::uint32_t SpreadBits(std::uint32_t v) {
+    v &= 0xFFFFu;
+    v = (v | (v << 8)) & 0x00FF00FFu;
+    v = (v | (v << 4)) & 0x0F0F0F0Fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
 }
 
-DistanceConstraint* PhysicsWorld::AddDistanceConstraint(Object* a, Object* b, float length) {
-    std::unique_ptr<DistanceConstraint> c;
-    if (length < 0) {
-        c = std::make_unique<DistanceConstraint>(a, b);  // Auto-calculate length
-    } else {
-        c = std::make_unique<DistanceConstraint>(a, b, length, 1.0f);  // Explicit length + stiffness
+bool PhysicsWorld::ReorderBodies() {
+    m_stepsSinceReorder = 0;
+    const std::size_t count = m_bodies.Size();
+    if (count < 2) return false;
+
+    // 1. Positions quantized to 16 bits per axis over the bounds of all bodies
+    sf::Vector2f min = m_bodies.positions[0], max = min;
+    for (const sf::Vector2f& p : m_bodies.positions) {
+        min = {std::min(min.x, p.x), std::min(min.y, p.y)};
+        max = {std::max(max.x, p.x), std::max(max.y, p.y)};
+    }
+    const sf::Vector2f scale = {65535.f / std::max(max.x - min.x, 1e-6f), 65535.f / std::max(max.y - min.y, 1e-6f)};
+
+    // 2. Sort by Morton code, ties (and NaNs, clamped to 0) stay in their current order
+    m_reorderKeys.resize(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const sf::Vector2f p = m_bodies.positions[i];
+        const auto qx = static_cast<std::uint32_t>(std::clamp((p.x - min.x) * scale.x, 0.f, 65535.f));
+        const auto qy = static_cast<std::uint32_t>(std::clamp((p.y - min.y) * scale.y, 0.f, 65535.f));
+        const std::uint64_t code = SpreadBits(qx) | (SpreadBits(qy) << 1);
+        m_reorderKeys[i] = code << 32 | i;
+    }
+    std::sort(m_reorderKeys.begin(), m_reorderKeys.end());
+
+    m_reorderOrder.resize(count);
+    bool moved = false;
+    for (std::uint32_t k = 0; k < count; ++k) {
+        m_reorderOrder[k] = static_cast<std::uint32_t>(m_reorderKeys[k]);
+        moved |= m_reorderOrder[k] != k;
+    }
+    if (!moved) return false;
+
+    // 3. Move the bodies; handles (so constraints, Objects, islands) follow on their own
+    m_bodies.Permute(m_reorderOrder);
+    RebuildSleepLists();
+
+    // 4. What still holds dense indices: last Step's contacts, the broadphase, the static layer
+    m_reorderRemap.resize(count);
+    for (std::uint32_t k = 0; k < count; ++k) m_reorderRemap[m_reorderOrder[k]] = k;
+    for (Contact& contact : m_contacts) {
+        contact.bodyA = m_reorderRemap[contact.bodyA];
+        contact.bodyB = m_reorderRemap[contact.bodyB];
     }
-    auto* ptr = c.get();
-    m_constraints.push_back(std::move(c));
-    return ptr;
+    m_pairs.clear();
+    for (std::uint32_t k = 0; k < count; ++k) {
+        if (m_bodies.isStatic[k] && m_reorderOrder[k] != k) m_staticDirty = true;
+    }
+    m_broadphase->Reset();
+    m_queryStale = true;
+    ++m_reorderCount;
+    return true;
+}
+
+// ============ CONSTRAINT MANAGEMENT ============
+
+DistanceConstraint* PhysicsWorld::AddDistanceConstraint(Object* a, Object* b, float length) {
+    DistanceConstraint* c = length < 0
+        ? m_constraints.Add<DistanceConstraint>(a, b)                  // Auto-calculate length
+        : m_constraints.Add<DistanceConstraint>(a, b, length, 1.0f);   // Explicit length + stiffness
+    WakeConstraint(*c);
+    return c;
 }
 
 SpringConstraint* PhysicsWorld::AddSpringConstraint(Object* a, Object* b, float stiffness, float damping) {
     sf::Vector2f diff = b->position - a->position;
     float length = std::sqrt(diff.x * diff.x + diff.y * diff.y);
-    auto c = std::make_unique<SpringConstraint>(a, b, length, stiffness, damping);
-    auto* ptr = c.get();
-    m_constraints.push_back(std::move(c));
-    return ptr;
+    SpringConstraint* c = m_constraints.Add<SpringConstraint>(a, b, length, stiffness, damping);
+    WakeConstraint(*c);
+    return c;
 }
 
 PinConstraint* PhysicsWorld::AddPinConstraint(Object* obj, sf::Vector2f anchor) {
-    auto c = std::make_unique<PinConstraint>(obj, anchor);
-    auto* ptr = c.get();
-    m_constraints.push_back(std::move(c));
-    return ptr;
+    PinConstraint* c = m_constraints.Add<PinConstraint>(obj, anchor);
+    WakeConstraint(*c);
+    return c;
 }
 
-//Uses Gauss-seidel relaxation (i.e. solve each constraint in each iteration)
-void PhysicsWorld::SolveConstraints() {
-    for (int i = 0; i < m_constraintIterations; ++i) {
-        for (auto& constraint : m_constraints) {
-            constraint->Solve();
-        }
+DistanceConstraint* PhysicsWorld::AddDistanceConstraint(BodyHandle a, BodyHandle b, float length) {
+    if (length < 0) {
+        sf::Vector2f diff = GetPosition(b) - GetPosition(a);
+        length = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+    }
+    DistanceConstraint* c = m_constraints.Add<DistanceConstraint>(a, b, length, 1.0f);
+    WakeConstraint(*c);
+    return c;
+}
+
+SpringConstraint* PhysicsWorld::AddSpringConstraint(BodyHandle a, BodyHandle b, float stiffness, float damping) {
+    sf::Vector2f diff = GetPosition(b) - GetPosition(a);
+    float length = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+    SpringConstraint* c = m_constraints.Add<SpringConstraint>(a, b, length, stiffness, damping);
+    WakeConstraint(*c);
+    return c;
+}
+
+PinConstraint* PhysicsWorld::AddPinConstraint(BodyHandle body, sf::Vector2f anchor) {
+    PinConstraint* c = m_constraints.Add<PinConstraint>(body, anchor);
+    WakeConstraint(*c);
+    return c;
+}
+
+ThreadPool& PhysicsWorld::GetThreadPool() {
+    if (!m_threadPool) m_threadPool = std::make_unique<ThreadPool>(m_threadCount);
+    return *m_threadPool;
+}
+
+int PhysicsWorld::SolveConstraints(float dt) {
+    ConstraintSolveSettings settings;
+    settings.iterations = m_constraintIterations;
+    settings.tolerance = m_constraintTolerance;
+    settings.xpbd = m_xpbdEnabled;
+    settings.dt = dt;
+    settings.jacobiRelaxation = m_jacobiRelaxation;
+
+    switch (m_solverMode) {
+        case ConstraintSolverMode::ParallelColored:
+            return m_constraints.SolveColored(m_bodies, settings, GetThreadPool());
+        case ConstraintSolverMode::Jacobi:
+            return m_constraints.SolveJacobi(m_bodies, settings, GetThreadPool());
+        case ConstraintSolverMode::Sequential:
+            break;
     }
+
+    return m_constraints.SolveSequential(m_bodies, settings);
+}
+
+void PhysicsWorld::SetThreadCount(unsigned threads) {
+    m_threadCount = threads;
+    m_threadPool.reset();  // recreated on next use
+}
+
+unsigned PhysicsWorld::GetThreadCount() const {
+    return m_threadPool ? m_threadPool->GetThreadCount() : m_threadCount;
+}
+
+std::size_t PhysicsWorld::GetConstraintColorCount() {
+    return m_constraints.GetColorCount(m_bodies);
 }
 
 //forces -> integration -> constraints -> collisions
 void PhysicsWorld::Step(float dt) {
-    //1. Gravity
-    for (Object* obj : m_objects) {
-        if (obj->isStatic) continue;
-        obj->acceleration = m_gravity;
-    }
+#if PHYSICS_ENABLE_STATS
+    StepStats stats;
+    const auto stepStart = std::chrono::steady_clock::now();
+#endif
+
+    PullLinkedObjects();
 
-    // 2. Verlet integration
-    for (Object* obj : m_objects) {
-        if (obj->isStatic) continue;
+    if (m_reorderInterval > 0 && ++m_stepsSinceReorder >= m_reorderInterval) {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Reorder);
+        ReorderBodies();
+    }
 
-        sf::Vector2f temp = obj->position;
-        
-        // Verlet: newPos = pos + (pos - oldPos) + accel * dt^2
-        sf::Vector2f velocity = obj->position - obj->oldPosition;
-        obj->position = obj->position + velocity + obj->acceleration * dt * dt;
-        obj->oldPosition = temp;
+    // 1 + 2. Gravity and Verlet integration, fused (SIMD where available)
+    {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Integrate);
+        IntegrateVerlet(m_bodies.positions.data(), m_bodies.oldPositions.data(), m_bodies.accelerations.data(),
+                        m_bodies.fixed.data(), m_bodies.Size(), m_gravity, dt);
+        PHYSICS_STAT(stats.bodiesSkipped = static_cast<std::uint32_t>(m_bodies.Size() - m_awake.size()));
     }
 
     // 3. Solve constraints (iteratively for stability)
-    SolveConstraints();
+    {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Constraints);
+        m_lastConstraintIterations = SolveConstraints(dt);
+        PHYSICS_STAT(stats.constraintIterations = static_cast<std::uint32_t>(m_lastConstraintIterations));
+        PHYSICS_STAT(stats.constraintsSolved = static_cast<std::uint32_t>(m_constraints.Size() * m_lastConstraintIterations));
+    }
+
+    // 4. Collision detection (broadphase only hands out candidates)
+    {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Broadphase);
+        UpdateProxies();
+        if (m_ccdEnabled) SweepProxies();
+        UpdateStaticLayer();
+        UpdateSleepingLayer();
+        m_broadphase->FindPairs(m_proxies, m_pairs);
+        FindStaticPairs();
+    }
+    {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Narrowphase);
+        DetectContacts();
+        SweepFastBodies();
+        PHYSICS_STAT(stats.bodiesSwept = static_cast<std::uint32_t>(m_sweptCount));
+        WakeTouchedIslands();
+    }
+
+    // 5. Resolution, serial and in pair order
+    {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Resolve);
+        ResolveContacts();
+    }
+
+    // 6. Put settled islands to sleep
+    if (m_sleepEnabled) {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Sleep);
+        UpdateSleep(dt);
+    }
+
+    PushLinkedObjects();
+    MeasureQueryMargin();   // queries keep using what FindPairs built
+
+    if (m_recorder) {
+        PHYSICS_TIME_PHASE(stats, StepPhase::Record);
+        m_recorder->Record(m_bodies, dt);
+    }
+
+#if PHYSICS_ENABLE_STATS
+    stats.pairsTested = static_cast<std::uint32_t>(m_pairs.size());
+    stats.contactsFound = static_cast<std::uint32_t>(m_contacts.size());
+    stats.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stepStart).count();
+    m_stats.Record(stats);
+#endif
+}
+
+// ============ QUERIES ============
+
+void PhysicsWorld::PrepareQuery() {
+    if (!m_queryStale) return;
+    UpdateProxies();
+    UpdateStaticLayer();
+    UpdateSleepingLayer();
+    m_broadphase->Build(m_proxies);
+    m_queryMargin = 0.f;
+    m_queryStale = false;
+}
+
+// After FindPairs only contacts and sweeps move bodies, so their drift out of the
+// proxies FindPairs used is all a query has to grow by to keep using that structure
+void PhysicsWorld::MeasureQueryMargin() {
+    float margin = 0.f;
+    auto measure = [&](std::uint32_t index) {
+        const sf::Vector2f half = m_bodies.colliders[index].HalfExtents();
+        const sf::Vector2f p = m_bodies.positions[index];
+        const BroadphaseProxy& proxy = m_proxies[index];
+        margin = std::max({margin, proxy.min.x - (p.x - half.x), proxy.min.y - (p.y - half.y),
+                           (p.x + half.x) - proxy.max.x, (p.y + half.y) - proxy.max.y});
+    };
+    for (const Contact& contact : m_contacts) {
+        measure(contact.bodyA);
+        measure(contact.bodyB);
+    }
+    for (std::uint32_t i : m_fastBodies) measure(i);
+    m_queryMargin = margin;
+    m_queryStale = false;
+}
 
-    // 4. Collision detection and resolution
-    for (size_t i = 0; i < m_objects.size(); ++i) {
-        for (size_t j = i + 1; j < m_objects.size(); ++j) {
-            Object* objA = m_objects[i];
-            Object* objB = m_objects[j];
+// Body order, each once. A sleep or wake since the broadphase was built only marks the
+// sleeping layer dirty, so until the next rebuild a body can be in both.
+void PhysicsWorld::SortQueryHits() {
+    std::sort(m_queryIndices.begin(), m_queryIndices.end());
+    m_queryIndices.erase(std::unique(m_queryIndices.begin(), m_queryIndices.end()), m_queryIndices.end());
+}
+
+// Broadphase candidates in [min, max], narrowed down by keep(index), sorted into body order
+template <typename Filter>
+std::size_t PhysicsWorld::RunQuery(sf::Vector2f min, sf::Vector2f max, std::vector<BodyHandle>& out, Filter&& keep) {
+    PrepareQuery();
+    m_queryIndices.clear();
+    const sf::Vector2f margin = {m_queryMargin, m_queryMargin};
+    m_broadphase->Query(m_proxies, min - margin, max + margin, m_queryIndices);
+    m_sleepingLayer.Query(min - margin, max + margin, m_queryIndices);
+    m_staticLayer.Query(min, max, m_queryIndices);
+    SortQueryHits();
+
+    out.clear();
+    for (std::uint32_t index : m_queryIndices) {
+        if (keep(index)) out.push_back(m_bodies.HandleAt(index));
+    }
+    return out.size();
+}
+
+// Closest point of the body's shape to p (p itself if inside)
+static sf::Vector2f ClosestPoint(const BodyStore& bodies, std::uint32_t index, sf::Vector2f p) {
+    const Collider& collider = bodies.colliders[index];
+    const sf::Vector2f center = bodies.positions[index];
+
+    if (collider.type == ColliderType::Circle) {
+        const sf::Vector2f diff = p - center;
+        const float distSq = diff.x * diff.x + diff.y * diff.y;
+        const float radius = collider.circle.radius;
+        if (distSq <= radius * radius) return p;
+        return center + diff * (radius / std::sqrt(distSq));
+    }
 
-            if (objA->isStatic && objB->isStatic) continue;
-            if (!objA->collider || !objB->collider) continue;
+    const sf::Vector2f half = collider.aabb.halfExtents;
+    return {std::clamp(p.x, center.x - half.x, center.x + half.x),
+            std::clamp(p.y, center.y - half.y, center.y + half.y)};
+}
+
+// The filters test the shape where it is now: a proxy can be from before the last
+// Step's resolve, so even a box doesn't match its proxy anymore
+std::size_t PhysicsWorld::QueryPoint(sf::Vector2f point, std::vector<BodyHandle>& out) {
+    return RunQuery(point, point, out, [&](std::uint32_t index) {
+        const Collider& collider = m_bodies.colliders[index];
+        const sf::Vector2f diff = point - m_bodies.positions[index];
+        if (collider.type != ColliderType::Circle) {
+            const sf::Vector2f half = collider.aabb.halfExtents;
+            return std::abs(diff.x) <= half.x && std::abs(diff.y) <= half.y;
+        }
+        return diff.x * diff.x + diff.y * diff.y <= collider.circle.radius * collider.circle.radius;
+    });
+}
 
-            ResolveCollision(objA, objB);
+std::size_t PhysicsWorld::QueryAABB(sf::Vector2f min, sf::Vector2f max, std::vector<BodyHandle>& out) {
+    return RunQuery(min, max, out, [&](std::uint32_t index) {
+        const Collider& collider = m_bodies.colliders[index];
+        const sf::Vector2f c = m_bodies.positions[index];
+        if (collider.type != ColliderType::Circle) {
+            const sf::Vector2f half = collider.aabb.halfExtents;
+            return c.x - half.x <= max.x && min.x <= c.x + half.x && c.y - half.y <= max.y && min.y <= c.y + half.y;
         }
+        // Closest point of the query box to the circle center
+        const sf::Vector2f nearest = {std::clamp(c.x, min.x, max.x), std::clamp(c.y, min.y, max.y)};
+        const sf::Vector2f diff = c - nearest;
+        const float radius = collider.circle.radius;
+        return diff.x * diff.x + diff.y * diff.y <= radius * radius;
+    });
+}
+
+std::size_t PhysicsWorld::QueryRadius(sf::Vector2f center, float radius, std::vector<BodyHandle>& out) {
+    const sf::Vector2f extent = {radius, radius};
+    return RunQuery(center - extent, center + extent, out, [&](std::uint32_t index) {
+        const sf::Vector2f diff = ClosestPoint(m_bodies, index, center) - center;
+        return diff.x * diff.x + diff.y * diff.y <= radius * radius;
+    });
+}
+
+// Ray (unit direction) against one shape. t = distance to the entry point.
+static bool RayShape(const BodyStore& bodies, std::uint32_t index, sf::Vector2f origin, sf::Vector2f dir,
+                     float& t, sf::Vector2f& normal) {
+    const Collider& collider = bodies.colliders[index];
+    const sf::Vector2f center = bodies.positions[index];
+
+    if (collider.type == ColliderType::Circle) {
+        const float radius = collider.circle.radius;
+        const sf::Vector2f m = origin - center;
+        const float c = m.x * m.x + m.y * m.y - radius * radius;
+        if (c <= 0.f) {   // starts inside
+            t = 0.f;
+            normal = -dir;
+            return true;
+        }
+        const float b = m.x * dir.x + m.y * dir.y;
+        if (b > 0.f) return false;   // outside and pointing away
+        const float disc = b * b - c;
+        if (disc < 0.f) return false;
+        t = -b - std::sqrt(disc);
+        normal = (origin + dir * t - center) / radius;
+        return true;
+    }
+
+    // Slab test
+    const sf::Vector2f half = collider.aabb.halfExtents;
+    const float mins[2] = {center.x - half.x, center.y - half.y};
+    const float maxs[2] = {center.x + half.x, center.y + half.y};
+    const float o[2] = {origin.x, origin.y};
+    const float d[2] = {dir.x, dir.y};
+
+    float tNear = 0.f;
+    float tFar = std::numeric_limits<float>::max();
+    int axis = -1;
+    float sign = 0.f;
+    for (int k = 0; k < 2; ++k) {
+        if (std::abs(d[k]) < 1e-8f) {
+            if (o[k] < mins[k] || o[k] > maxs[k]) return false;
+            continue;
+        }
+        float t0 = (mins[k] - o[k]) / d[k];
+        float t1 = (maxs[k] - o[k]) / d[k];
+        float entrySign = -1.f;          // entering through the min face
+        if (t0 > t1) {
+            std::swap(t0, t1);
+            entrySign = 1.f;
+        }
+        if (t0 > tNear) {
+            tNear = t0;
+            axis = k;
+            sign = entrySign;
+        }
+        tFar = std::min(tFar, t1);
+        if (tNear > tFar) return false;
     }
+
+    t = tNear;
+    if (axis < 0) normal = -dir;                     // starts inside
+    else normal = axis == 0 ? sf::Vector2f{sign, 0.f} : sf::Vector2f{0.f, sign};
+    return true;
 }
 
-//helper function for which collision resolution function to call
-void PhysicsWorld::ResolveCollision(Object* objA, Object* objB) {
-    ColliderType typeA = objA->collider->type;
-    ColliderType typeB = objB->collider->type;
+// Only the segment's bounding box goes through the broadphase, so long diagonal
+// rays end up testing more candidates - still far less than every body.
+bool PhysicsWorld::Raycast(sf::Vector2f origin, sf::Vector2f direction, float maxDistance, RaycastHit& hit) {
+    const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    if (length <= 0.f || maxDistance < 0.f) return false;
+    const sf::Vector2f dir = direction / length;
+    const sf::Vector2f end = origin + dir * maxDistance;
+
+    PrepareQuery();
+    m_queryIndices.clear();
+    const sf::Vector2f min = {std::min(origin.x, end.x), std::min(origin.y, end.y)};
+    const sf::Vector2f max = {std::max(origin.x, end.x), std::max(origin.y, end.y)};
+    const sf::Vector2f margin = {m_queryMargin, m_queryMargin};
+    m_broadphase->Query(m_proxies, min - margin, max + margin, m_queryIndices);
+    m_sleepingLayer.Query(min - margin, max + margin, m_queryIndices);
+    m_staticLayer.Query(min, max, m_queryIndices);
+    SortQueryHits();   // ties go to the lower index, every run
+
+    bool found = false;
+    for (std::uint32_t index : m_queryIndices) {
+        float t;
+        sf::Vector2f normal;
+        if (!RayShape(m_bodies, index, origin, dir, t, normal) || t > maxDistance) continue;
+        if (found && t >= hit.distance) continue;
 
-    if (typeA == ColliderType::Circle && typeB == ColliderType::Circle) {
-        ResolveCircleCircle(objA, objB);
-    } 
-    else if (typeA == ColliderType::Circle && typeB == ColliderType::AABB) {
-        ResolveCircleAABB(objA, objB);
-    } 
-    else if (typeA == ColliderType::AABB && typeB == ColliderType::Circle) {
-        ResolveCircleAABB(objB, objA);  // Swap order so circle is first
+        found = true;
+        hit.body = m_bodies.HandleAt(index);
+        hit.distance = t;
+        hit.point = origin + dir * t;
+        hit.normal = normal;
     }
-    else if (typeA == ColliderType::AABB && typeB == ColliderType::AABB) {
-        ResolveAABBAABB(objA, objB);
+    return found;
+}
+
+// ============ FIXED TIMESTEP ============
+
+void PhysicsWorld::SetFixedTimestep(float step, int maxSteps) {
+    m_fixedStep = step;
+    m_maxSteps = std::max(1, maxSteps);
+    m_accumulator = 0.f;
+    m_adaptiveSubsteps = false;
+}
+
+void PhysicsWorld::SetAdaptiveSubsteps(int minSubsteps, int maxSubsteps, float frame) {
+    m_minSubsteps = std::max(1, minSubsteps);
+    m_maxSubsteps = std::max(m_minSubsteps, maxSubsteps);
+    m_substepFrame = frame > 0.f ? frame : m_substepFrame;
+    m_adaptiveSubsteps = true;
+    m_substepTimer = 0.f;
+    SetSubsteps(std::clamp(m_substeps, m_minSubsteps, m_maxSubsteps));
+}
+
+void PhysicsWorld::SetSubstepTargets(float motion, float penetration) {
+    m_substepMotion = std::max(1e-4f, motion);
+    m_substepPenetration = std::max(1e-4f, penetration);
+}
+
+// New step length, keeping every body's velocity: Verlet stores it as
+// position - oldPosition per step, so that gets scaled to the new step
+void PhysicsWorld::SetSubsteps(int substeps) {
+    const float step = m_substepFrame / static_cast<float>(substeps);
+    const float ratio = step / m_fixedStep;
+    m_substeps = substeps;
+    if (ratio == 1.f) return;
+
+    for (std::uint32_t i : m_awake) {
+        const sf::Vector2f position = m_bodies.positions[i];
+        m_bodies.oldPositions[i] = position - (position - m_bodies.oldPositions[i]) * ratio;
+        if (Object* obj = m_bodies.linked[i]) obj->oldPosition = m_bodies.oldPositions[i];
     }
+    m_fixedStep = step;
 }
 
-void PhysicsWorld::ResolveCircleCircle(Object* objA, Object* objB) {
-    auto* circleA = objA->GetCircleCollider();
-    auto* circleB = objB->GetCircleCollider();
-    if (!circleA || !circleB) return;
+// Substeps the coming frame needs, from how fast things move now and how deep the
+// last Step's contacts went. Both scale with the step, so n * measured / target.
+void PhysicsWorld::ChooseSubsteps() {
+    float minSize = std::numeric_limits<float>::max();
+    float maxMotion = 0.f;
+    for (std::uint32_t i = 0; i < m_bodies.Size(); ++i) {
+        if (m_bodies.colliders[i]) {
+            const sf::Vector2f half = m_bodies.colliders[i].HalfExtents();
+            const float size = 2.f * std::min(half.x, half.y);
+            if (size > 0.f) minSize = std::min(minSize, size);
+        }
+        if (m_bodies.IsFixed(i)) continue;
+        if (m_ccdEnabled && m_bodies.colliders[i].type == ColliderType::Circle) continue;   // swept instead
+        const sf::Vector2f motion = m_bodies.positions[i] - m_bodies.oldPositions[i];
+        maxMotion = std::max(maxMotion, motion.x * motion.x + motion.y * motion.y);
+    }
+
+    float deepest = 0.f;
+    for (const Contact& contact : m_contacts) deepest = std::max(deepest, contact.penetration);
 
-    sf::Vector2f diff = objB->position - objA->position;
-    float distSq = diff.x * diff.x + diff.y * diff.y;
-    float radiusSum = circleA->radius + circleB->radius;
+    int target = m_minSubsteps;
+    if (minSize < std::numeric_limits<float>::max()) {
+        const float n = static_cast<float>(m_substeps);
+        const float forMotion = std::sqrt(maxMotion) * n / (m_substepMotion * minSize);
+        const float forPenetration = deepest * n / (m_substepPenetration * minSize);
+        const float needed = std::ceil(std::max(forMotion, forPenetration));
+        target = static_cast<int>(std::clamp(needed, static_cast<float>(m_minSubsteps), static_cast<float>(m_maxSubsteps)));
+    }
 
-    if (distSq < radiusSum * radiusSum) {
-        float distance = std::sqrt(distSq);
-        sf::Vector2f normal; //normal vector from center A to B
-        float penetration;
-        
-        if (distance < 0.0001f) {
-            normal = {1.f, 0.f};
-            penetration = radiusSum;
-        } else {
-            normal = diff / distance;
-            penetration = radiusSum - distance;
+    // Up right away (that's when tunneling happens), down gently so it doesn't flicker
+    if (target < m_substeps) target = m_substeps - 1;
+    if (target != m_substeps) SetSubsteps(target);
+}
+
+int PhysicsWorld::Update(float frameDt) {
+    if (m_adaptiveSubsteps) {
+        m_substepTimer -= frameDt;
+        if (m_substepTimer <= 0.f) {
+            ChooseSubsteps();
+            m_substepTimer = m_substepFrame;
         }
+    }
+    m_accumulator += frameDt;
+
+    // Adaptive: room to catch up one frame, no more
+    const int maxSteps = m_adaptiveSubsteps ? 2 * m_substeps : m_maxSteps;
+    int steps = 0;
+    while (m_accumulator >= m_fixedStep && steps < maxSteps) {
+        m_bodies.previousPositions = m_bodies.positions;   // same size -> no allocation
+        Step(m_fixedStep);
+        m_accumulator -= m_fixedStep;
+        ++steps;
+    }
 
-        // Store velocities BEFORE any changes
-        sf::Vector2f velA = objA->position - objA->oldPosition;
-        sf::Vector2f velB = objB->position - objB->oldPosition;
+    // Still behind after maxSteps: drop the backlog instead of trying to catch up
+    if (m_accumulator >= m_fixedStep) m_accumulator = std::fmod(m_accumulator, m_fixedStep);
+    return steps;
+}
+
+sf::Vector2f PhysicsWorld::GetInterpolatedPosition(BodyHandle body) const {
+    std::uint32_t index = m_bodies.IndexOf(body);
+    if (index == BodyStore::InvalidIndex) return {};
+
+    const float alpha = GetInterpolationAlpha();
+    const sf::Vector2f previous = m_bodies.previousPositions[index];
+    return previous + (m_bodies.positions[index] - previous) * alpha;
+}
+
+// World space bounds of each collider, one proxy per body
+void PhysicsWorld::UpdateProxies() {
+    const std::size_t count = m_bodies.Size();
+    m_proxies.resize(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Collider& collider = m_bodies.colliders[i];
+        const sf::Vector2f halfExtents = collider.HalfExtents();
+        BroadphaseProxy& proxy = m_proxies[i];
+        proxy.min = m_bodies.positions[i] - halfExtents;
+        proxy.max = m_bodies.positions[i] + halfExtents;
+        proxy.isStatic = m_bodies.IsFixed(static_cast<std::uint32_t>(i));
+        proxy.enabled = static_cast<bool>(collider) && !proxy.isStatic;   // the rest are in the static/sleeping layers
+    }
+}
 
-        // Positional correction - move BOTH to preserve velocity
-        sf::Vector2f correction = normal * (penetration * 0.5f);
-        if (!objA->isStatic) {
-            objA->position -= correction;
-            objA->oldPosition -= correction;
+// Needs this step's proxies; the broadphase skips static bodies, so their bounds are only read here
+void PhysicsWorld::UpdateStaticLayer() {
+    if (!m_staticDirty) return;
+
+    m_staticIndices.clear();
+    for (std::uint32_t i = 0; i < m_bodies.Size(); ++i) {
+        if (m_bodies.isStatic[i] && m_bodies.colliders[i]) m_staticIndices.push_back(i);
+    }
+    m_staticLayer.Build(m_proxies, m_staticIndices);
+    m_staticDirty = false;
+    ++m_staticRebuilds;
+}
+
+// Built from this step's proxies, like the static layer
+void PhysicsWorld::UpdateSleepingLayer() {
+    if (!m_sleepingDirty) return;
+
+    m_staticIndices.clear();
+    if (m_sleepingCount > 0) {
+        for (std::uint32_t i = 0; i < m_bodies.Size(); ++i) {
+            if (m_bodies.asleep[i] && !m_bodies.isStatic[i] && m_bodies.colliders[i]) m_staticIndices.push_back(i);
         }
-        if (!objB->isStatic) {
-            objB->position += correction;
-            objB->oldPosition += correction;
+    }
+    m_sleepingLayer.Build(m_proxies, m_staticIndices);
+    m_sleepingDirty = false;
+    ++m_sleepingRebuilds;
+}
+
+// Awake dynamic bodies against the static and sleeping layers, merged into the broadphase's
+// pairs so the list stays sorted - the same pairs in the same order as one broadphase over
+// everything. Sleeping and static bodies never pair with each other.
+void PhysicsWorld::FindStaticPairs() {
+    if (m_staticLayer.Size() == 0 && m_sleepingLayer.Size() == 0) return;
+
+    m_staticPairs.clear();
+    for (std::uint32_t i : m_awake) {
+        const BroadphaseProxy& proxy = m_proxies[i];
+        if (!proxy.enabled) continue;
+
+        m_staticIndices.clear();
+        m_staticLayer.Query(proxy.min, proxy.max, m_staticIndices);
+        m_sleepingLayer.Query(proxy.min, proxy.max, m_staticIndices);
+        for (std::uint32_t other : m_staticIndices) {
+            m_staticPairs.push_back({std::min(i, other), std::max(i, other)});
         }
+    }
+    if (m_staticPairs.empty()) return;
+
+    std::sort(m_staticPairs.begin(), m_staticPairs.end());
+    m_mergedPairs.resize(m_pairs.size() + m_staticPairs.size());
+    std::merge(m_pairs.begin(), m_pairs.end(), m_staticPairs.begin(), m_staticPairs.end(), m_mergedPairs.begin());
+    m_pairs.swap(m_mergedPairs);
+}
+
+// Pairs sorted into shape pair batches first, so each run of pairs goes through one
+// kernel. Every chunk fills its own buffer, then they're appended in chunk order.
+// Chunks are contiguous ranges of the sorted pairs, so that's the same order as a serial pass.
+void PhysicsWorld::DetectContacts() {
+    m_contacts.clear();
+    SortPairsByShape(m_bodies, m_pairs, m_pairBatches);
 
-        // Elastic collision response
-        float bounceStrength = 0.5f;
-        sf::Vector2f relVel = velA - velB;
-        float relVelAlongNormal = relVel.x * normal.x + relVel.y * normal.y;
-        
-        // Only apply bounce if objects are approaching
-        if (relVelAlongNormal > 0) {
-            sf::Vector2f impulse = normal * (relVelAlongNormal * (1.f + bounceStrength) * 0.5f);
-            
-            // Adjust oldPosition to change velocity (not position)
-            if (!objA->isStatic) objA->oldPosition += impulse;
-            if (!objB->isStatic) objB->oldPosition -= impulse;
+    // Batches overlapping [begin, end) of the sorted pairs
+    auto detectRange = [this](std::size_t begin, std::size_t end, std::vector<Contact>& out) {
+        for (std::size_t batch = 0; batch < ShapePairCount; ++batch) {
+            const std::size_t first = m_pairBatches.start[batch];
+            const std::size_t from = std::max(begin, first);
+            const std::size_t to = std::min(end, m_pairBatches.start[batch + 1]);
+            if (from >= to) continue;
+            DetectBatch(batch, m_bodies, m_pairBatches.views[batch].subspan(from - first, to - from), out);
         }
+    };
+
+    const std::size_t count = m_pairBatches.Size();
+    if (!m_parallelNarrowphase || count < MinParallelPairs || GetThreadPool().GetThreadCount() == 1) {
+        detectRange(0, count, m_contacts);
+        return;
+    }
+
+    ThreadPool& pool = GetThreadPool();
+    m_threadContacts.resize(pool.GetThreadCount());
+    for (auto& buffer : m_threadContacts) buffer.clear();   // empty chunks don't get called
+
+    pool.ParallelForChunks(count, [this, &detectRange](unsigned chunk, std::size_t begin, std::size_t end) {
+        detectRange(begin, end, m_threadContacts[chunk]);
+    });
+
+    std::size_t total = 0;
+    for (const auto& buffer : m_threadContacts) total += buffer.size();
+    m_contacts.reserve(total);
+    for (const auto& buffer : m_threadContacts) {
+        m_contacts.insert(m_contacts.end(), buffer.begin(), buffer.end());
     }
 }
 
-void PhysicsWorld::ResolveCircleAABB(Object* circle, Object* box) {
-    auto* circleCollider = circle->GetCircleCollider();
-    auto* boxCollider = box->GetAABBCollider();
-    if (!circleCollider || !boxCollider) return;
+// ============ CONTINUOUS COLLISION ============
+
+void PhysicsWorld::SetContinuousCollision(bool enabled, float threshold) {
+    m_ccdEnabled = enabled;
+    m_ccdThreshold = std::max(0.f, threshold);
+    if (!enabled) {
+        m_fastBodies.clear();
+        m_sweptCount = 0;
+    }
+}
 
-    sf::Vector2f boxMin = box->position - boxCollider->halfExtents;
-    sf::Vector2f boxMax = box->position + boxCollider->halfExtents;
+// Fast circles: proxy covers the whole step's travel, so the broadphase hands out
+// everything they could have passed through
+void PhysicsWorld::SweepProxies() {
+    const std::size_t count = m_bodies.Size();
+    m_sweepState.assign(count, 0);
+    m_sweepHits.resize(count);
+    m_fastBodies.clear();
 
-    sf::Vector2f closestPoint;
-    closestPoint.x = std::clamp(circle->position.x, boxMin.x, boxMax.x);
-    closestPoint.y = std::clamp(circle->position.y, boxMin.y, boxMax.y);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const Collider& collider = m_bodies.colliders[i];
+        if (collider.type != ColliderType::Circle || m_bodies.IsFixed(i)) continue;
 
-    sf::Vector2f diff = circle->position - closestPoint;
-    float distSq = diff.x * diff.x + diff.y * diff.y;
-    float radius = circleCollider->radius;
+        const sf::Vector2f from = m_bodies.oldPositions[i];
+        const sf::Vector2f motion = m_bodies.positions[i] - from;
+        const float limit = m_ccdThreshold * collider.circle.radius;
+        if (motion.x * motion.x + motion.y * motion.y <= limit * limit) continue;
 
-    if (distSq < radius * radius) {
-        float distance = std::sqrt(distSq);
-        sf::Vector2f normal;
-        float penetration;
-        
-        if (distance < 0.0001f) {
-            float overlapX = boxCollider->halfExtents.x - std::abs(circle->position.x - box->position.x);
-            float overlapY = boxCollider->halfExtents.y - std::abs(circle->position.y - box->position.y);
-            
-            if (overlapX < overlapY) {
-                normal = {(circle->position.x < box->position.x) ? -1.f : 1.f, 0.f};
-                penetration = overlapX + radius;
-            } else {
-                normal = {0.f, (circle->position.y < box->position.y) ? -1.f : 1.f};
-                penetration = overlapY + radius;
+        const sf::Vector2f half = collider.HalfExtents();
+        BroadphaseProxy& proxy = m_proxies[i];
+        proxy.min = {std::min(proxy.min.x, from.x - half.x), std::min(proxy.min.y, from.y - half.y)};
+        proxy.max = {std::max(proxy.max.x, from.x + half.x), std::max(proxy.max.y, from.y + half.y)};
+        m_sweepState[i] = SweepFast;
+        m_fastBodies.push_back(i);
+    }
+}
+
+// Serial, after DetectContacts: earliest hit per fast circle over its pairs. A hit body
+// goes back to the touch point (same velocity), its contacts from the end of the step
+// are thrown out and re-detected there, plus the touching contact so it bounces.
+void PhysicsWorld::SweepFastBodies() {
+    m_sweptCount = 0;
+    if (m_fastBodies.empty()) return;
+
+    for (std::uint32_t i : m_fastBodies) m_sweepHits[i].time = 2.f;
+
+    SweepHit hit;
+    for (const BodyPair& pair : m_pairs) {
+        if (!m_sweepState[pair.a] && !m_sweepState[pair.b]) continue;
+        if (!SweepContact(m_bodies, pair.a, pair.b, hit.time, hit.contact)) continue;
+        if (m_sweepState[pair.a] && hit.time < m_sweepHits[pair.a].time) m_sweepHits[pair.a] = hit;
+        if (m_sweepState[pair.b] && hit.time < m_sweepHits[pair.b].time) m_sweepHits[pair.b] = hit;
+    }
+
+    for (std::uint32_t i : m_fastBodies) {
+        const float time = m_sweepHits[i].time;
+        if (time > 1.f) continue;
+
+        const sf::Vector2f motion = m_bodies.positions[i] - m_bodies.oldPositions[i];
+        m_bodies.positions[i] = m_bodies.oldPositions[i] + motion * time;
+        m_bodies.oldPositions[i] = m_bodies.positions[i] - motion;
+        m_sweepState[i] = SweepRewound;
+        ++m_sweptCount;
+    }
+    if (m_sweptCount == 0) return;
+
+    auto rewound = [this](std::uint32_t index) { return m_sweepState[index] == SweepRewound; };
+    std::erase_if(m_contacts, [&](const Contact& c) { return rewound(c.bodyA) || rewound(c.bodyB); });
+
+    Contact contact;
+    for (const BodyPair& pair : m_pairs) {
+        if (!rewound(pair.a) && !rewound(pair.b)) continue;
+        if (DetectContact(m_bodies, pair.a, pair.b, contact)) {
+            m_contacts.push_back(contact);
+            continue;
+        }
+        // Just touching (the usual case right at the time of impact): the swept contact,
+        // once per pair even when both ends got stopped by each other
+        for (std::uint32_t body : {pair.a, pair.b}) {
+            const Contact& swept = m_sweepHits[body].contact;
+            const bool samePair = (swept.bodyA == pair.a && swept.bodyB == pair.b) || (swept.bodyA == pair.b && swept.bodyB == pair.a);
+            if (rewound(body) && samePair) {
+                m_contacts.push_back(swept);
+                break;
             }
-        } else {
-            normal = diff / distance;
-            penetration = radius - distance;
         }
+    }
+}
 
-        // Store velocity BEFORE any changes
-        sf::Vector2f vel = circle->position - circle->oldPosition;
-        float velAlongNormal = vel.x * normal.x + vel.y * normal.y;
-
-        // Positional correction - move BOTH to preserve velocity
-        sf::Vector2f correction = normal * penetration;
-        if (!circle->isStatic) {
-            circle->position += correction;
-            circle->oldPosition += correction;
+// Runs of one ContactType go through that batch's kernel. DetectContacts leaves one
+// run per type; CCD can append a few more at the end.
+void PhysicsWorld::ResolveContacts() {
+    auto resolveRuns = [this](bool bounce, bool refresh) {
+        const std::span<const Contact> contacts(m_contacts);
+        for (std::size_t begin = 0; begin < contacts.size();) {
+            std::size_t end = begin + 1;
+            while (end < contacts.size() && contacts[end].type == contacts[begin].type) ++end;
+            ResolveBatch(static_cast<std::size_t>(contacts[begin].type), m_bodies, contacts.subspan(begin, end - begin), bounce, refresh);
+            begin = end;
         }
-        if (!box->isStatic) {
-            box->position -= correction;
-            box->oldPosition -= correction;
+    };
+
+    resolveRuns(true, false);
+
+    // Later passes only fix up overlap - bouncing again would add energy.
+    // They re-measure copies so GetContacts() still shows what was detected.
+    for (int i = 1; i < m_contactIterations; ++i) resolveRuns(false, true);
+}
+
+// ============ SLEEPING ============
+
+void PhysicsWorld::SetSleepEnabled(bool enabled) {
+    m_sleepEnabled = enabled;
+    if (!enabled) WakeAll();
+}
+
+bool PhysicsWorld::IsAsleep(BodyHandle body) const {
+    std::uint32_t index = m_bodies.IndexOf(body);
+    return index != BodyStore::InvalidIndex && m_bodies.asleep[index];
+}
+
+void PhysicsWorld::WakeBody(BodyHandle body) {
+    std::uint32_t index = m_bodies.IndexOf(body);
+    if (index == BodyStore::InvalidIndex) return;
+    QueueWake(index);
+    FlushWakes();
+}
+
+void PhysicsWorld::AddAwake(std::uint32_t index) {
+    if (m_awakeSlot[index] != NotAwake) return;
+    m_awakeSlot[index] = static_cast<std::uint32_t>(m_awake.size());
+    m_awake.push_back(index);
+}
+
+// Swap-and-pop, the list has no order to keep
+void PhysicsWorld::RemoveAwake(std::uint32_t index) {
+    const std::uint32_t slot = m_awakeSlot[index];
+    if (slot == NotAwake) return;
+    const std::uint32_t moved = m_awake.back();
+    m_awake[slot] = moved;
+    m_awakeSlot[moved] = slot;
+    m_awake.pop_back();
+    m_awakeSlot[index] = NotAwake;
+}
+
+// Member lists are by handle id, so swap-and-pop and reordering don't touch them
+void PhysicsWorld::LinkIsland(std::uint32_t index, std::uint32_t island) {
+    const std::uint32_t id = m_bodies.HandleAt(index).id;
+    m_bodies.islands[index] = island;
+    m_islandPrev[id] = BodyStore::NoIsland;
+    m_islandNext[id] = m_islandHead[island];
+    if (m_islandHead[island] != BodyStore::NoIsland) m_islandPrev[m_islandHead[island]] = id;
+    m_islandHead[island] = id;
+}
+
+void PhysicsWorld::UnlinkIsland(std::uint32_t index) {
+    const std::uint32_t id = m_bodies.HandleAt(index).id;
+    const std::uint32_t island = m_bodies.islands[index];
+    if (island == BodyStore::NoIsland) return;
+    if (m_islandPrev[id] != BodyStore::NoIsland) m_islandNext[m_islandPrev[id]] = m_islandNext[id];
+    else m_islandHead[island] = m_islandNext[id];
+    if (m_islandNext[id] != BodyStore::NoIsland) m_islandPrev[m_islandNext[id]] = m_islandPrev[id];
+    m_islandNext[id] = m_islandPrev[id] = BodyStore::NoIsland;
+    m_bodies.islands[index] = BodyStore::NoIsland;
+}
+
+void PhysicsWorld::RebuildSleepLists() {
+    const std::uint32_t count = static_cast<std::uint32_t>(m_bodies.Size());
+    m_sleepingDirty = true;
+    m_awake.clear();
+    m_awakeSlot.assign(count, NotAwake);
+    m_islandHead.assign(m_bodies.IdCount(), BodyStore::NoIsland);
+    m_islandNext.assign(m_bodies.IdCount(), BodyStore::NoIsland);
+    m_islandPrev.assign(m_bodies.IdCount(), BodyStore::NoIsland);
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        m_bodies.fixed[i] = m_bodies.isStatic[i] | m_bodies.asleep[i];
+        if (m_bodies.asleep[i]) {
+            // a loaded id out of range becomes an island of its own
+            const std::uint32_t island = m_bodies.islands[i];
+            LinkIsland(i, island < m_bodies.IdCount() ? island : m_bodies.HandleAt(i).id);
+        } else if (!m_bodies.fixed[i]) {
+            AddAwake(i);
         }
+    }
+}
+
+void PhysicsWorld::QueueWake(std::uint32_t index) {
+    m_bodies.restSteps[index] = 0;
+    if (m_bodies.asleep[index]) m_wakeIslands.push_back(m_bodies.islands[index]);
+}
+
+// Walks only the queued islands' members; an island queued twice is empty the second time
+void PhysicsWorld::FlushWakes() {
+    for (std::uint32_t island : m_wakeIslands) {
+        if (island >= m_islandHead.size()) continue;
+        std::uint32_t id = m_islandHead[island];
+        if (id != BodyStore::NoIsland) m_sleepingDirty = true;
+        while (id != BodyStore::NoIsland) {
+            const std::uint32_t next = m_islandNext[id];
+            const std::uint32_t i = m_bodies.IndexOfId(id);
+            m_islandNext[id] = m_islandPrev[id] = BodyStore::NoIsland;
 
-        // Apply bounce if moving toward the surface
-        if (!circle->isStatic && velAlongNormal < 0) {
-            sf::Vector2f tangent = {-normal.y, normal.x};
-            float velAlongTangent = vel.x * tangent.x + vel.y * tangent.y;
-            
-            // Reflect: reverse normal component, apply friction to tangent
-            float newNormalVel = -velAlongNormal * circle->bounciness;
-            float newTangentVel = velAlongTangent * 0.98f;
-            
-            // Adjust oldPosition to create new velocity
-            // velocity change = newVel - oldVel
-            // oldPosition change = -(velocity change) = oldVel - newVel
-            sf::Vector2f oldNormalComp = normal * velAlongNormal;
-            sf::Vector2f oldTangentComp = tangent * velAlongTangent;
-            sf::Vector2f newNormalComp = normal * newNormalVel;
-            sf::Vector2f newTangentComp = tangent * newTangentVel;
-            
-            sf::Vector2f velChange = (newNormalComp + newTangentComp) - (oldNormalComp + oldTangentComp);
-            circle->oldPosition -= velChange;
+            m_bodies.asleep[i] = 0;
+            m_bodies.fixed[i] = m_bodies.isStatic[i];
+            m_bodies.restSteps[i] = 0;
+            m_bodies.islands[i] = BodyStore::NoIsland;
+            if (!m_bodies.isStatic[i]) AddAwake(i);
+            --m_sleepingCount;
+            id = next;
         }
+        m_islandHead[island] = BodyStore::NoIsland;
     }
+    m_wakeIslands.clear();
 }
 
-void PhysicsWorld::ResolveAABBAABB(Object* objA, Object* objB) {
-    auto* boxA = objA->GetAABBCollider();
-    auto* boxB = objB->GetAABBCollider();
-    if (!boxA || !boxB) return;
+// Only the constraint's own islands, instead of WakeAll
+void PhysicsWorld::WakeBodies(BodyHandle a, BodyHandle b) {
+    if (m_sleepingCount == 0) return;
+    for (BodyHandle body : {a, b}) {
+        std::uint32_t index = m_bodies.IndexOf(body);
+        if (index != BodyStore::InvalidIndex && m_bodies.asleep[index]) QueueWake(index);
+    }
+    FlushWakes();
+}
 
-    sf::Vector2f aMin = objA->position - boxA->halfExtents;
-    sf::Vector2f aMax = objA->position + boxA->halfExtents;
-    sf::Vector2f bMin = objB->position - boxB->halfExtents;
-    sf::Vector2f bMax = objB->position + boxB->halfExtents;
+void PhysicsWorld::WakeConstraint(const Constraint& constraint) {
+    switch (constraint.type) {
+        case ConstraintType::Distance: WakeConstraint(static_cast<const DistanceConstraint&>(constraint)); break;
+        case ConstraintType::Spring:   WakeConstraint(static_cast<const SpringConstraint&>(constraint)); break;
+        case ConstraintType::Pin:      WakeConstraint(static_cast<const PinConstraint&>(constraint)); break;
+    }
+}
 
-    if (aMax.x < bMin.x || aMin.x > bMax.x) return; 
-    if (aMax.y < bMin.y || aMin.y > bMax.y) return;
+void PhysicsWorld::WakeAll() {
+    if (m_sleepingCount == 0) return;
 
-    float overlapX = std::min(aMax.x - bMin.x, bMax.x - aMin.x);
-    float overlapY = std::min(aMax.y - bMin.y, bMax.y - aMin.y);
+    for (std::size_t i = 0; i < m_bodies.Size(); ++i) {
+        m_bodies.asleep[i] = 0;
+        m_bodies.restSteps[i] = 0;
+        m_bodies.islands[i] = BodyStore::NoIsland;
+    }
+    m_sleepingCount = 0;
+    RebuildSleepLists();
+}
 
-    sf::Vector2f normal;
-    float penetration;
+// Sleeping bodies only ever pair with awake ones (sleeping layer), so the only contacts
+// that involve one are with an awake body - which means it got hit
+void PhysicsWorld::WakeTouchedIslands() {
+    if (m_sleepingCount == 0) return;
 
-    if (overlapX < overlapY) {
-        penetration = overlapX;
-        normal = (objA->position.x < objB->position.x) ? sf::Vector2f{-1.f, 0.f} : sf::Vector2f{1.f, 0.f};
-    } else {
-        penetration = overlapY;
-        normal = (objA->position.y < objB->position.y) ? sf::Vector2f{0.f, -1.f} : sf::Vector2f{0.f, 1.f};
+    for (const Contact& contact : m_contacts) {
+        const bool asleepA = m_bodies.asleep[contact.bodyA];
+        const bool asleepB = m_bodies.asleep[contact.bodyB];
+        if (asleepA && !m_bodies.isStatic[contact.bodyB]) QueueWake(contact.bodyA);
+        if (asleepB && !m_bodies.isStatic[contact.bodyA]) QueueWake(contact.bodyB);
     }
+    FlushWakes();
+}
 
-    // Store velocities BEFORE any changes
-    sf::Vector2f velA = objA->position - objA->oldPosition;
-    sf::Vector2f velB = objB->position - objB->oldPosition;
+// Entries left over from an earlier step start out as their own root
+std::uint32_t PhysicsWorld::FindIsland(std::uint32_t index) {
+    constexpr std::uint32_t AllAsleep = 0xFFFFFFFFu;
+    if (m_islandStamp[index] != m_sleepStamp) {
+        m_islandStamp[index] = m_sleepStamp;
+        m_islandParent[index] = index;
+        m_islandRest[index] = AllAsleep;
+        return index;
+    }
+    while (m_islandParent[index] != index) {
+        m_islandParent[index] = m_islandParent[m_islandParent[index]];  // path halving
+        index = m_islandParent[index];
+    }
+    return index;
+}
 
-    // Positional correction - move BOTH to preserve velocity
-    sf::Vector2f correction = normal * (penetration * 0.5f);
-    if (!objA->isStatic) {
-        objA->position += correction;
-        objA->oldPosition += correction;
+// Only the awake bodies and the sleeping ones a constraint joins to them are visited;
+// contacts can't involve a sleeping body past WakeTouchedIslands.
+void PhysicsWorld::UpdateSleep(float dt) {
+    const std::uint32_t count = static_cast<std::uint32_t>(m_bodies.Size());
+    const float limit = m_sleepSpeed * dt;   // per step displacement
+    const float limitSq = limit * limit;
+
+    // Rest counters for the awake dynamic bodies
+    for (std::uint32_t i : m_awake) {
+        sf::Vector2f velocity = m_bodies.positions[i] - m_bodies.oldPositions[i];
+        if (velocity.x * velocity.x + velocity.y * velocity.y < limitSq) {
+            if (m_bodies.restSteps[i] < 0xFFFF) ++m_bodies.restSteps[i];
+        } else {
+            m_bodies.restSteps[i] = 0;
+        }
     }
-    if (!objB->isStatic) {
-        objB->position -= correction;
-        objB->oldPosition -= correction;
+
+    // Islands over dynamic bodies. Static bodies don't join anything, or the floor
+    // would glue every pile into one island. Resizing keeps old entries, the stamp
+    // tells them apart (it wraps after 4 billion steps; a stale entry would need to
+    // survive that long untouched to be mistaken for a fresh one).
+    if (m_islandStamp.size() < count) {
+        m_islandParent.resize(count);
+        m_islandRest.resize(count);
+        m_islandStamp.resize(count, m_sleepStamp);
     }
+    ++m_sleepStamp;
+    m_islandTouched.clear();
+
+    auto unite = [&](std::uint32_t a, std::uint32_t b) {
+        if (m_bodies.isStatic[a] || m_bodies.isStatic[b]) return;
+        for (std::uint32_t i : {a, b}) {
+            if (m_bodies.asleep[i] && m_islandStamp[i] != m_sleepStamp) m_islandTouched.push_back(i);
+        }
+        a = FindIsland(a);
+        b = FindIsland(b);
+        if (a != b) m_islandParent[std::max(a, b)] = std::min(a, b);
+    };
 
-    // Bounce response
-    float bounceStrength = 0.5f;
-    sf::Vector2f relVel = velA - velB;
-    float relVelAlongNormal = relVel.x * normal.x + relVel.y * normal.y;
-    
-    if (relVelAlongNormal < 0) {
-        sf::Vector2f impulse = normal * (-relVelAlongNormal * (1.f + bounceStrength) * 0.5f);
-        
-        if (!objA->isStatic) objA->oldPosition -= impulse;
-        if (!objB->isStatic) objB->oldPosition += impulse;
+    for (const Contact& contact : m_contacts) unite(contact.bodyA, contact.bodyB);
+    m_constraints.ForEachBodyPair([&](BodyHandle a, BodyHandle b) {
+        std::uint32_t ia = m_bodies.IndexOf(a);
+        std::uint32_t ib = m_bodies.IndexOf(b);
+        if (ia != BodyStore::InvalidIndex && ib != BodyStore::InvalidIndex) unite(ia, ib);
+    });
+
+    // Per root: the slowest member decides. Sleeping members count as rested,
+    // an awake one that isn't rested keeps (or gets) the whole island awake.
+    constexpr std::uint32_t AllAsleep = 0xFFFFFFFFu;
+    for (std::uint32_t i : m_awake) {
+        std::uint32_t root = FindIsland(i);
+        m_islandRest[root] = std::min<std::uint32_t>(m_islandRest[root], m_bodies.restSteps[i]);
+    }
+
+    // Island id = handle id of the root body. The root is in the island, and islands
+    // only ever wake as a whole, so no other sleeping island can have the same id.
+    const std::uint32_t needed = static_cast<std::uint32_t>(std::clamp(m_sleepSteps, 1, 0xFFFF));
+    m_fallingAsleep.clear();
+    for (std::uint32_t i : m_awake) {
+        if (m_islandRest[FindIsland(i)] >= needed) m_fallingAsleep.push_back(i);
+    }
+    for (std::uint32_t i : m_islandTouched) {
+        std::uint32_t root = FindIsland(i);
+        if (m_islandRest[root] == AllAsleep) continue;   // nothing new, keep its old id
+        if (m_islandRest[root] < needed) {
+            // mixed island, e.g. an awake body got linked to a sleeping one
+            QueueWake(i);
+            continue;
+        }
+        const std::uint32_t island = m_bodies.HandleAt(root).id;
+        if (m_bodies.islands[i] != island) {
+            UnlinkIsland(i);
+            LinkIsland(i, island);
+        }
+    }
+    if (!m_fallingAsleep.empty()) m_sleepingDirty = true;
+    for (std::uint32_t i : m_fallingAsleep) {
+        RemoveAwake(i);
+        m_bodies.asleep[i] = 1;
+        m_bodies.fixed[i] = 1;
+        m_bodies.oldPositions[i] = m_bodies.positions[i];   // at rest for real
+        LinkIsland(i, m_bodies.HandleAt(FindIsland(i)).id);
+        ++m_sleepingCount;
     }
+    FlushWakes();
 }
@@ -1,46 +1,423 @@
 #ifndef PHYSICSENGINE_PHYSICSWORLD_H
 #define PHYSICSENGINE_PHYSICSWORLD_H
 
+#include <algorithm>
+#include <span>
+#include <string>
 #include <vector>
 #include <memory>
+#include <type_traits>
 #include <SFML/System/Vector2.hpp>
 #include "Object.h"
 #include "Constraint.h"
+#include "Broadphase.h"
+#include "BodyStore.h"
+#include "ConstraintStore.h"
+#include "ThreadPool.h"
+#include "Narrowphase.h"
+#include "PhysicsStats.h"
+
+class TrajectoryRecorder;
+
+// Closest hit of PhysicsWorld::Raycast
+struct RaycastHit {
+    BodyHandle body;
+    sf::Vector2f point;
+    sf::Vector2f normal;     // surface normal at point, facing the ray
+    float distance = 0.f;    // along the ray, same units as maxDistance
+};
 
 class PhysicsWorld {
 private:
-    std::vector<Object*> m_objects;
-    std::vector<std::unique_ptr<Constraint>> m_constraints;
+    // All body state lives here; Objects added with AddObject are mirrored in/out each Step
+    BodyStore m_bodies;
+    std::size_t m_linkedCount = 0;
+
+    ConstraintStore m_constraints;
     sf::Vector2f m_gravity;
-    int m_constraintIterations = 4;  // More iterations = more stable
-
-    // Collision resolution methods
-    void ResolveCollision(Object* objA, Object* objB);
-    void ResolveCircleCircle(Object* objA, Object* objB);
-    void ResolveCircleAABB(Object* circle, Object* box);
-    void ResolveAABBAABB(Object* objA, Object* objB);
-    
+    int m_constraintIterations = 4;  // More iterations = more stable (an upper bound with a tolerance set)
+    float m_constraintTolerance = 0.f;
+    bool m_xpbdEnabled = false;
+    int m_lastConstraintIterations = 0;
+
+    // Broadphase: bounds per body -> candidate pairs for the narrowphase
+    std::unique_ptr<Broadphase> m_broadphase;
+    std::vector<BroadphaseProxy> m_proxies;
+    std::vector<BodyPair> m_pairs;
+
+    // Static layer: static bodies (not sleeping ones) are kept out of the broadphase
+    // and live in a BVH instead, rebuilt only when one is added, removed, moved or
+    // changes shape. Dynamic bodies query it, so static-static pairs never come up.
+    StaticBVH m_staticLayer;
+    bool m_staticDirty = true;
+    std::size_t m_staticRebuilds = 0;
+    std::vector<std::uint32_t> m_staticIndices;   // scratch: the static bodies, then query hits
+    std::vector<BodyPair> m_staticPairs;
+    std::vector<BodyPair> m_mergedPairs;          // swapped with m_pairs, both kept between steps
+
+    // Sleeping layer: the same for sleeping bodies. They don't move, so it's only rebuilt
+    // when an island falls asleep or wakes (or their indices shift); the broadphase sees
+    // awake bodies only, and those query this next to the static layer.
+    StaticBVH m_sleepingLayer;
+    bool m_sleepingDirty = true;
+    std::size_t m_sleepingRebuilds = 0;
+
+    // Narrowphase: pairs -> batches per shape pair -> contacts (read only, can go wide)
+    // -> resolved batch by batch, pair order within one. The buffers are only cleared,
+    // never freed, so steady state Steps don't allocate.
+    PairBatches m_pairBatches;
+    std::vector<Contact> m_contacts;
+    std::vector<BodyHandle> m_contactBodies;   // RemoveBodies: last Step's contacts by handle across the swap-and-pop
+    std::vector<std::vector<Contact>> m_threadContacts;   // one per pool chunk, kept between steps
+    bool m_parallelNarrowphase = true;
+    int m_contactIterations = 1;
+
+    // Continuous collision (off by default): fast circles get swept proxies, then
+    // SweepFastBodies stops each at its first time of impact. States per body.
+    static constexpr std::uint8_t SweepFast = 1;
+    static constexpr std::uint8_t SweepRewound = 2;
+    struct SweepHit {
+        float time;
+        Contact contact;
+    };
+    bool m_ccdEnabled = false;
+    float m_ccdThreshold = 0.5f;          // fraction of the radius per step
+    std::vector<std::uint8_t> m_sweepState;
+    std::vector<std::uint32_t> m_fastBodies;
+    std::vector<SweepHit> m_sweepHits;    // per body, valid for fast ones
+    std::size_t m_sweptCount = 0;
+
+    void UpdateProxies();
+    void SweepProxies();
+    void UpdateStaticLayer();
+    void UpdateSleepingLayer();
+    void FindStaticPairs();
+    void DetectContacts();
+    void SweepFastBodies();
+
+    // Queries reuse the broadphase. After a Step that's what FindPairs built, grown by
+    // m_queryMargin; only an add/remove/teleport has the next query rebuild it.
+    bool m_queryStale = true;
+    float m_queryMargin = 0.f;   // how far resolve pushed bodies out of their proxies
+    std::vector<std::uint32_t> m_queryIndices;
+    void PrepareQuery();
+    void MeasureQueryMargin();
+    void SortQueryHits();
+    template <typename Filter>
+    std::size_t RunQuery(sf::Vector2f min, sf::Vector2f max, std::vector<BodyHandle>& out, Filter&& keep);
+    void ResolveContacts();
+    ThreadPool& GetThreadPool();
+
+    PhysicsStats m_stats;
+    TrajectoryRecorder* m_recorder = nullptr;
+
+    // Fixed timestep mode for Update()
+    float m_fixedStep = 1.f / 480.f;
+    int m_maxSteps = 16;
+    float m_accumulator = 0.f;
+
+    // Adaptive substepping: m_fixedStep = m_substepFrame / m_substeps, re-picked every Update
+    bool m_adaptiveSubsteps = false;
+    int m_substeps = 8;
+    int m_minSubsteps = 2;
+    int m_maxSubsteps = 16;
+    float m_substepFrame = 1.f / 60.f;
+    float m_substepMotion = 0.25f;         // fraction of the smallest collider per substep
+    float m_substepPenetration = 0.05f;
+    float m_substepTimer = 0.f;            // re-pick once per frame, however often Update runs
+
+    void ChooseSubsteps();
+    void SetSubsteps(int substeps);
+
+    // Sleeping (off by default). Islands are connected groups of dynamic bodies,
+    // contacts and built-in constraints are the edges; they sleep and wake as one.
+    bool m_sleepEnabled = false;
+    float m_sleepSpeed = 15.f;        // units per second
+    int m_sleepSteps = 60;
+    std::size_t m_sleepingCount = 0;
+
+    // Sleep bookkeeping only touches the awake bodies and the islands waking up, so a
+    // mostly sleeping world costs what's awake. The integrator's skip mask is
+    // BodyStore::fixed, flipped along with asleep.
+    static constexpr std::uint32_t NotAwake = 0xFFFFFFFFu;
+    std::vector<std::uint32_t> m_awake;          // awake dynamic bodies (dense indices), no particular order
+    std::vector<std::uint32_t> m_awakeSlot;      // per body: where it is in m_awake, NotAwake if it isn't
+    std::vector<std::uint32_t> m_islandHead;     // per island id (a handle id): first member's handle id
+    std::vector<std::uint32_t> m_islandNext;     // per handle id: next member of its island, both ways
+    std::vector<std::uint32_t> m_islandPrev;
+
+    // Union-find per step, over what this step touches: an entry whose stamp is old counts as its own root
+    std::vector<std::uint32_t> m_islandParent;
+    std::vector<std::uint32_t> m_islandRest;     // per root: min rest steps of its awake members
+    std::vector<std::uint32_t> m_islandStamp;
+    std::uint32_t m_sleepStamp = 0;
+    std::vector<std::uint32_t> m_islandTouched;  // sleeping bodies a constraint joined to this step's islands
+    std::vector<std::uint32_t> m_fallingAsleep;
+    std::vector<std::uint32_t> m_wakeIslands;
+
+    void UpdateSleep(float dt);
+    void WakeTouchedIslands();
+    void QueueWake(std::uint32_t index);
+    void FlushWakes();
+    void WakeAll();
+    void WakeBodies(BodyHandle a, BodyHandle b);
+    std::uint32_t FindIsland(std::uint32_t index);
+    void AddAwake(std::uint32_t index);
+    void RemoveAwake(std::uint32_t index);
+    void LinkIsland(std::uint32_t index, std::uint32_t island);
+    void UnlinkIsland(std::uint32_t index);
+    void RebuildSleepLists();   // from the asleep/islands columns, after bodies got shuffled or loaded
+
+    // Wakes what a constraint touches; custom types are opaque, so those wake everything
+    void WakeConstraint(const DistanceConstraint& c) { WakeBodies(c.bodyA, c.bodyB); }
+    void WakeConstraint(const SpringConstraint& c) { WakeBodies(c.bodyA, c.bodyB); }
+    void WakeConstraint(const PinConstraint& c) { WakeBodies(c.body, BodyHandle{}); }
+    void WakeConstraint(const Constraint& constraint);
+    template <typename T>
+    void WakeConstraint(const T&) { WakeAll(); }
+
+    // Spatial reordering (off by default): body storage re-sorted along a Morton curve
+    // of position every m_reorderInterval Steps
+    int m_reorderInterval = 0;
+    int m_stepsSinceReorder = 0;
+    std::size_t m_reorderCount = 0;
+    std::vector<std::uint64_t> m_reorderKeys;     // Morton code << 32 | dense index
+    std::vector<std::uint32_t> m_reorderOrder;    // new dense index -> old
+    std::vector<std::uint32_t> m_reorderRemap;    // old dense index -> new
+
+    // Compat layer for AddObject(Object*)
+    std::vector<BodyHandle> m_removeScratch;
+    void PullLinkedObjects();
+    void PushLinkedObjects();
+
     // Constraint solving
-    void SolveConstraints();
+    int SolveConstraints(float dt);
+
+    ConstraintSolverMode m_solverMode = ConstraintSolverMode::Sequential;
+    float m_jacobiRelaxation = 1.f;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    unsigned m_threadCount = 0;    // 0 = one per core
 
 public:
     PhysicsWorld();
 
-    void AddObject(Object* object);
+    // Bodies owned by the world, addressed by handle. Removal is O(1) per body;
+    // handles to removed bodies go stale (IsValid false), constraints on them are skipped.
+    BodyHandle AddBody(const BodyDesc& desc);
+    void RemoveBody(BodyHandle body);
+    void RemoveBodies(std::span<const BodyHandle> bodies);   // one wake pass and broadphase reset for all
+    bool IsValid(BodyHandle body) const { return m_bodies.Contains(body); }
+
+    sf::Vector2f GetPosition(BodyHandle body) const;
+    void SetPosition(BodyHandle body, sf::Vector2f position);
+    void SetVelocity(BodyHandle body, sf::Vector2f velocity, float dt);
+
+    // Up front capacity for count bodies (AddBody or AddObject): body columns plus the
+    // per body step buffers. Spawning/despawning below that never allocates.
+    void ReserveBodies(std::size_t count);
+
+    const BodyStore& GetBodies() const { return m_bodies; }
+    std::size_t GetBodyCount() const { return m_bodies.Size(); }
+
+    // Bodies spawned and despawned in any order end up scattered in memory. With an
+    // interval set, every interval Steps the body storage is sorted along a Morton
+    // (Z-order) curve of position, so bodies near each other are near in memory again
+    // for the broadphase, narrowphase and constraint loops. Handles, constraints and
+    // linked Objects follow their bodies; dense indices (GetBodies(), GetContacts())
+    // change. Pairs are resolved in the new order, so results differ from an unsorted
+    // world (still the same every run). 0 = off.
+    void SetSpatialReorder(int interval);
+    int GetSpatialReorder() const { return m_reorderInterval; }
+    // Sorts right now; nothing moves if the bodies are already in order. Returns whether they moved.
+    bool ReorderBodies();
+    std::size_t GetReorderCount() const { return m_reorderCount; }   // passes that moved bodies
+
+    // Compat: the Object stays the source of truth, the world copies it each Step
+    BodyHandle AddObject(Object* object);
     void RemoveObject(Object* object);
-    
-    //  World owns the constraint
-    Constraint* AddConstraint(std::unique_ptr<Constraint> constraint);
-    void RemoveConstraint(Constraint* constraint);
-    
+    void RemoveObjects(std::span<Object* const> objects);
+
+    //  World owns the constraint. Pointers stay valid until RemoveConstraint.
+    // T is DistanceConstraint/SpringConstraint/PinConstraint, or any custom type
+    // with a `void Solve(BodyStore&)` - custom types get their own bucket on first use.
+    template <typename T>
+    T* AddConstraint(T constraint) {
+        T* c = m_constraints.Add<T>(std::move(constraint));
+        WakeConstraint(*c);
+        return c;
+    }
+
+    // Compat with the old AddConstraint(std::unique_ptr<Constraint>): the constraint is
+    // moved into its type's pool and the stored copy is returned, not the one passed in.
+    template <typename T>
+    T* AddConstraint(std::unique_ptr<T> constraint) {
+        if constexpr (std::is_same_v<T, Constraint>) {
+            // No virtual destructor anymore, so it has to be deleted as what it really is
+            Constraint* raw = constraint.release();
+            switch (raw->type) {
+                case ConstraintType::Distance: return AddConstraint(std::unique_ptr<DistanceConstraint>(static_cast<DistanceConstraint*>(raw)));
+                case ConstraintType::Spring:   return AddConstraint(std::unique_ptr<SpringConstraint>(static_cast<SpringConstraint*>(raw)));
+                case ConstraintType::Pin:      return AddConstraint(std::unique_ptr<PinConstraint>(static_cast<PinConstraint*>(raw)));
+            }
+            return nullptr;
+        } else {
+            return AddConstraint(std::move(*constraint));
+        }
+    }
+
+    template <typename T>
+    void RemoveConstraint(T* constraint) {
+        WakeConstraint(*constraint);
+        m_constraints.Remove(constraint);
+    }
+
+    template <typename T>
+    void RegisterConstraintType() { m_constraints.Register<T>(); }
+
+    // Blocks for count constraints of type T; removed slots are reused by the next add
+    template <typename T>
+    void ReserveConstraints(std::size_t count) { m_constraints.Reserve<T>(count); }
+
+    std::size_t GetConstraintCount() const { return m_constraints.Size(); }
+    const ConstraintStore& GetConstraints() const { return m_constraints; }
+
     // Create 3 types of constraints
     DistanceConstraint* AddDistanceConstraint(Object* a, Object* b, float length = -1.f);
     SpringConstraint* AddSpringConstraint(Object* a, Object* b, float stiffness = 0.5f, float damping = 0.1f);
     PinConstraint* AddPinConstraint(Object* obj, sf::Vector2f anchor);
-    
+
+    DistanceConstraint* AddDistanceConstraint(BodyHandle a, BodyHandle b, float length = -1.f);
+    SpringConstraint* AddSpringConstraint(BodyHandle a, BodyHandle b, float stiffness = 0.5f, float damping = 0.1f);
+    PinConstraint* AddPinConstraint(BodyHandle body, sf::Vector2f anchor);
+
     void SetConstraintIterations(int iterations) { m_constraintIterations = iterations; }
-    
+    int GetConstraintIterations() const { return m_constraintIterations; }
+
+    // Early exit: an iteration where no built-in constraint was off by more than
+    // tolerance (world units) is the last one. 0 = always run every iteration.
+    void SetConstraintTolerance(float tolerance) { m_constraintTolerance = tolerance; }
+    float GetConstraintTolerance() const { return m_constraintTolerance; }
+    int GetLastConstraintIterations() const { return m_lastConstraintIterations; }
+
+    // XPBD: distance constraints use their compliance (0 = rigid) and the body masses
+    // instead of stiffness, so how stiff they are no longer depends on iteration or
+    // substep count. Springs and pins are unchanged; Jacobi mode ignores this.
+    void SetXPBDEnabled(bool enabled) { m_xpbdEnabled = enabled; }
+    bool IsXPBDEnabled() const { return m_xpbdEnabled; }
+
+    // Same thread count -> same result, every run
+    void SetConstraintSolverMode(ConstraintSolverMode mode) { m_solverMode = mode; }
+    ConstraintSolverMode GetConstraintSolverMode() const { return m_solverMode; }
+    // Jacobi mode only: averaged corrections are scaled by this. 1 is safe; up to ~1.9
+    // converges faster on big meshes, 2+ overshoots.
+    void SetJacobiRelaxation(float relaxation) { m_jacobiRelaxation = relaxation; }
+    float GetJacobiRelaxation() const { return m_jacobiRelaxation; }
+    void SetThreadCount(unsigned threads);
+    unsigned GetThreadCount() const;
+    std::size_t GetConstraintColorCount();
+
+    // Per world, so brute force can still be used as a reference
+    void SetBroadphase(BroadphaseType type);
+    BroadphaseType GetBroadphaseType() const { return m_broadphase->GetType(); }
+    Broadphase& GetBroadphase() { return *m_broadphase; }
+
+    // The static layer as of the last Step or query; rebuilds counts how often it
+    // had to be rebuilt (not at all while static bodies stay as they are)
+    const StaticBVH& GetStaticLayer() const { return m_staticLayer; }
+    std::size_t GetStaticLayerRebuilds() const { return m_staticRebuilds; }
+    const StaticBVH& GetSleepingLayer() const { return m_sleepingLayer; }
+    std::size_t GetSleepingLayerRebuilds() const { return m_sleepingRebuilds; }
+
+    // Detection over the thread pool once there are enough pairs. Contacts
+    // come out in pair order either way, so this doesn't change results.
+    static constexpr std::size_t MinParallelPairs = 1024;
+    void SetParallelNarrowphase(bool enabled) { m_parallelNarrowphase = enabled; }
+    bool GetParallelNarrowphase() const { return m_parallelNarrowphase; }
+
+    // Extra passes re-measure each contact (no new broadphase/detection) and push
+    // again - helps tall stacks settle. 1 = single pass, like before.
+    void SetContactIterations(int iterations) { m_contactIterations = std::max(1, iterations); }
+    int GetContactIterations() const { return m_contactIterations; }
+
+    // Continuous collision: circles that move more than threshold x their radius in a
+    // Step are swept from oldPosition to position against circles and AABBs. One that
+    // would hit something stops where it first touches (velocity kept, the rest of
+    // that Step's travel lost) and bounces off it, so it can't tunnel. Lets the world
+    // run far fewer substeps while only the fast bodies pay for the sweep.
+    void SetContinuousCollision(bool enabled, float threshold = 0.5f);
+    bool GetContinuousCollision() const { return m_ccdEnabled; }
+    float GetContinuousThreshold() const { return m_ccdThreshold; }
+    std::size_t GetSweptCount() const { return m_sweptCount; }   // stopped early in the last Step
+
+    // Bodies slower than speed (units/s) for steps Steps in a row fall asleep, together
+    // with everything they touch or are constrained to. Sleeping bodies are skipped by
+    // integration, constraints and collision until something wakes them.
+    void SetSleepEnabled(bool enabled);
+    bool GetSleepEnabled() const { return m_sleepEnabled; }
+    void SetSleepThreshold(float speed, int steps) { m_sleepSpeed = speed; m_sleepSteps = steps; }
+    bool IsAsleep(BodyHandle body) const;
+    void WakeBody(BodyHandle body);
+    std::size_t GetSleepingCount() const { return m_sleepingCount; }
+    // Dynamic bodies that aren't asleep (dense indices, no particular order); everything
+    // else hasn't moved since it was last looked at
+    const std::vector<std::uint32_t>& GetAwakeBodies() const { return m_awake; }
+
+    // Contacts found in the last Step, grouped by ContactType, broadphase pair order within
+    // a group (dense indices). GetBodies().HandleAt() turns an index into a handle.
+    const std::vector<Contact>& GetContacts() const { return m_contacts; }
+
     void Step(float dt);
+
+    // Binary snapshot of the whole simulation (layout in WorldSnapshot.h): bodies with
+    // their handles, colliders, sleep state, built-in constraints and world settings.
+    // Bodies from AddObject are saved as plain bodies (pointers can't be stored) and
+    // custom constraint types are skipped. Load replaces everything in this world and
+    // unlinks any Objects; false with the world untouched if the file is unreadable,
+    // truncated or from another version.
+    bool SaveSnapshot(const std::string& path) const;
+    bool LoadSnapshot(const std::string& path);
+
+    // Spatial queries against the shapes as of the last Step. Results replace the
+    // contents of out, in body order, and the count is returned. Bodies without a
+    // collider are never hit; sleeping and static bodies are.
+    std::size_t QueryPoint(sf::Vector2f point, std::vector<BodyHandle>& out);
+    std::size_t QueryAABB(sf::Vector2f min, sf::Vector2f max, std::vector<BodyHandle>& out);
+    std::size_t QueryRadius(sf::Vector2f center, float radius, std::vector<BodyHandle>& out);
+
+    // Closest shape along origin + direction * t, t in [0, maxDistance]. direction
+    // doesn't need to be normalized. Starting inside a shape hits it at distance 0.
+    bool Raycast(sf::Vector2f origin, sf::Vector2f direction, float maxDistance, RaycastHit& hit);
+
+    // Per phase timings and counters of the last N Steps (empty if PHYSICS_ENABLE_STATS is 0)
+    const PhysicsStats& GetStats() const { return m_stats; }
+    void SetStatsHistorySize(std::size_t steps) { m_stats.SetHistorySize(steps); }
+
+    // Every Step ends with recorder->Record(bodies) (timed as StepPhase::Record).
+    // Not owned; nullptr stops recording. Set it from the thread that steps.
+    void SetRecorder(TrajectoryRecorder* recorder) { m_recorder = recorder; }
+    TrajectoryRecorder* GetRecorder() const { return m_recorder; }
+
+    // Fixed timestep: Update() adds the frame time to an accumulator and runs as many
+    // whole Steps of `step` as fit, at most maxSteps per call (the rest is dropped, so
+    // a hitch can't snowball). Returns the number of Steps taken.
+    void SetFixedTimestep(float step, int maxSteps = 16);   // also turns adaptive substepping off
+    float GetFixedTimestep() const { return m_fixedStep; }
+    int Update(float frameDt);
+
+    // Adaptive substepping for Update(): the step becomes frame / n, and every Update
+    // picks n in [minSubsteps, maxSubsteps] so that no dynamic body moves more than
+    // motion x the smallest collider size per substep and the deepest contact of the
+    // last Step stays under penetration x that size. n goes up at once and comes down
+    // one per Update; velocities carry over when it changes. Fixed timestep again
+    // with SetFixedTimestep().
+    void SetAdaptiveSubsteps(int minSubsteps, int maxSubsteps, float frame = 1.f / 60.f);
+    void SetSubstepTargets(float motion = 0.25f, float penetration = 0.05f);
+    bool GetAdaptiveSubsteps() const { return m_adaptiveSubsteps; }
+    int GetSubsteps() const { return m_substeps; }   // per frame, adaptive mode (re-picked once a frame)
+
+    // How far between the last two fixed steps the leftover time is, 0..1
+    float GetInterpolationAlpha() const { return m_accumulator / m_fixedStep; }
+    sf::Vector2f GetInterpolatedPosition(BodyHandle body) const;
 };
 
 #endif //PHYSICSENGINE_PHYSICSWORLD_H
@@ -15,6 +15,7 @@ struct Spring {
     sf::Color color;
     float thickness;
     int coils;  // no. of segments
+    sf::VertexArray lines{sf::PrimitiveType::LineStrip};  // reused every frame
     
     Spring(Object* a, Object* b, SpringConstraint* c, 
            sf::Color col = sf::Color(180, 180, 200), 
@@ -39,7 +40,7 @@ struct Spring {
         float stretchRatio = length / restLength;
         float amplitude = 8.f / std::max(stretchRatio, 0.5f);  // Wider when compressed
 
-        sf::VertexArray lines(sf::PrimitiveType::LineStrip, coils + 3);
+        lines.resize(coils + 3);
         
         // Start at objA
         lines[0].position = start;
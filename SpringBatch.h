@@ -0,0 +1,88 @@
+#ifndef PHYSICSENGINE_SPRINGBATCH_H
+#define PHYSICSENGINE_SPRINGBATCH_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "PhysicsThread.h"
+#include "PhysicsWorld.h"
+
+/**
+ * Every SpringConstraint in the world as zigzag lines, one draw call
+ *
+ * Same shape as Spring::render, but all springs share one Lines vertex
+ * buffer that is rewritten in place each frame and only ever grows, so
+ * there's no allocation in steady state. Springs shorter than the LOD
+ * length are a single straight line, the zigzag wouldn't be visible anyway.
+ */
+class SpringBatch : public sf::Drawable {
+private:
+    std::vector<sf::Vertex> m_lines;
+    std::size_t m_used = 0;     // vertices written this frame
+    sf::Color m_color;
+    int m_coils;
+    float m_lodLength;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        if (m_used > 0) target.draw(m_lines.data(), m_used, sf::PrimitiveType::Lines, states);
+    }
+
+    void Line(sf::Vector2f a, sf::Vector2f b) {
+        if (m_used + 2 > m_lines.size()) m_lines.resize(std::max<std::size_t>(64, m_lines.size() * 2));
+        m_lines[m_used++] = {a, m_color};
+        m_lines[m_used++] = {b, m_color};
+    }
+
+    void WriteSpring(sf::Vector2f start, sf::Vector2f end, float restLength) {
+        sf::Vector2f diff = end - start;
+        float length = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+        if (length < 0.001f) return;
+
+        if (length < m_lodLength) {
+            Line(start, end);
+            return;
+        }
+
+        sf::Vector2f dir = diff / length;
+        sf::Vector2f perp = {-dir.y, dir.x};
+        float stretchRatio = restLength > 0.f ? length / restLength : 1.f;
+        float amplitude = 8.f / std::max(stretchRatio, 0.5f);  // Wider when compressed
+
+        sf::Vector2f previous = start + dir * (length * 0.1f);
+        Line(start, previous);
+        for (int i = 0; i < m_coils; ++i) {
+            float t = 0.1f + (static_cast<float>(i) + 0.5f) * 0.8f / static_cast<float>(m_coils);
+            float side = (i % 2 == 0) ? 1.f : -1.f;
+            sf::Vector2f pos = start + dir * (length * t) + perp * (amplitude * side);
+            Line(previous, pos);
+            previous = pos;
+        }
+        Line(previous, end);
+    }
+
+public:
+    explicit SpringBatch(sf::Color color = sf::Color(180, 180, 200), int coils = 8, float lodLength = 6.f)
+        : m_color(color), m_coils(coils), m_lodLength(lodLength) {}
+
+    // Once per frame before drawing
+    void update(const PhysicsWorld& world) {
+        m_used = 0;
+        world.GetConstraints().springs.ForEach([&](const SpringConstraint& c) {
+            if (!world.IsValid(c.bodyA) || !world.IsValid(c.bodyB)) return;
+            WriteSpring(world.GetInterpolatedPosition(c.bodyA), world.GetInterpolatedPosition(c.bodyB), c.restLength);
+        });
+    }
+
+    void update(const RenderSnapshot& snapshot) {
+        m_used = 0;
+        for (const RenderSnapshot::SpringLine& spring : snapshot.springs) {
+            if (!snapshot.Contains(spring.a) || !snapshot.Contains(spring.b)) continue;
+            WriteSpring(snapshot.Position(spring.a), snapshot.Position(spring.b), spring.restLength);
+        }
+    }
+
+    std::size_t GetVertexCount() const { return m_used; }
+};
+
+#endif //PHYSICSENGINE_SPRINGBATCH_H
@@ -0,0 +1,53 @@
+#ifndef PHYSICSENGINE_SPSCQUEUE_H
+#define PHYSICSENGINE_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * Bounded lock-free queue, exactly one producer thread and one consumer thread
+ *
+ * head is only written by the consumer and tail only by the producer, so a
+ * release store on one side + acquire load on the other is all the syncing
+ * needed. One slot stays empty to tell full from empty.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2, "one slot is always left empty");
+
+public:
+    // Producer. false = full, item is left untouched.
+    bool TryPush(T&& item) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = (tail + 1) % Capacity;
+        if (next == m_head.load(std::memory_order_acquire)) return false;
+
+        m_items[tail] = std::move(item);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer. false = empty.
+    bool TryPop(T& out) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        out = std::move(m_items[head]);
+        m_items[head] = T{};   // drop captures now, not when the slot comes round again
+        m_head.store((head + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> m_items{};
+    alignas(64) std::atomic<std::size_t> m_head{0};   // next to pop
+    alignas(64) std::atomic<std::size_t> m_tail{0};   // next to push
+};
+
+#endif //PHYSICSENGINE_SPSCQUEUE_H
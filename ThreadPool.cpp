@@ -0,0 +1,137 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    m_stealRanges = std::make_unique<StealRange[]>(threads);
+
+    for (unsigned i = 1; i < threads; ++i) {
+        m_workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers) t.join();
+}
+
+void ThreadPool::RunChunk(unsigned index, const ChunkFn& fn, std::size_t count) const {
+    const std::size_t threads = GetThreadCount();
+    const std::size_t begin = count * index / threads;
+    const std::size_t end = count * (index + 1) / threads;
+    if (begin < end) fn(index, begin, end);
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const RangeFn& fn) {
+    if (count == 0) return;
+    if (m_workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    ParallelForChunks(count, [&fn](unsigned, std::size_t begin, std::size_t end) { fn(begin, end); });
+}
+
+void ThreadPool::ParallelForChunks(std::size_t count, const ChunkFn& fn) {
+    if (count == 0) return;
+    if (m_workers.empty()) {
+        fn(0, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &fn;
+        m_count = count;
+        m_pending = static_cast<unsigned>(m_workers.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    RunChunk(0, fn, count);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_job = nullptr;
+}
+
+bool ThreadPool::StealRange::PopFront(std::size_t& index) {
+    std::uint64_t current = range.load(std::memory_order_relaxed);
+    while (true) {
+        const std::uint64_t begin = current & 0xFFFFFFFFu;
+        const std::uint64_t end = current >> 32;
+        if (begin >= end) return false;
+        if (range.compare_exchange_weak(current, (end << 32) | (begin + 1), std::memory_order_relaxed)) {
+            index = static_cast<std::size_t>(begin);
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::StealRange::PopBack(std::size_t& index) {
+    std::uint64_t current = range.load(std::memory_order_relaxed);
+    while (true) {
+        const std::uint64_t begin = current & 0xFFFFFFFFu;
+        const std::uint64_t end = current >> 32;
+        if (begin >= end) return false;
+        if (range.compare_exchange_weak(current, ((end - 1) << 32) | begin, std::memory_order_relaxed)) {
+            index = static_cast<std::size_t>(end - 1);
+            return true;
+        }
+    }
+}
+
+// The ranges are only claims on indices: fn's writes are published by the
+// ParallelForChunks join like any other job
+void ThreadPool::ParallelForStealing(std::size_t count, const ItemFn& fn) {
+    if (count == 0) return;
+    const unsigned threads = GetThreadCount();
+    if (threads == 1) {
+        for (std::size_t i = 0; i < count; ++i) fn(0, i);
+        return;
+    }
+
+    for (unsigned t = 0; t < threads; ++t) {
+        const std::uint64_t begin = count * t / threads;
+        const std::uint64_t end = count * (t + 1) / threads;
+        m_stealRanges[t].range.store((end << 32) | begin, std::memory_order_relaxed);
+    }
+
+    ParallelForChunks(threads, [this, threads, &fn](unsigned thread, std::size_t, std::size_t) {
+        std::size_t index;
+        while (m_stealRanges[thread].PopFront(index)) fn(thread, index);
+        for (unsigned k = 1; k < threads; ++k) {
+            StealRange& victim = m_stealRanges[(thread + k) % threads];
+            while (victim.PopBack(index)) fn(thread, index);
+        }
+    });
+}
+
+void ThreadPool::WorkerLoop(unsigned index) {
+    std::size_t seen = 0;
+
+    while (true) {
+        const ChunkFn* job;
+        std::size_t count;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+            job = m_job;
+            count = m_count;
+        }
+
+        RunChunk(index, *job, count);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+        }
+        m_done.notify_one();
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef PHYSICSENGINE_THREADPOOL_H
+#define PHYSICSENGINE_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Small fork-join pool for the solver loops
+ *
+ * ParallelFor always cuts [0, count) into the same contiguous chunks for a
+ * given thread count, and the calling thread works on chunk 0 instead of
+ * sleeping, so a 1 thread pool is just a plain loop.
+ *
+ * ParallelForStealing is for items of very different cost (whole worlds in
+ * a WorldBatch): every thread starts on the same contiguous share, and once
+ * its own is done it takes items off the far end of the others'.
+ */
+class ThreadPool {
+public:
+    using RangeFn = std::function<void(std::size_t begin, std::size_t end)>;
+    using ChunkFn = std::function<void(unsigned chunk, std::size_t begin, std::size_t end)>;
+    using ItemFn = std::function<void(unsigned thread, std::size_t index)>;
+
+    // threads = total, counting the caller (0 = one per core)
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned GetThreadCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // Blocks until every chunk is done
+    void ParallelFor(std::size_t count, const RangeFn& fn);
+
+    // Same split, but fn also gets the chunk index (0..GetThreadCount()-1),
+    // e.g. so every chunk can fill its own output buffer
+    void ParallelForChunks(std::size_t count, const ChunkFn& fn);
+
+    // One call per index, any thread, any order; thread is 0..GetThreadCount()-1.
+    // count must fit in 32 bits.
+    void ParallelForStealing(std::size_t count, const ItemFn& fn);
+
+private:
+    // [begin, end) of one thread's share, packed so owner and thieves can both CAS it
+    struct alignas(64) StealRange {
+        std::atomic<std::uint64_t> range{0};
+
+        bool PopFront(std::size_t& index);   // owner
+        bool PopBack(std::size_t& index);    // thieves
+    };
+    std::unique_ptr<StealRange[]> m_stealRanges;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const ChunkFn* m_job = nullptr;
+    std::size_t m_count = 0;
+    std::size_t m_generation = 0;
+    unsigned m_pending = 0;
+    bool m_stop = false;
+
+    void WorkerLoop(unsigned index);
+    void RunChunk(unsigned index, const ChunkFn& fn, std::size_t count) const;
+};
+
+#endif //PHYSICSENGINE_THREADPOOL_H
@@ -0,0 +1,319 @@
+#include "TrajectoryRecorder.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Worst case encoded sizes, checked once per frame instead of per byte
+constexpr std::size_t MaxFrameHeaderBytes = 5 + sizeof(float);
+constexpr std::size_t MaxBodyBytes = 5 + 5 + 1 + 2 * sizeof(float) + 2 * 10;
+constexpr std::size_t ChunkHeaderBytes = 2 * sizeof(std::uint32_t);
+
+std::uint8_t* PutVarint(std::uint8_t* out, std::uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<std::uint8_t>(value);
+    return out;
+}
+
+bool GetVarint(const std::uint8_t*& in, const std::uint8_t* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && in < end; shift += 7) {
+        const std::uint8_t byte = *in++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Small negative deltas stay small
+std::uint64_t ZigZag(std::int64_t v) { return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63); }
+std::int64_t UnZigZag(std::uint64_t v) { return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1); }
+
+std::uint8_t* PutFloat(std::uint8_t* out, float value) {
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+bool GetFloat(const std::uint8_t*& in, const std::uint8_t* end, float& value) {
+    if (end - in < static_cast<std::ptrdiff_t>(sizeof(value))) return false;
+    std::memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return true;
+}
+
+}  // namespace
+
+// ============ RECORDER ============
+
+TrajectoryRecorder::TrajectoryRecorder(TrajectoryOptions options) : m_options(options) {
+    if (m_options.chunkCount < 2) m_options.chunkCount = 2;
+    if (m_options.chunkCount > 63) m_options.chunkCount = 63;   // both queues hold every chunk at once
+    if (m_options.quantum <= 0.f) m_options.quantum = TrajectoryOptions{}.quantum;
+    if (m_options.keyframeChunks < 1) m_options.keyframeChunks = 1;
+
+    m_chunks.reserve(m_options.chunkCount);
+    for (std::size_t i = 0; i < m_options.chunkCount; ++i) {
+        m_chunks.push_back(std::make_unique<Chunk>());
+        m_chunks.back()->data.resize(m_options.chunkBytes);
+    }
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    Close();
+}
+
+bool TrajectoryRecorder::Open(const std::string& path) {
+    Close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) return false;
+
+    const float quantum = m_options.quantum;
+    m_file.write(Magic, sizeof(Magic));
+    m_file.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+    m_file.write(reinterpret_cast<const char*>(&quantum), sizeof(quantum));
+
+    // Writer isn't running yet, so filling its side of the queue from here is fine
+    for (auto& chunk : m_chunks) {
+        chunk->used = 0;
+        chunk->frames = 0;
+        Chunk* free = chunk.get();
+        m_empty.TryPush(std::move(free));
+    }
+    m_current = nullptr;
+    m_chunksStarted = 0;   // first chunk is a keyframe, nothing carries over from a previous recording
+    m_recordedFrames = 0;
+    m_droppedFrames = 0;
+
+    m_closing.store(false, std::memory_order_relaxed);
+    m_writer = std::thread([this] { WriterLoop(); });
+    return true;
+}
+
+void TrajectoryRecorder::Close() {
+    if (!m_writer.joinable()) return;
+
+    if (m_current && m_current->frames > 0) SubmitChunk();
+    m_closing.store(true, std::memory_order_release);
+    m_writer.join();
+
+    // Both threads are done with the queues; empty them so Open can start clean
+    Chunk* chunk;
+    while (m_full.TryPop(chunk)) {}
+    while (m_empty.TryPop(chunk)) {}
+    m_current = nullptr;
+    m_file.close();
+}
+
+bool TrajectoryRecorder::StartChunk() {
+    Chunk* chunk = nullptr;
+    if (!m_empty.TryPop(chunk)) return false;
+    m_current = chunk;
+    if (m_chunksStarted++ % m_options.keyframeChunks == 0) ++m_keyframe;
+    return true;
+}
+
+void TrajectoryRecorder::SubmitChunk() {
+    // Never fails: the queue has room for every chunk there is
+    m_full.TryPush(std::move(m_current));
+    m_current = nullptr;
+}
+
+void TrajectoryRecorder::Record(const BodyStore& bodies, float dt) {
+    if (!IsOpen()) return;
+
+    const std::size_t count = bodies.Size();
+    const std::size_t worst = MaxFrameHeaderBytes + count * MaxBodyBytes;
+
+    // Frame goes in whole or not at all; a chunk never ends mid frame
+    if (m_current && m_current->frames > 0 && m_current->used + worst > m_current->data.size()) SubmitChunk();
+    if (!m_current && !StartChunk()) {
+        ++m_droppedFrames;   // writer is behind, don't wait for it
+        return;
+    }
+    if (m_current->used + worst > m_current->data.size()) m_current->data.resize(m_current->used + worst);
+
+    // Only grows when new handle ids show up
+    if (m_seen.size() < bodies.IdCount()) {
+        m_lastX.resize(bodies.IdCount());
+        m_lastY.resize(bodies.IdCount());
+        m_lastGeneration.resize(bodies.IdCount());
+        m_seen.resize(bodies.IdCount(), 0);
+    }
+
+    const float invQuantum = 1.f / m_options.quantum;
+    std::uint8_t* out = m_current->data.data() + m_current->used;
+    out = PutVarint(out, count);
+    out = PutFloat(out, dt);
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const BodyHandle handle = bodies.HandleAt(i);
+        const sf::Vector2f position = bodies.positions[i];
+        const auto qx = static_cast<std::int32_t>(std::lround(position.x * invQuantum));
+        const auto qy = static_cast<std::int32_t>(std::lround(position.y * invQuantum));
+
+        // Keyframe chunk, new id, or the slot got a new body: absolute + shape
+        const bool reset = m_seen[handle.id] != m_keyframe || m_lastGeneration[handle.id] != handle.generation;
+        out = PutVarint(out, (static_cast<std::uint64_t>(handle.id) << 1) | (reset ? 1u : 0u));
+
+        std::int64_t dx = qx, dy = qy;
+        if (reset) {
+            const Collider& collider = bodies.colliders[i];
+            const sf::Vector2f half = collider.HalfExtents();
+            out = PutVarint(out, handle.generation);
+            *out++ = static_cast<std::uint8_t>(collider.type);
+            out = PutFloat(out, half.x);
+            out = PutFloat(out, half.y);
+            m_seen[handle.id] = m_keyframe;
+            m_lastGeneration[handle.id] = handle.generation;
+        } else {
+            dx -= m_lastX[handle.id];
+            dy -= m_lastY[handle.id];
+        }
+        out = PutVarint(out, ZigZag(dx));
+        out = PutVarint(out, ZigZag(dy));
+        m_lastX[handle.id] = qx;
+        m_lastY[handle.id] = qy;
+    }
+
+    m_current->used = static_cast<std::size_t>(out - m_current->data.data());
+    ++m_current->frames;
+    ++m_recordedFrames;
+
+    // Full enough that the next frame of this size won't fit: hand it over now
+    if (m_current->used + worst > m_current->data.size()) SubmitChunk();
+}
+
+void TrajectoryRecorder::WriterLoop() {
+    while (true) {
+        Chunk* chunk = nullptr;
+        if (m_full.TryPop(chunk)) {
+            const std::uint32_t header[2] = {static_cast<std::uint32_t>(chunk->used), chunk->frames};
+            m_file.write(reinterpret_cast<const char*>(header), ChunkHeaderBytes);
+            m_file.write(reinterpret_cast<const char*>(chunk->data.data()), static_cast<std::streamsize>(chunk->used));
+            chunk->used = 0;
+            chunk->frames = 0;
+            m_empty.TryPush(std::move(chunk));
+            continue;
+        }
+
+        // Close pushes the last chunk before setting m_closing, so empty here means done
+        if (m_closing.load(std::memory_order_acquire)) {
+            if (m_full.Empty()) break;
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    m_file.flush();
+}
+
+// ============ READER ============
+
+bool TrajectoryReader::Open(const std::string& path) {
+    m_file.close();
+    m_file.clear();
+    m_file.open(path, std::ios::binary);
+    if (!m_file) return false;
+
+    char magic[4];
+    std::uint32_t version = 0;
+    float quantum = 0.f;
+    m_file.read(magic, sizeof(magic));
+    m_file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    m_file.read(reinterpret_cast<char*>(&quantum), sizeof(quantum));
+    if (!m_file || std::memcmp(magic, TrajectoryRecorder::Magic, sizeof(magic)) != 0 ||
+        version != TrajectoryRecorder::Version || !(quantum > 0.f)) {
+        m_file.close();
+        return false;
+    }
+
+    m_quantum = quantum;
+    m_firstChunk = m_file.tellg();
+    m_framesLeft = 0;
+    return true;
+}
+
+bool TrajectoryReader::Rewind() {
+    if (!IsOpen()) return false;
+    m_file.clear();
+    m_file.seekg(m_firstChunk);
+    m_framesLeft = 0;
+    return static_cast<bool>(m_file);
+}
+
+bool TrajectoryReader::LoadChunk() {
+    std::uint32_t header[2];
+    if (!m_file.read(reinterpret_cast<char*>(header), ChunkHeaderBytes)) return false;
+    if (header[1] == 0) return false;
+
+    m_chunk.resize(header[0]);
+    if (!m_file.read(reinterpret_cast<char*>(m_chunk.data()), header[0])) return false;
+    m_cursor = 0;
+    m_framesLeft = header[1];
+    return true;
+}
+
+bool TrajectoryReader::NextFrame(TrajectoryFrame& frame) {
+    if (!IsOpen()) return false;
+    if (m_framesLeft == 0 && !LoadChunk()) return false;
+
+    const std::uint8_t* in = m_chunk.data() + m_cursor;
+    const std::uint8_t* end = m_chunk.data() + m_chunk.size();
+
+    std::uint64_t count = 0;
+    if (!GetVarint(in, end, count) || !GetFloat(in, end, frame.dt)) return false;
+    if (count > static_cast<std::uint64_t>(end - in) / 3) return false;   // 3 bytes is the least a body can take
+    frame.bodies.resize(count);
+
+    for (TrajectoryFrame::Body& body : frame.bodies) {
+        std::uint64_t key = 0, dx = 0, dy = 0;
+        if (!GetVarint(in, end, key)) return false;
+        const std::uint64_t id = key >> 1;
+        if (id >= BodyHandle::InvalidId) return false;
+
+        std::int64_t x = 0, y = 0;
+        if (key & 1) {
+            std::uint64_t generation = 0;
+            float hx = 0.f, hy = 0.f;
+            if (!GetVarint(in, end, generation) || in == end) return false;
+            const auto type = static_cast<ColliderType>(*in++);
+            if (!GetFloat(in, end, hx) || !GetFloat(in, end, hy)) return false;
+
+            if (id >= m_colliders.size()) {
+                m_lastX.resize(id + 1);
+                m_lastY.resize(id + 1);
+                m_lastGeneration.resize(id + 1);
+                m_colliders.resize(id + 1);
+            }
+            switch (type) {
+                case ColliderType::Circle: m_colliders[id] = CircleCollider(hx); break;
+                case ColliderType::AABB:   m_colliders[id] = AABBCollider(2.f * hx, 2.f * hy); break;
+                case ColliderType::None:   m_colliders[id] = Collider(); break;
+                default: return false;
+            }
+            m_lastGeneration[id] = static_cast<std::uint32_t>(generation);
+        } else {
+            if (id >= m_colliders.size()) return false;   // delta for a body that was never introduced
+            x = m_lastX[id];
+            y = m_lastY[id];
+        }
+
+        if (!GetVarint(in, end, dx) || !GetVarint(in, end, dy)) return false;
+        x += UnZigZag(dx);
+        y += UnZigZag(dy);
+        m_lastX[id] = static_cast<std::int32_t>(x);
+        m_lastY[id] = static_cast<std::int32_t>(y);
+
+        body.handle = BodyHandle{static_cast<std::uint32_t>(id), m_lastGeneration[id]};
+        body.position = {static_cast<float>(x) * m_quantum, static_cast<float>(y) * m_quantum};
+        body.collider = m_colliders[id];
+    }
+
+    m_cursor = static_cast<std::size_t>(in - m_chunk.data());
+    --m_framesLeft;
+    return true;
+}
@@ -0,0 +1,147 @@
+#ifndef PHYSICSENGINE_TRAJECTORYRECORDER_H
+#define PHYSICSENGINE_TRAJECTORYRECORDER_H
+
+#include <SFML/System/Vector2.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BodyStore.h"
+#include "Collider.h"
+#include "SpscQueue.h"
+
+/**
+ * Per step body positions, streamed to disk for offline analysis / replay
+ *
+ * Positions are quantized to a grid of `quantum` units and stored as the
+ * zigzag varint delta from the same body's previous frame, so a body that
+ * barely moved costs ~3 bytes. Frames are packed into fixed size chunks;
+ * every keyframeChunks-th chunk starts over from absolute values, so the
+ * file can be cut/seeked at those.
+ *
+ * Record() only encodes into the current chunk and hands full chunks to a
+ * writer thread through a lock-free queue. If the writer falls behind and
+ * no empty chunk is left, the frame is dropped (GetDroppedFrames) rather
+ * than stalling the step; the deltas are against the last frame that was
+ * kept, so the rest of the file still decodes.
+ *
+ * File: "PWTR", version, quantum, then chunks of {u32 bytes, u32 frames, data}.
+ * Frame: varint body count, f32 dt, then per body varint (id << 1 | reset),
+ * where reset bodies add varint generation, u8 collider type, f32 x 2 half
+ * extents, before the position deltas (absolute for reset bodies).
+ */
+struct TrajectoryOptions {
+    float quantum = 1.f / 64.f;          // position resolution, world units
+    std::size_t chunkBytes = 1u << 20;   // per chunk, grows once if a single frame needs more
+    std::size_t chunkCount = 8;          // chunks in flight between Record and the writer (max 63)
+    std::size_t keyframeChunks = 8;      // absolute positions every this many chunks
+};
+
+class TrajectoryRecorder {
+public:
+    static constexpr char Magic[4] = {'P', 'W', 'T', 'R'};
+    static constexpr std::uint32_t Version = 1;
+
+    explicit TrajectoryRecorder(TrajectoryOptions options = {});
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    // Starts the writer thread. false if the file can't be created.
+    bool Open(const std::string& path);
+    // Hands over the last chunk and waits for the writer to finish the file
+    void Close();
+    bool IsOpen() const { return m_writer.joinable(); }
+
+    // Once per step, from the thread that steps the world (PhysicsWorld::SetRecorder does this)
+    void Record(const BodyStore& bodies, float dt);
+
+    std::uint64_t GetRecordedFrames() const { return m_recordedFrames; }
+    std::uint64_t GetDroppedFrames() const { return m_droppedFrames; }
+
+private:
+    struct Chunk {
+        std::vector<std::uint8_t> data;
+        std::size_t used = 0;
+        std::uint32_t frames = 0;
+    };
+
+    TrajectoryOptions m_options;
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    SpscQueue<Chunk*, 64> m_full;    // Record -> writer
+    SpscQueue<Chunk*, 64> m_empty;   // writer -> Record
+    Chunk* m_current = nullptr;
+
+    std::ofstream m_file;
+    std::thread m_writer;
+    std::atomic<bool> m_closing{false};
+
+    // Per handle id, for the deltas. m_seen != m_keyframe = not written since the last keyframe.
+    std::vector<std::int32_t> m_lastX;
+    std::vector<std::int32_t> m_lastY;
+    std::vector<std::uint32_t> m_lastGeneration;
+    std::vector<std::uint32_t> m_seen;
+    std::uint32_t m_keyframe = 1;
+    std::uint64_t m_chunksStarted = 0;
+
+    std::uint64_t m_recordedFrames = 0;
+    std::uint64_t m_droppedFrames = 0;
+
+    bool StartChunk();
+    void SubmitChunk();
+    void WriterLoop();
+};
+
+// One decoded frame; bodies in the order they were recorded (dense order at the time)
+struct TrajectoryFrame {
+    struct Body {
+        BodyHandle handle;
+        sf::Vector2f position;
+        Collider collider;
+    };
+
+    float dt = 0.f;
+    std::vector<Body> bodies;
+};
+
+/**
+ * Streams a recording back one frame at a time, one chunk in memory
+ *
+ * Nothing is simulated: feed the frames straight to the renderer.
+ */
+class TrajectoryReader {
+public:
+    bool Open(const std::string& path);
+    bool IsOpen() const { return m_file.is_open(); }
+
+    // false at the end of the file (or on a damaged chunk)
+    bool NextFrame(TrajectoryFrame& frame);
+
+    // Back to the first frame
+    bool Rewind();
+
+    float GetQuantum() const { return m_quantum; }
+
+private:
+    std::ifstream m_file;
+    std::streampos m_firstChunk;
+    float m_quantum = 1.f;
+
+    std::vector<std::uint8_t> m_chunk;
+    std::size_t m_cursor = 0;
+    std::uint32_t m_framesLeft = 0;
+
+    // Per handle id, same as the recorder
+    std::vector<std::int32_t> m_lastX;
+    std::vector<std::int32_t> m_lastY;
+    std::vector<std::uint32_t> m_lastGeneration;
+    std::vector<Collider> m_colliders;
+
+    bool LoadChunk();
+};
+
+#endif //PHYSICSENGINE_TRAJECTORYRECORDER_H
@@ -0,0 +1,43 @@
+#ifndef PHYSICSENGINE_TRIPLEBUFFER_H
+#define PHYSICSENGINE_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Lock-free hand-off of the latest value from one writer to one reader
+ *
+ * Writer fills Back() then Publish()es it; reader calls Latest(). The three
+ * slots are swapped through one atomic index, so neither side ever waits and
+ * the reader always sees a complete value. Updates in between reads are
+ * skipped, not queued.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side. Holds whatever was published two swaps ago -> overwrite all of it.
+    T& Back() { return m_slots[m_back]; }
+
+    void Publish() {
+        m_back = m_middle.exchange(static_cast<std::uint8_t>(m_back | Fresh), std::memory_order_acq_rel) & IndexMask;
+    }
+
+    // Reader side. Stays valid until the next Latest() call.
+    const T& Latest() {
+        if (m_middle.load(std::memory_order_relaxed) & Fresh) {
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & IndexMask;
+        }
+        return m_slots[m_front];
+    }
+
+private:
+    static constexpr std::uint8_t IndexMask = 0x3;
+    static constexpr std::uint8_t Fresh = 0x4;   // middle holds something the reader hasn't taken
+
+    T m_slots[3];
+    std::uint8_t m_back = 0;                 // writer only
+    std::uint8_t m_front = 2;                // reader only
+    std::atomic<std::uint8_t> m_middle{1};
+};
+
+#endif //PHYSICSENGINE_TRIPLEBUFFER_H
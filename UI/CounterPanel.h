@@ -3,12 +3,15 @@
 
 #include <SFML/Graphics.hpp>
 #include <sstream>
+#include <limits>
 
 class CounterPanel : public sf::Drawable {
 private:
     sf::Text m_text;
     sf::RectangleShape m_box;
     float m_windowWidth;
+    size_t m_shownBalls = std::numeric_limits<size_t>::max();   // nothing shown yet
+    size_t m_shownFloors = 0;
     
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
         target.draw(m_box, states);
@@ -25,7 +28,12 @@ public:
         m_box.setOutlineThickness(1.f);
     }
     
+    // Only re-lays out the text when a count changed
     void update(size_t ballCount, size_t floorCount) {
+        if (ballCount == m_shownBalls && floorCount == m_shownFloors) return;
+        m_shownBalls = ballCount;
+        m_shownFloors = floorCount;
+
         size_t total = ballCount + floorCount;
         
         std::ostringstream ss;
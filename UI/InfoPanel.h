@@ -2,8 +2,8 @@
 #define PHYSICSENGINE_INFOPANEL_H
 
 #include <SFML/Graphics.hpp>
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
+#include <string>
 #include <cmath>
 #include "../Object.h"
 
@@ -12,6 +12,7 @@ private:
     sf::Text m_text;
     sf::RectangleShape m_box;
     bool m_visible = false;
+    std::string m_shownText;
     
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
         if (m_visible) {
@@ -37,20 +38,25 @@ public:
             return;
         }
         
+        // Verlet displacement per step, shown per 60th of a second like before
+        update(obj->position, (obj->position - obj->oldPosition) * 60.f, obj->mass, radius);
+    }
+
+    // Same, from plain values (e.g. a PhysicsThread snapshot)
+    void update(sf::Vector2f position, sf::Vector2f vel, float mass, float radius) {
         m_visible = true;
         
-        sf::Vector2f vel = obj->position - obj->oldPosition;
-        float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y) * 60.f;
+        float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y);
         
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(1);
-        ss << "Position: (" << obj->position.x << ", " << obj->position.y << ")\n";
-        ss << "Velocity: (" << vel.x * 60.f << ", " << vel.y * 60.f << ")\n";
-        ss << "Speed: " << speed << " px/s\n";
-        ss << "Mass: " << obj->mass << "\n";
-        ss << "Radius: " << radius;
-        
-        m_text.setString(ss.str());
+        char buffer[192];
+        std::snprintf(buffer, sizeof(buffer),
+                      "Position: (%.1f, %.1f)\nVelocity: (%.1f, %.1f)\nSpeed: %.1f px/s\nMass: %.1f\nRadius: %.1f",
+                      position.x, position.y, vel.x, vel.y, speed, mass, radius);
+
+        // A resting ball shows the same numbers every frame, skip the re-layout then
+        if (m_shownText == buffer) return;
+        m_shownText = buffer;
+        m_text.setString(m_shownText);
         
         sf::FloatRect textBounds = m_text.getLocalBounds();
         m_box.setSize({textBounds.size.x + 20.f, textBounds.size.y + 20.f});
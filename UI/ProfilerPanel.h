@@ -0,0 +1,187 @@
+#ifndef PHYSICSENGINE_PROFILERPANEL_H
+#define PHYSICSENGINE_PROFILERPANEL_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../PhysicsStats.h"
+
+/**
+ * Frame time graph + stacked bar of the average Step's phases
+ *
+ * Frame times go in a ring buffer here; the per-phase numbers come from
+ * PhysicsWorld::GetStats(). Text and geometry are only rebuilt when the
+ * value they show actually changed, and nothing is rebuilt while hidden.
+ */
+class ProfilerPanel : public sf::Drawable {
+private:
+    static constexpr std::size_t HistorySize = 120;
+    static constexpr float Width = 260.f;
+    static constexpr float GraphHeight = 60.f;
+    static constexpr float BarHeight = 14.f;
+    static constexpr float Padding = 8.f;
+
+    sf::RectangleShape m_box;
+    sf::VertexArray m_graph;        // line strip, one vertex per frame
+    sf::VertexArray m_budgetLine;   // 16.7 ms marker
+    sf::VertexArray m_bar;          // quads as triangles, one per phase
+    sf::Text m_text;
+    sf::Vector2f m_position;
+    bool m_visible = false;
+
+    std::vector<float> m_frameMs;   // ring buffer
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    bool m_graphDirty = true;
+
+    std::string m_shownText;
+    float m_shownPhaseMs[StepStats::PhaseCount] = {};
+    float m_graphScaleMs = 33.3f;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
+        if (!m_visible) return;
+        target.draw(m_box, states);
+        target.draw(m_budgetLine, states);
+        target.draw(m_graph, states);
+        target.draw(m_bar, states);
+        target.draw(m_text, states);
+    }
+
+    static sf::Color PhaseColor(std::size_t phase) {
+        static const sf::Color colors[StepStats::PhaseCount] = {
+            sf::Color(100, 200, 100),   // integrate
+            sf::Color(220, 180, 80),    // constraints
+            sf::Color(100, 160, 230),   // broadphase
+            sf::Color(200, 110, 200),   // narrowphase
+            sf::Color(220, 120, 100),   // resolve
+            sf::Color(150, 150, 160),   // sleep
+            sf::Color(90, 200, 200),    // record
+            sf::Color(230, 230, 110),   // reorder
+        };
+        return colors[phase];
+    }
+
+    void RebuildGraph() {
+        const float left = m_position.x + Padding;
+        const float bottom = m_position.y + Padding + GraphHeight;
+        const float dx = (Width - 2.f * Padding) / static_cast<float>(HistorySize - 1);
+
+        // Oldest sample on the left
+        m_graph.resize(m_count);
+        for (std::size_t i = 0; i < m_count; ++i) {
+            const std::size_t slot = (m_next + HistorySize - m_count + i) % HistorySize;
+            const float h = std::min(m_frameMs[slot] / m_graphScaleMs, 1.f) * GraphHeight;
+            m_graph[i].position = {left + (HistorySize - m_count + i) * dx, bottom - h};
+            m_graph[i].color = m_frameMs[slot] > 16.7f ? sf::Color(230, 90, 90) : sf::Color(120, 220, 140);
+        }
+
+        const float budgetY = bottom - 16.7f / m_graphScaleMs * GraphHeight;
+        m_budgetLine[0].position = {left, budgetY};
+        m_budgetLine[1].position = {m_position.x + Width - Padding, budgetY};
+        m_graphDirty = false;
+    }
+
+    void RebuildBar(const StepStats& avg) {
+        const float left = m_position.x + Padding;
+        const float top = m_position.y + 2.f * Padding + GraphHeight;
+        const float width = Width - 2.f * Padding;
+
+        double total = 0.0;
+        for (double ms : avg.phaseMs) total += ms;
+
+        float x = left;
+        for (std::size_t p = 0; p < StepStats::PhaseCount; ++p) {
+            const float w = total > 0.0 ? static_cast<float>(avg.phaseMs[p] / total) * width : 0.f;
+            const sf::Color color = PhaseColor(p);
+            const sf::Vector2f corners[6] = {
+                {x, top}, {x + w, top}, {x, top + BarHeight},
+                {x + w, top}, {x + w, top + BarHeight}, {x, top + BarHeight}};
+            for (std::size_t k = 0; k < 6; ++k) {
+                m_bar[p * 6 + k].position = corners[k];
+                m_bar[p * 6 + k].color = color;
+            }
+            x += w;
+            m_shownPhaseMs[p] = static_cast<float>(avg.phaseMs[p]);
+        }
+    }
+
+    void RebuildText(const std::string& text) {
+        m_shownText = text;
+        m_text.setString(text);
+        sf::FloatRect bounds = m_text.getLocalBounds();
+        m_box.setSize({Width, 3.f * Padding + GraphHeight + BarHeight + bounds.size.y + Padding * 2.f});
+    }
+
+public:
+    ProfilerPanel(const sf::Font& font, sf::Vector2f position)
+        : m_graph(sf::PrimitiveType::LineStrip),
+          m_budgetLine(sf::PrimitiveType::Lines, 2),
+          m_bar(sf::PrimitiveType::Triangles, StepStats::PhaseCount * 6),
+          m_text(font, "", 12),
+          m_position(position),
+          m_frameMs(HistorySize, 0.f) {
+        m_box.setFillColor(sf::Color(20, 25, 40, 220));
+        m_box.setOutlineColor(sf::Color(80, 90, 120));
+        m_box.setOutlineThickness(1.f);
+        m_box.setPosition(position);
+        m_box.setSize({Width, GraphHeight + BarHeight + 3.f * Padding});
+
+        m_budgetLine[0].color = sf::Color(80, 90, 120);
+        m_budgetLine[1].color = sf::Color(80, 90, 120);
+
+        m_text.setFillColor(sf::Color::White);
+        m_text.setPosition({position.x + Padding, position.y + 3.f * Padding + GraphHeight + BarHeight});
+    }
+
+    // Call once per frame. Only the ring buffer is touched while hidden.
+    void update(const PhysicsStats& stats, float frameMs, int stepsThisFrame) {
+        update(stats.Average(), frameMs, stepsThisFrame);
+    }
+
+    // Same, from an already averaged StepStats (e.g. a PhysicsThread snapshot)
+    void update(const StepStats& avg, float frameMs, int stepsThisFrame) {
+        m_frameMs[m_next] = frameMs;
+        m_next = (m_next + 1) % HistorySize;
+        m_count = std::min(m_count + 1, HistorySize);
+        m_graphDirty = true;
+
+        if (!m_visible) return;
+        RebuildGraph();
+
+        if (!PhysicsStats::Enabled) {
+            if (m_shownText.empty()) RebuildText("stats compiled out (PHYSICS_STATS=OFF)");
+            return;
+        }
+
+        bool barChanged = false;
+        for (std::size_t p = 0; p < StepStats::PhaseCount; ++p) {
+            // 1 us resolution is plenty for a 250 px bar
+            if (static_cast<int>(avg.phaseMs[p] * 1000.0) != static_cast<int>(m_shownPhaseMs[p] * 1000.f)) barChanged = true;
+        }
+        if (barChanged) RebuildBar(avg);
+
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+                      "frame %.1f ms  steps %d  step %.3f ms\n"
+                      "integ %.3f  constr %.3f  broad %.3f\n"
+                      "narrow %.3f  resolve %.3f  sleep %.3f\n"
+                      "record %.3f  reorder %.3f  pairs %u  contacts %u\n"
+                      "skipped %u  swept %u",
+                      frameMs, stepsThisFrame, avg.totalMs,
+                      avg.PhaseMs(StepPhase::Integrate), avg.PhaseMs(StepPhase::Constraints),
+                      avg.PhaseMs(StepPhase::Broadphase), avg.PhaseMs(StepPhase::Narrowphase),
+                      avg.PhaseMs(StepPhase::Resolve), avg.PhaseMs(StepPhase::Sleep),
+                      avg.PhaseMs(StepPhase::Record), avg.PhaseMs(StepPhase::Reorder), avg.pairsTested, avg.contactsFound, avg.bodiesSkipped, avg.bodiesSwept);
+        if (m_shownText != buffer) RebuildText(buffer);
+    }
+
+    void toggle() {
+        m_visible = !m_visible;
+        if (m_visible && m_graphDirty) RebuildGraph();
+    }
+    bool isVisible() const { return m_visible; }
+};
+
+#endif //PHYSICSENGINE_PROFILERPANEL_H
@@ -0,0 +1,135 @@
+#include "VerletKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define PHYSICS_VERLET_NEON 1
+#elif defined(__AVX__)
+    #include <immintrin.h>
+    #define PHYSICS_VERLET_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PHYSICS_VERLET_SSE2 1
+#endif
+
+static_assert(sizeof(sf::Vector2f) == 2 * sizeof(float), "kernels treat body arrays as flat floats");
+
+const char* VerletKernelName() {
+#if defined(PHYSICS_VERLET_NEON)
+    return "neon";
+#elif defined(PHYSICS_VERLET_AVX)
+    return "avx";
+#elif defined(PHYSICS_VERLET_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void IntegrateVerletScalar(sf::Vector2f* positions, sf::Vector2f* oldPositions, sf::Vector2f* accelerations,
+                           const std::uint8_t* isStatic, std::size_t count, sf::Vector2f gravity, float dt) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (isStatic[i]) continue;
+
+        accelerations[i] = gravity;
+        sf::Vector2f temp = positions[i];
+
+        // Verlet: newPos = pos + (pos - oldPos) + accel * dt^2
+        sf::Vector2f velocity = positions[i] - oldPositions[i];
+        positions[i] = positions[i] + velocity + accelerations[i] * dt * dt;
+        oldPositions[i] = temp;
+    }
+}
+
+// Same op order as the scalar loop everywhere below, so results match bit for bit
+void IntegrateVerlet(sf::Vector2f* positions, sf::Vector2f* oldPositions, sf::Vector2f* accelerations,
+                     const std::uint8_t* isStatic, std::size_t count, sf::Vector2f gravity, float dt) {
+    float* pos = reinterpret_cast<float*>(positions);
+    float* old = reinterpret_cast<float*>(oldPositions);
+    float* acc = reinterpret_cast<float*>(accelerations);
+    std::size_t i = 0;
+
+#if defined(PHYSICS_VERLET_NEON)
+    // 2 bodies per q register, 2 registers per iteration
+    const float32x4_t g = {gravity.x, gravity.y, gravity.x, gravity.y};
+    const float32x4_t vdt = vdupq_n_f32(dt);
+
+    for (; i + 4 <= count; i += 4) {
+        for (std::size_t half = 0; half < 4; half += 2) {
+            const std::size_t body = i + half;
+            // all ones for static lanes
+            const uint32x4_t mask = vcombine_u32(vdup_n_u32(0u - isStatic[body]),
+                                                 vdup_n_u32(0u - isStatic[body + 1]));
+
+            float32x4_t p = vld1q_f32(pos + body * 2);
+            float32x4_t o = vld1q_f32(old + body * 2);
+            float32x4_t a = vbslq_f32(mask, vld1q_f32(acc + body * 2), g);
+
+            float32x4_t v = vsubq_f32(p, o);
+            float32x4_t step = vmulq_f32(vmulq_f32(a, vdt), vdt);
+            float32x4_t next = vaddq_f32(vaddq_f32(p, v), step);
+
+            vst1q_f32(acc + body * 2, a);
+            vst1q_f32(pos + body * 2, vbslq_f32(mask, p, next));
+            vst1q_f32(old + body * 2, vbslq_f32(mask, o, p));
+        }
+    }
+#elif defined(PHYSICS_VERLET_AVX)
+    // 4 bodies per register
+    const __m256 g = _mm256_setr_ps(gravity.x, gravity.y, gravity.x, gravity.y,
+                                    gravity.x, gravity.y, gravity.x, gravity.y);
+    const __m256 vdt = _mm256_set1_ps(dt);
+
+    for (; i + 4 <= count; i += 4) {
+        const int s0 = -static_cast<int>(isStatic[i]);
+        const int s1 = -static_cast<int>(isStatic[i + 1]);
+        const int s2 = -static_cast<int>(isStatic[i + 2]);
+        const int s3 = -static_cast<int>(isStatic[i + 3]);
+        const __m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(s0, s0, s1, s1, s2, s2, s3, s3));
+
+        __m256 p = _mm256_loadu_ps(pos + i * 2);
+        __m256 o = _mm256_loadu_ps(old + i * 2);
+        __m256 a = _mm256_blendv_ps(g, _mm256_loadu_ps(acc + i * 2), mask);
+
+        __m256 v = _mm256_sub_ps(p, o);
+        __m256 step = _mm256_mul_ps(_mm256_mul_ps(a, vdt), vdt);
+        __m256 next = _mm256_add_ps(_mm256_add_ps(p, v), step);
+
+        _mm256_storeu_ps(acc + i * 2, a);
+        _mm256_storeu_ps(pos + i * 2, _mm256_blendv_ps(next, p, mask));
+        _mm256_storeu_ps(old + i * 2, _mm256_blendv_ps(p, o, mask));
+    }
+#elif defined(PHYSICS_VERLET_SSE2)
+    // 2 bodies per register, 2 registers per iteration
+    const __m128 g = _mm_setr_ps(gravity.x, gravity.y, gravity.x, gravity.y);
+    const __m128 vdt = _mm_set1_ps(dt);
+
+    // mask ? a : b, SSE2 has no blend
+    auto select = [](__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        for (std::size_t half = 0; half < 4; half += 2) {
+            const std::size_t body = i + half;
+            const int s0 = -static_cast<int>(isStatic[body]);
+            const int s1 = -static_cast<int>(isStatic[body + 1]);
+            const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(s0, s0, s1, s1));
+
+            __m128 p = _mm_loadu_ps(pos + body * 2);
+            __m128 o = _mm_loadu_ps(old + body * 2);
+            __m128 a = select(mask, _mm_loadu_ps(acc + body * 2), g);
+
+            __m128 v = _mm_sub_ps(p, o);
+            __m128 step = _mm_mul_ps(_mm_mul_ps(a, vdt), vdt);
+            __m128 next = _mm_add_ps(_mm_add_ps(p, v), step);
+
+            _mm_storeu_ps(acc + body * 2, a);
+            _mm_storeu_ps(pos + body * 2, select(mask, p, next));
+            _mm_storeu_ps(old + body * 2, select(mask, o, p));
+        }
+    }
+#endif
+
+    // Tail (or everything, without SIMD)
+    IntegrateVerletScalar(positions + i, oldPositions + i, accelerations + i, isStatic + i, count - i, gravity, dt);
+}
@@ -0,0 +1,30 @@
+#ifndef PHYSICSENGINE_VERLETKERNELS_H
+#define PHYSICSENGINE_VERLETKERNELS_H
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Gravity + Verlet integration over the body arrays in one pass
+ *
+ * Static bodies are masked out instead of branched around, so the loop is
+ * straight line code. Picks NEON / AVX / SSE2 at compile time and falls back
+ * to the scalar loop (also used for the leftover tail).
+ *
+ * The arrays keep sf::Vector2f's interleaved x,y layout: a 4 wide register
+ * holds 2 bodies, AVX holds 4. Both components get the same math, so this
+ * costs nothing compared to splitting x and y.
+ */
+
+// Which path IntegrateVerlet() was compiled with ("avx", "sse2", "neon", "scalar")
+const char* VerletKernelName();
+
+void IntegrateVerlet(sf::Vector2f* positions, sf::Vector2f* oldPositions, sf::Vector2f* accelerations,
+                     const std::uint8_t* isStatic, std::size_t count, sf::Vector2f gravity, float dt);
+
+// Reference version, one body at a time
+void IntegrateVerletScalar(sf::Vector2f* positions, sf::Vector2f* oldPositions, sf::Vector2f* accelerations,
+                           const std::uint8_t* isStatic, std::size_t count, sf::Vector2f gravity, float dt);
+
+#endif //PHYSICSENGINE_VERLETKERNELS_H
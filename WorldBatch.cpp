@@ -0,0 +1,55 @@
+#include "WorldBatch.h"
+
+WorldBatch::WorldBatch(unsigned threads)
+    : m_pool(std::make_unique<ThreadPool>(threads)) {}
+
+PhysicsWorld& WorldBatch::AddWorld() {
+    m_worlds.push_back(std::make_unique<PhysicsWorld>());
+    m_worlds.back()->SetThreadCount(1);   // no pool per world, nothing nests
+    return *m_worlds.back();
+}
+
+void WorldBatch::Clear() {
+    m_worlds.clear();
+    m_taskStart.clear();
+}
+
+void WorldBatch::SetThreadCount(unsigned threads) {
+    m_pool = std::make_unique<ThreadPool>(threads);
+}
+
+// Consecutive worlds until the task has m_packBodies bodies; a big world closes
+// the current task and gets its own
+void WorldBatch::BuildTasks() {
+    m_taskStart.clear();
+    std::size_t bodies = 0;
+    for (std::size_t i = 0; i < m_worlds.size(); ++i) {
+        const std::size_t count = m_worlds[i]->GetBodyCount();
+        if (m_taskStart.empty() || bodies + count > m_packBodies) {
+            m_taskStart.push_back(i);
+            bodies = 0;
+        }
+        bodies += count;
+    }
+    m_taskStart.push_back(m_worlds.size());
+}
+
+template <typename Fn>
+void WorldBatch::RunTasks(Fn&& stepWorld) {
+    BuildTasks();
+    m_pool->ParallelForStealing(GetTaskCount(), [this, &stepWorld](unsigned, std::size_t task) {
+        for (std::size_t i = m_taskStart[task]; i < m_taskStart[task + 1]; ++i) stepWorld(*m_worlds[i]);
+    });
+}
+
+void WorldBatch::Step(float dt, int steps) {
+    RunTasks([dt, steps](PhysicsWorld& world) {
+        for (int s = 0; s < steps; ++s) world.Step(dt);
+    });
+}
+
+void WorldBatch::Update(float frameDt, int frames) {
+    RunTasks([frameDt, frames](PhysicsWorld& world) {
+        for (int f = 0; f < frames; ++f) world.Update(frameDt);
+    });
+}
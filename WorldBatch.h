@@ -0,0 +1,66 @@
+#ifndef PHYSICSENGINE_WORLDBATCH_H
+#define PHYSICSENGINE_WORLDBATCH_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "PhysicsWorld.h"
+#include "ThreadPool.h"
+
+/**
+ * Many small independent worlds (parameter sweeps) stepped together
+ *
+ * The batch owns the threads: every world in it is single threaded, and a
+ * task runs all of a Step()'s steps for its worlds back to back, while the
+ * world's columns are still in cache. Worlds under PackBodies bodies are
+ * grouped into one task so a thousand 20 body worlds don't cost a thousand
+ * scheduling round trips; big worlds get a task each. Tasks are spread by
+ * ThreadPool::ParallelForStealing, so a few heavy worlds don't leave the
+ * other threads idle.
+ *
+ * Worlds don't share anything, so each one ends up exactly where it would
+ * stepping on its own, whatever the thread count. Read the results straight
+ * off GetWorld(i).
+ */
+class WorldBatch {
+public:
+    // threads = total, counting the caller (0 = one per core)
+    explicit WorldBatch(unsigned threads = 0);
+
+    // New empty world, set to one thread; leave it at that, the batch is the parallelism.
+    // References stay valid until Clear().
+    PhysicsWorld& AddWorld();
+    void Clear();
+
+    std::size_t GetWorldCount() const { return m_worlds.size(); }
+    PhysicsWorld& GetWorld(std::size_t index) { return *m_worlds[index]; }
+    const PhysicsWorld& GetWorld(std::size_t index) const { return *m_worlds[index]; }
+
+    // Every world takes `steps` Steps of dt
+    void Step(float dt, int steps = 1);
+    // Every world gets `frames` Update(frameDt) calls (its own fixed/adaptive timestep)
+    void Update(float frameDt, int frames = 1);
+
+    // Small worlds are packed into tasks of about this many bodies
+    static constexpr std::size_t DefaultPackBodies = 2048;
+    void SetPackBodies(std::size_t bodies) { m_packBodies = bodies > 0 ? bodies : 1; }
+    std::size_t GetPackBodies() const { return m_packBodies; }
+
+    void SetThreadCount(unsigned threads);
+    unsigned GetThreadCount() const { return m_pool->GetThreadCount(); }
+    std::size_t GetTaskCount() const { return m_taskStart.empty() ? 0 : m_taskStart.size() - 1; }   // last Step/Update
+
+private:
+    std::vector<std::unique_ptr<PhysicsWorld>> m_worlds;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::size_t m_packBodies = DefaultPackBodies;
+
+    // Task k = worlds [m_taskStart[k], m_taskStart[k + 1])
+    std::vector<std::size_t> m_taskStart;
+
+    void BuildTasks();
+    template <typename Fn>
+    void RunTasks(Fn&& stepWorld);
+};
+
+#endif //PHYSICSENGINE_WORLDBATCH_H
@@ -0,0 +1,311 @@
+#include "WorldSnapshot.h"
+#include "PhysicsWorld.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+    #include <iterator>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace WorldSnapshot;
+
+namespace {
+
+constexpr std::uint64_t Alignment = 16;
+
+std::uint64_t AlignUp(std::uint64_t offset) {
+    return (offset + Alignment - 1) & ~(Alignment - 1);
+}
+
+std::size_t ElementSize(SectionId id) {
+    switch (id) {
+        case SectionId::Positions:
+        case SectionId::OldPositions:
+        case SectionId::Accelerations:
+        case SectionId::PreviousPositions: return sizeof(sf::Vector2f);
+        case SectionId::Masses:
+        case SectionId::Bounciness:        return sizeof(float);
+        case SectionId::IsStatic:
+        case SectionId::Asleep:            return sizeof(std::uint8_t);
+        case SectionId::Colliders:         return sizeof(Collider);
+        case SectionId::RestSteps:         return sizeof(std::uint16_t);
+        case SectionId::Islands:
+        case SectionId::Ids:
+        case SectionId::FreeIds:           return sizeof(std::uint32_t);
+        case SectionId::Slots:             return sizeof(BodyStore::Slot);
+        case SectionId::Distance:          return sizeof(DistanceRecord);
+        case SectionId::Springs:           return sizeof(SpringRecord);
+        case SectionId::Pins:              return sizeof(PinRecord);
+        case SectionId::Count:             break;
+    }
+    return 0;
+}
+
+// Whole file, read only. mmap where there is one, so loading touches each page once.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return;
+        m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_data = reinterpret_cast<const unsigned char*>(m_buffer.data());
+        m_size = m_buffer.size();
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info{};
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                m_data = static_cast<const unsigned char*>(mapped);
+                m_size = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        ::close(fd);   // the mapping stays valid
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (m_data) ::munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    std::size_t m_size = 0;
+#if defined(_WIN32)
+    std::vector<char> m_buffer;
+#endif
+};
+
+template <typename T>
+void ReadSection(const MappedFile& file, const Section& section, std::vector<T>& out) {
+    out.resize(static_cast<std::size_t>(section.count));
+    if (section.count > 0) std::memcpy(out.data(), file.Data() + section.offset, out.size() * sizeof(T));
+}
+
+}  // namespace
+
+bool PhysicsWorld::SaveSnapshot(const std::string& path) const {
+    // Constraints as handle records, in slot order
+    std::vector<DistanceRecord> distance;
+    std::vector<SpringRecord> springs;
+    std::vector<PinRecord> pins;
+    distance.reserve(m_constraints.distance.Size());
+    springs.reserve(m_constraints.springs.Size());
+    pins.reserve(m_constraints.pins.Size());
+    m_constraints.distance.ForEach([&](const DistanceConstraint& c) {
+        distance.push_back({c.bodyA, c.bodyB, c.restLength, c.stiffness, c.compliance});
+    });
+    m_constraints.springs.ForEach([&](const SpringConstraint& c) {
+        springs.push_back({c.bodyA, c.bodyB, c.restLength, c.stiffness, c.damping});
+    });
+    m_constraints.pins.ForEach([&](const PinConstraint& c) { pins.push_back({c.body, c.anchor}); });
+
+    struct Source {
+        const void* data;
+        std::size_t count;
+    };
+    const Source sources[static_cast<std::size_t>(SectionId::Count)] = {
+        {m_bodies.positions.data(), m_bodies.positions.size()},
+        {m_bodies.oldPositions.data(), m_bodies.oldPositions.size()},
+        {m_bodies.accelerations.data(), m_bodies.accelerations.size()},
+        {m_bodies.previousPositions.data(), m_bodies.previousPositions.size()},
+        {m_bodies.masses.data(), m_bodies.masses.size()},
+        {m_bodies.bounciness.data(), m_bodies.bounciness.size()},
+        {m_bodies.isStatic.data(), m_bodies.isStatic.size()},
+        {m_bodies.colliders.data(), m_bodies.colliders.size()},
+        {m_bodies.asleep.data(), m_bodies.asleep.size()},
+        {m_bodies.restSteps.data(), m_bodies.restSteps.size()},
+        {m_bodies.islands.data(), m_bodies.islands.size()},
+        {m_bodies.GetSlots().data(), m_bodies.GetSlots().size()},
+        {m_bodies.GetIds().data(), m_bodies.GetIds().size()},
+        {m_bodies.GetFreeIds().data(), m_bodies.GetFreeIds().size()},
+        {distance.data(), distance.size()},
+        {springs.data(), springs.size()},
+        {pins.data(), pins.size()},
+    };
+
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.sectionCount = static_cast<std::uint32_t>(SectionId::Count);
+    header.gravity = m_gravity;
+    header.constraintIterations = m_constraintIterations;
+    header.contactIterations = m_contactIterations;
+    header.solverMode = static_cast<std::uint32_t>(m_solverMode);
+    header.jacobiRelaxation = m_jacobiRelaxation;
+    header.xpbdEnabled = m_xpbdEnabled ? 1u : 0u;
+    header.constraintTolerance = m_constraintTolerance;
+    header.adaptiveSubsteps = m_adaptiveSubsteps ? 1u : 0u;
+    header.substeps = m_substeps;
+    header.minSubsteps = m_minSubsteps;
+    header.maxSubsteps = m_maxSubsteps;
+    header.substepFrame = m_substepFrame;
+    header.substepMotion = m_substepMotion;
+    header.substepPenetration = m_substepPenetration;
+    header.ccdEnabled = m_ccdEnabled ? 1u : 0u;
+    header.ccdThreshold = m_ccdThreshold;
+    header.reorderInterval = m_reorderInterval;
+    header.stepsSinceReorder = m_stepsSinceReorder;
+    header.fixedStep = m_fixedStep;
+    header.maxSteps = m_maxSteps;
+    header.accumulator = m_accumulator;
+    header.sleepEnabled = m_sleepEnabled ? 1u : 0u;
+    header.sleepSpeed = m_sleepSpeed;
+    header.sleepSteps = m_sleepSteps;
+
+    std::uint64_t offset = AlignUp(sizeof(Header));
+    for (std::size_t s = 0; s < static_cast<std::size_t>(SectionId::Count); ++s) {
+        header.sections[s] = {offset, sources[s].count};
+        offset = AlignUp(offset + sources[s].count * ElementSize(static_cast<SectionId>(s)));
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    static constexpr char Padding[Alignment] = {};
+    std::uint64_t written = 0;
+    auto write = [&](const void* data, std::uint64_t bytes) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    };
+    auto pad = [&]() { write(Padding, AlignUp(written) - written); };
+
+    write(&header, sizeof(header));
+    for (std::size_t s = 0; s < static_cast<std::size_t>(SectionId::Count); ++s) {
+        pad();
+        write(sources[s].data, sources[s].count * ElementSize(static_cast<SectionId>(s)));
+    }
+    return static_cast<bool>(file.flush());
+}
+
+bool PhysicsWorld::LoadSnapshot(const std::string& path) {
+    MappedFile file(path);
+    if (!file.Data() || file.Size() < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+        header.byteOrder != ByteOrderMark || header.sectionCount != static_cast<std::uint32_t>(SectionId::Count)) {
+        return false;
+    }
+
+    // Every section inside the file, body columns all the same length
+    const std::uint64_t bodyCount = header.sections[static_cast<std::size_t>(SectionId::Positions)].count;
+    for (std::size_t s = 0; s < static_cast<std::size_t>(SectionId::Count); ++s) {
+        const Section& section = header.sections[s];
+        const std::uint64_t elementSize = ElementSize(static_cast<SectionId>(s));
+        if (section.offset > file.Size() || section.count > (file.Size() - section.offset) / elementSize) return false;
+        if (s <= static_cast<std::size_t>(SectionId::Islands) && section.count != bodyCount) return false;
+    }
+    auto section = [&](SectionId id) -> const Section& { return header.sections[static_cast<std::size_t>(id)]; };
+
+    // Build the new body storage on the side, so a bad file leaves the world alone
+    BodyStore bodies;
+    ReadSection(file, section(SectionId::Positions), bodies.positions);
+    ReadSection(file, section(SectionId::OldPositions), bodies.oldPositions);
+    ReadSection(file, section(SectionId::Accelerations), bodies.accelerations);
+    ReadSection(file, section(SectionId::PreviousPositions), bodies.previousPositions);
+    ReadSection(file, section(SectionId::Masses), bodies.masses);
+    ReadSection(file, section(SectionId::Bounciness), bodies.bounciness);
+    ReadSection(file, section(SectionId::IsStatic), bodies.isStatic);
+    ReadSection(file, section(SectionId::Colliders), bodies.colliders);
+    ReadSection(file, section(SectionId::Asleep), bodies.asleep);
+    ReadSection(file, section(SectionId::RestSteps), bodies.restSteps);
+    ReadSection(file, section(SectionId::Islands), bodies.islands);
+    bodies.linked.assign(static_cast<std::size_t>(bodyCount), nullptr);
+    bodies.fixed.assign(static_cast<std::size_t>(bodyCount), 0);   // RebuildSleepLists fills it in
+
+    for (const Collider& collider : bodies.colliders) {
+        if (collider.type != ColliderType::None && collider.type != ColliderType::Circle &&
+            collider.type != ColliderType::AABB) {
+            return false;
+        }
+    }
+
+    std::vector<BodyStore::Slot> slots;
+    std::vector<std::uint32_t> ids, freeIds;
+    ReadSection(file, section(SectionId::Slots), slots);
+    ReadSection(file, section(SectionId::Ids), ids);
+    ReadSection(file, section(SectionId::FreeIds), freeIds);
+    if (!bodies.RestoreHandles(slots, ids, freeIds)) return false;
+
+    // Past this point the file is good, swap everything in
+    for (Object* obj : m_bodies.linked) {
+        if (obj) obj->body = BodyHandle{};   // their bodies are gone
+    }
+    m_bodies = std::move(bodies);
+    m_linkedCount = 0;
+    m_sleepingCount = static_cast<std::size_t>(std::count(m_bodies.asleep.begin(), m_bodies.asleep.end(), 1));
+    RebuildSleepLists();
+
+    std::vector<DistanceRecord> distance;
+    std::vector<SpringRecord> springs;
+    std::vector<PinRecord> pins;
+    ReadSection(file, section(SectionId::Distance), distance);
+    ReadSection(file, section(SectionId::Springs), springs);
+    ReadSection(file, section(SectionId::Pins), pins);
+
+    // Straight into the pools, block by block
+    m_constraints.Clear();
+    m_constraints.Assign<DistanceConstraint>(distance.size(), [&](std::size_t i) {
+        const DistanceRecord& r = distance[i];
+        DistanceConstraint c(r.a, r.b, r.restLength, r.stiffness);
+        c.compliance = r.compliance;
+        return c;
+    });
+    m_constraints.Assign<SpringConstraint>(springs.size(), [&](std::size_t i) {
+        const SpringRecord& r = springs[i];
+        return SpringConstraint(r.a, r.b, r.restLength, r.stiffness, r.damping);
+    });
+    m_constraints.Assign<PinConstraint>(pins.size(), [&](std::size_t i) { return PinConstraint(pins[i].body, pins[i].anchor); });
+
+    m_gravity = header.gravity;
+    m_constraintIterations = header.constraintIterations;
+    m_contactIterations = std::max(1, header.contactIterations);
+    m_solverMode = header.solverMode <= static_cast<std::uint32_t>(ConstraintSolverMode::Jacobi)
+        ? static_cast<ConstraintSolverMode>(header.solverMode) : ConstraintSolverMode::Sequential;
+    m_jacobiRelaxation = header.jacobiRelaxation > 0.f ? header.jacobiRelaxation : m_jacobiRelaxation;
+    m_xpbdEnabled = header.xpbdEnabled != 0;
+    m_constraintTolerance = std::max(0.f, header.constraintTolerance);
+    m_adaptiveSubsteps = header.adaptiveSubsteps != 0;
+    m_minSubsteps = std::max(1, header.minSubsteps);
+    m_maxSubsteps = std::max(m_minSubsteps, header.maxSubsteps);
+    m_substeps = std::clamp(header.substeps, m_minSubsteps, m_maxSubsteps);
+    m_substepFrame = header.substepFrame > 0.f ? header.substepFrame : m_substepFrame;
+    SetSubstepTargets(header.substepMotion, header.substepPenetration);
+    SetContinuousCollision(header.ccdEnabled != 0, header.ccdThreshold);
+    SetSpatialReorder(header.reorderInterval);
+    m_stepsSinceReorder = std::max(0, header.stepsSinceReorder);
+    m_fixedStep = header.fixedStep > 0.f ? header.fixedStep : m_fixedStep;
+    m_maxSteps = std::max(1, header.maxSteps);
+    m_accumulator = std::clamp(header.accumulator, 0.f, m_fixedStep);
+    m_sleepEnabled = header.sleepEnabled != 0;
+    m_sleepSpeed = header.sleepSpeed;
+    m_sleepSteps = header.sleepSteps;
+
+    // Nothing derived from the old bodies is any good now
+    m_contacts.clear();
+    m_pairs.clear();
+    m_broadphase->Reset();
+    m_staticDirty = true;
+    m_queryStale = true;
+    m_stats.Clear();
+    return true;
+}
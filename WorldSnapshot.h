@@ -0,0 +1,121 @@
+#ifndef PHYSICSENGINE_WORLDSNAPSHOT_H
+#define PHYSICSENGINE_WORLDSNAPSHOT_H
+
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <type_traits>
+#include "BodyStore.h"
+#include "Collider.h"
+
+/**
+ * On disk layout of PhysicsWorld::SaveSnapshot / LoadSnapshot
+ *
+ * One Header, then every array back to back (each starts on a 16 byte
+ * boundary), in native byte order. The header has the byte offset and
+ * element count of each array, so loading is a bounds check per section
+ * plus one memcpy into the matching BodyStore column.
+ *
+ * Bump Version whenever anything in here changes shape; old files are
+ * rejected rather than misread.
+ */
+namespace WorldSnapshot {
+
+constexpr char Magic[4] = {'P', 'W', 'S', 'N'};
+constexpr std::uint32_t Version = 6;   // 2: jacobiRelaxation, 3: XPBD compliance + tolerance, 4: substeps, 5: CCD, 6: reorder
+constexpr std::uint32_t ByteOrderMark = 0x01020304u;   // reads back different on the other endianness
+
+enum class SectionId : std::uint32_t {
+    Positions,
+    OldPositions,
+    Accelerations,
+    PreviousPositions,
+    Masses,
+    Bounciness,
+    IsStatic,
+    Colliders,
+    Asleep,
+    RestSteps,
+    Islands,
+    Slots,            // BodyStore handle tables
+    Ids,
+    FreeIds,
+    Distance,         // constraint records below
+    Springs,
+    Pins,
+    Count
+};
+
+struct Section {
+    std::uint64_t offset = 0;   // from the start of the file
+    std::uint64_t count = 0;    // elements, not bytes
+};
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t sectionCount;
+
+    // World settings
+    sf::Vector2f gravity;
+    std::int32_t constraintIterations;
+    std::int32_t contactIterations;
+    std::uint32_t solverMode;
+    float fixedStep;
+    std::int32_t maxSteps;
+    float accumulator;
+    std::uint32_t sleepEnabled;
+    float sleepSpeed;
+    std::int32_t sleepSteps;
+    float jacobiRelaxation;
+    std::uint32_t xpbdEnabled;
+    float constraintTolerance;
+    std::uint32_t adaptiveSubsteps;
+    std::int32_t substeps;
+    std::int32_t minSubsteps;
+    std::int32_t maxSubsteps;
+    float substepFrame;
+    float substepMotion;
+    float substepPenetration;
+    std::uint32_t ccdEnabled;
+    float ccdThreshold;
+    std::int32_t reorderInterval;
+    std::int32_t stepsSinceReorder;
+    std::uint32_t reserved;
+
+    Section sections[static_cast<std::size_t>(SectionId::Count)];
+};
+
+// Constraints are stored by body handle; Object pointers can't survive a restart
+struct DistanceRecord {
+    BodyHandle a;
+    BodyHandle b;
+    float restLength;
+    float stiffness;
+    float compliance;
+};
+
+struct SpringRecord {
+    BodyHandle a;
+    BodyHandle b;
+    float restLength;
+    float stiffness;
+    float damping;
+};
+
+struct PinRecord {
+    BodyHandle body;
+    sf::Vector2f anchor;
+};
+
+// Everything above (and the columns) goes through memcpy
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(std::is_trivially_copyable_v<Collider>);
+static_assert(std::is_trivially_copyable_v<BodyStore::Slot>);
+static_assert(std::is_trivially_copyable_v<DistanceRecord>);
+static_assert(std::is_trivially_copyable_v<SpringRecord>);
+static_assert(std::is_trivially_copyable_v<PinRecord>);
+
+}  // namespace WorldSnapshot
+
+#endif //PHYSICSENGINE_WORLDSNAPSHOT_H
@@ -0,0 +1,369 @@
+// Headless benchmark: canned scenes, timing as JSON on stdout
+//
+//   PhysicsBench [--scene <name>|all] [--bodies N] [--steps N] [--threads N] [--solver sequential|colored|jacobi]
+//                [--iterations N] [--tolerance T] [--xpbd] [--ccd] [--snapshot <file>] [--record <file>]
+//                [--worlds N] [--reorder N]
+//
+// --snapshot also times SaveSnapshot/LoadSnapshot of each scene through that file.
+// --record runs the timed steps with a TrajectoryRecorder writing to that file
+// (its cost is the "record" phase).
+// --worlds steps N copies of each scene (--bodies each) through a WorldBatch
+// instead of one world; "serial_seconds" is the same copies stepped one by one.
+// --reorder sorts body storage along a Morton curve every N steps (SetSpatialReorder).
+//
+// Only needs PhysicsWorld and SFML's Vector2, no window.
+
+#include "PhysicsWorld.h"
+#include "TrajectoryRecorder.h"
+#include "VerletKernels.h"
+#include "WorldBatch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+    #include <sys/resource.h>
+#endif
+
+struct BenchConfig {
+    int bodies = 2000;
+    int steps = 600;
+    int warmup = 60;
+    unsigned threads = 0;
+    float dt = 1.f / 480.f;
+    std::string snapshotPath;   // empty = don't time snapshots
+    std::string recordPath;     // empty = no TrajectoryRecorder
+    ConstraintSolverMode solver = ConstraintSolverMode::Sequential;
+    int iterations = 0;         // 0 = world default
+    float tolerance = 0.f;      // constraint early exit, 0 = off
+    bool xpbd = false;
+    bool ccd = false;           // continuous collision for fast circles
+    int worlds = 0;             // > 0: that many copies in a WorldBatch
+    int reorder = 0;            // spatial reorder interval, 0 = off
+};
+
+struct Scene {
+    const char* name;
+    std::function<void(PhysicsWorld&, int bodies)> build;
+};
+
+// Static box, top-left corner at (x, y)
+static void AddBox(PhysicsWorld& world, float x, float y, float w, float h) {
+    world.AddBody({.position = {x + w * 0.5f, y + h * 0.5f}, .isStatic = true, .collider = MakeAABBCollider(w, h)});
+}
+
+// N circles dropped into a walled pit
+static void BuildBallPit(PhysicsWorld& world, int bodies) {
+    const int columns = 100;
+    const float radius = 4.f;
+    const float width = columns * radius * 2.5f;
+
+    AddBox(world, -20.f, 0.f, 20.f, 4000.f);
+    AddBox(world, width, 0.f, 20.f, 4000.f);
+    AddBox(world, -20.f, 4000.f, width + 40.f, 40.f);
+
+    for (int i = 0; i < bodies; ++i) {
+        float x = 10.f + (i % columns) * radius * 2.5f + (i / columns % 2) * radius;
+        float y = 3990.f - (i / columns) * radius * 2.5f;
+        world.AddBody({.position = {x, y}, .collider = MakeCircleCollider(radius)});
+    }
+}
+
+// Columns of dynamic boxes with a circle on each
+static void BuildCircleStacks(PhysicsWorld& world, int bodies) {
+    const int height = 9;   // boxes per column, +1 circle
+    const int columns = std::max(1, bodies / (height + 1));
+    const float size = 20.f;
+
+    AddBox(world, -50.f, 1000.f, columns * size * 2.f + 100.f, 40.f);
+
+    for (int c = 0; c < columns; ++c) {
+        float x = c * size * 2.f;
+        for (int k = 0; k < height; ++k) {
+            float y = 1000.f - size * 0.5f - k * size;
+            world.AddBody({.position = {x, y}, .collider = MakeAABBCollider(size, size)});
+        }
+        world.AddBody({.position = {x, 1000.f - height * size - size * 0.5f}, .collider = MakeCircleCollider(size * 0.5f)});
+    }
+}
+
+// Ropes of 50 links, pinned at the top
+static void BuildDistanceChains(PhysicsWorld& world, int bodies) {
+    const int links = 50;
+    const int chains = std::max(1, bodies / links);
+
+    for (int c = 0; c < chains; ++c) {
+        BodyHandle previous;
+        for (int k = 0; k < links; ++k) {
+            sf::Vector2f pos = {c * 30.f + k * 8.f, 0.f};   // start horizontal so they swing
+            BodyHandle link = world.AddBody({.position = pos, .collider = MakeCircleCollider(3.f)});
+            if (k == 0) {
+                world.AddPinConstraint(link, pos);
+            } else {
+                world.AddDistanceConstraint(previous, link);
+            }
+            previous = link;
+        }
+    }
+}
+
+// Square spring cloth pinned along the top edge
+static void BuildSpringCloth(PhysicsWorld& world, int bodies) {
+    int size = 2;
+    while ((size + 1) * (size + 1) <= bodies) ++size;
+    const float spacing = 10.f;
+
+    std::vector<BodyHandle> grid;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            sf::Vector2f pos = {x * spacing, y * spacing};
+            grid.push_back(world.AddBody({.position = pos}));   // no collider, cloth doesn't self-collide
+            if (y == 0) world.AddPinConstraint(grid.back(), pos);
+            if (x > 0) world.AddSpringConstraint(grid[grid.size() - 2], grid.back(), 0.8f, 0.05f);
+            if (y > 0) world.AddSpringConstraint(grid[grid.size() - 1 - size], grid.back(), 0.8f, 0.05f);
+        }
+    }
+}
+
+// Independent two-link pendulums
+static void BuildPendulums(PhysicsWorld& world, int bodies) {
+    const int count = std::max(1, bodies / 2);
+
+    for (int i = 0; i < count; ++i) {
+        sf::Vector2f anchor = {(i % 100) * 40.f, (i / 100) * 200.f};
+        BodyHandle a = world.AddBody({.position = anchor + sf::Vector2f{30.f, 0.f}, .collider = MakeCircleCollider(4.f)});
+        BodyHandle b = world.AddBody({.position = anchor + sf::Vector2f{60.f, -10.f}, .collider = MakeCircleCollider(4.f)});
+        BodyHandle pivot = world.AddBody({.position = anchor, .isStatic = true});
+        world.AddDistanceConstraint(pivot, a);
+        world.AddDistanceConstraint(a, b);
+    }
+}
+
+// Balls falling through 400 staggered static platforms, the shape of a level
+static void BuildPlatforms(PhysicsWorld& world, int bodies) {
+    const int columns = 40;
+    for (int i = 0; i < 400; ++i) {
+        float x = (i % columns) * 50.f + (i / columns % 2) * 25.f;
+        AddBox(world, x, 400.f + (i / columns) * 60.f, 30.f, 6.f);
+    }
+    AddBox(world, -40.f, 1000.f, columns * 50.f + 80.f, 40.f);
+
+    for (int i = 0; i < bodies; ++i) {
+        float x = 5.f + (i % 200) * 10.f;
+        float y = 380.f - (i / 200) * 10.f;
+        world.AddBody({.position = {x, y}, .collider = MakeCircleCollider(3.f)});
+    }
+}
+
+// Circles resting apart on a floor, asleep before the warmup is over: should cost next to nothing
+static void BuildSettled(PhysicsWorld& world, int bodies) {
+    const float radius = 4.f;
+    AddBox(world, -20.f, 1000.f, bodies * radius * 3.f + 40.f, 40.f);
+
+    world.SetSleepEnabled(true);
+    world.SetSleepThreshold(15.f, 30);
+    for (int i = 0; i < bodies; ++i) {
+        world.AddBody({.position = {i * radius * 3.f, 1000.f - radius}, .collider = MakeCircleCollider(radius)});
+    }
+}
+
+static const char* SolverName(ConstraintSolverMode mode) {
+    switch (mode) {
+        case ConstraintSolverMode::Sequential:      return "sequential";
+        case ConstraintSolverMode::ParallelColored: return "colored";
+        case ConstraintSolverMode::Jacobi:          return "jacobi";
+    }
+    return "?";
+}
+
+static bool ParseSolver(const char* name, ConstraintSolverMode& mode) {
+    for (ConstraintSolverMode m : {ConstraintSolverMode::Sequential, ConstraintSolverMode::ParallelColored,
+                                   ConstraintSolverMode::Jacobi}) {
+        if (!std::strcmp(name, SolverName(m))) {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+static long PeakMemoryKB() {
+#if defined(_WIN32)
+    return -1;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    #if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;   // bytes on macOS
+    #else
+        return usage.ru_maxrss;          // KB on Linux
+    #endif
+#endif
+}
+
+static void ApplyConfig(PhysicsWorld& world, const BenchConfig& config) {
+    world.SetConstraintSolverMode(config.solver);
+    if (config.iterations > 0) world.SetConstraintIterations(config.iterations);
+    world.SetConstraintTolerance(config.tolerance);
+    world.SetXPBDEnabled(config.xpbd);
+    world.SetContinuousCollision(config.ccd);
+    world.SetSpatialReorder(config.reorder);
+    world.SetStatsHistorySize(static_cast<std::size_t>(std::max(1, config.steps)));
+}
+
+// Same scene config.worlds times: batched, then the same copies stepped one after another
+static void RunBatch(const Scene& scene, const BenchConfig& config, bool last) {
+    WorldBatch batch(config.threads);
+    WorldBatch serial(1);
+    for (WorldBatch* b : {&batch, &serial}) {
+        for (int i = 0; i < config.worlds; ++i) {
+            PhysicsWorld& world = b->AddWorld();
+            ApplyConfig(world, config);
+            scene.build(world, config.bodies);
+        }
+        b->Step(config.dt, config.warmup);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    batch.Step(config.dt, config.steps);
+    auto mid = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < serial.GetWorldCount(); ++i) {
+        for (int s = 0; s < config.steps; ++s) serial.GetWorld(i).Step(config.dt);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::size_t bodies = 0;
+    for (std::size_t i = 0; i < batch.GetWorldCount(); ++i) bodies += batch.GetWorld(i).GetBodyCount();
+    const double seconds = std::chrono::duration<double>(mid - start).count();
+    const double serialSeconds = std::chrono::duration<double>(end - mid).count();
+    const double bodySteps = static_cast<double>(bodies) * config.steps;
+
+    std::printf("    {\"scene\": \"%s\", \"worlds\": %d, \"bodies\": %zu, \"steps\": %d, \"threads\": %u, \"tasks\": %zu, "
+                "\"seconds\": %.6f, \"serial_seconds\": %.6f, \"speedup\": %.2f, \"ns_per_body_step\": %.3f, \"peak_rss_kb\": %ld}%s\n",
+                scene.name, config.worlds, bodies, config.steps, batch.GetThreadCount(), batch.GetTaskCount(),
+                seconds, serialSeconds, serialSeconds / seconds, seconds * 1e9 / bodySteps, PeakMemoryKB(), last ? "" : ",");
+}
+
+static void RunScene(const Scene& scene, const BenchConfig& config, bool last) {
+    if (config.worlds > 0) {
+        RunBatch(scene, config, last);
+        return;
+    }
+
+    PhysicsWorld world;
+    world.SetThreadCount(config.threads);
+    ApplyConfig(world, config);
+    scene.build(world, config.bodies);
+
+    for (int i = 0; i < config.warmup; ++i) world.Step(config.dt);
+
+    TrajectoryRecorder recorder;
+    if (!config.recordPath.empty() && recorder.Open(config.recordPath)) world.SetRecorder(&recorder);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < config.steps; ++i) world.Step(config.dt);
+    auto end = std::chrono::steady_clock::now();
+
+    world.SetRecorder(nullptr);
+    recorder.Close();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double bodySteps = static_cast<double>(world.GetBodyCount()) * config.steps;
+
+    std::printf("    {\"scene\": \"%s\", \"bodies\": %zu, \"constraints\": %zu, \"steps\": %d, "
+                "\"seconds\": %.6f, \"steps_per_sec\": %.2f, \"ns_per_body_step\": %.3f, \"peak_rss_kb\": %ld",
+                scene.name, world.GetBodyCount(), world.GetConstraintCount(), config.steps,
+                seconds, config.steps / seconds, seconds * 1e9 / bodySteps, PeakMemoryKB());
+
+    // Averages over the timed steps (warmup got pushed out of the history)
+    if (PhysicsStats::Enabled) {
+        const StepStats avg = world.GetStats().Average();
+        std::printf(", \"pairs\": %u, \"contacts\": %u, \"skipped\": %u, \"swept\": %u, \"constraint_iterations\": %u, \"phase_ms\": {",
+                    avg.pairsTested, avg.contactsFound, avg.bodiesSkipped, avg.bodiesSwept, avg.constraintIterations);
+        for (std::size_t p = 0; p < StepStats::PhaseCount; ++p) {
+            std::printf("%s\"%s\": %.4f", p ? ", " : "", StepPhaseName(static_cast<StepPhase>(p)), avg.phaseMs[p]);
+        }
+        std::printf("}");
+    }
+
+    if (!config.snapshotPath.empty()) {
+        auto saveStart = std::chrono::steady_clock::now();
+        const bool saved = world.SaveSnapshot(config.snapshotPath);
+        auto loadStart = std::chrono::steady_clock::now();
+        PhysicsWorld restored;
+        const bool loaded = saved && restored.LoadSnapshot(config.snapshotPath);
+        auto loadEnd = std::chrono::steady_clock::now();
+
+        std::printf(", \"snapshot_ok\": %s, \"snapshot_save_ms\": %.3f, \"snapshot_load_ms\": %.3f",
+                    loaded ? "true" : "false",
+                    std::chrono::duration<double, std::milli>(loadStart - saveStart).count(),
+                    std::chrono::duration<double, std::milli>(loadEnd - loadStart).count());
+    }
+    if (config.reorder > 0) std::printf(", \"reorders\": %zu", world.GetReorderCount());
+    if (!config.recordPath.empty()) {
+        std::printf(", \"record_ok\": %s, \"record_frames\": %llu, \"record_dropped\": %llu",
+                    recorder.GetRecordedFrames() > 0 ? "true" : "false",
+                    static_cast<unsigned long long>(recorder.GetRecordedFrames()),
+                    static_cast<unsigned long long>(recorder.GetDroppedFrames()));
+    }
+    std::printf("}%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+    const std::vector<Scene> scenes = {
+        {"ball_pit", BuildBallPit},
+        {"circle_stacks", BuildCircleStacks},
+        {"distance_chains", BuildDistanceChains},
+        {"spring_cloth", BuildSpringCloth},
+        {"pendulums", BuildPendulums},
+        {"platforms", BuildPlatforms},
+        {"settled", BuildSettled},
+    };
+
+    BenchConfig config;
+    std::string only = "all";
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--scene") && hasValue) only = argv[++i];
+        else if (!std::strcmp(argv[i], "--bodies") && hasValue) config.bodies = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--steps") && hasValue) config.steps = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue) config.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--snapshot") && hasValue) config.snapshotPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--record") && hasValue) config.recordPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--solver") && hasValue && ParseSolver(argv[i + 1], config.solver)) ++i;
+        else if (!std::strcmp(argv[i], "--iterations") && hasValue) config.iterations = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--tolerance") && hasValue) config.tolerance = static_cast<float>(std::atof(argv[++i]));
+        else if (!std::strcmp(argv[i], "--xpbd")) config.xpbd = true;
+        else if (!std::strcmp(argv[i], "--ccd")) config.ccd = true;
+        else if (!std::strcmp(argv[i], "--worlds") && hasValue) config.worlds = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--reorder") && hasValue) config.reorder = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--scene <name>|all] [--bodies N] [--steps N] [--threads N] [--solver sequential|colored|jacobi] [--iterations N] [--tolerance T] [--xpbd] [--ccd] [--snapshot <file>] [--record <file>] [--worlds N] [--reorder N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<const Scene*> selected;
+    for (const Scene& scene : scenes) {
+        if (only == "all" || only == scene.name) selected.push_back(&scene);
+    }
+    if (selected.empty()) {
+        std::fprintf(stderr, "unknown scene: %s\n", only.c_str());
+        return 1;
+    }
+
+    std::printf("{\n  \"kernel\": \"%s\",\n  \"solver\": \"%s\",\n  \"dt\": %g,\n  \"results\": [\n",
+                VerletKernelName(), SolverName(config.solver), config.dt);
+    for (std::size_t i = 0; i < selected.size(); ++i) {
+        RunScene(*selected[i], config, i + 1 == selected.size());
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -1,22 +1,79 @@
 #include <SFML/Graphics.hpp>
 #include "PhysicsWorld.h"
+#include "PhysicsThread.h"
 #include "Ball.h"
-#include "Spring.h"
+#include "BallBatch.h"
+#include "SpringBatch.h"
+#include "TrajectoryRecorder.h"
 #include "Grid.h"
 #include "UI/InfoPanel.h"
 #include "UI/CounterPanel.h"
+#include "UI/ProfilerPanel.h"
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <iostream>
 
-int main() {
+// Plays a --record file back at its recorded speed, looping. Nothing is simulated.
+static int Replay(sf::RenderWindow& window, const char* path) {
+    TrajectoryReader reader;
+    if (!reader.Open(path)) {
+        std::cerr << "can't read trajectory " << path << std::endl;
+        return 1;
+    }
+
+    BallBatch ballBatch;
+    TrajectoryFrame frame;
+    const sf::Color bgColor(25, 35, 60);
+    sf::Clock clock;
+    float behind = 0.f;   // recorded time we still owe
+
+    while (window.isOpen()) {
+        while (const auto event = window.pollEvent()) {
+            if (event->is<sf::Event::Closed>()) window.close();
+        }
+
+        behind += clock.restart().asSeconds();
+        while (behind > 0.f) {
+            if (!reader.NextFrame(frame) && !(reader.Rewind() && reader.NextFrame(frame))) return 1;
+            behind -= frame.dt > 0.f ? frame.dt : behind;
+        }
+
+        ballBatch.update(frame, sf::Color(200, 200, 220), sf::Color::White);
+        window.clear(bgColor);
+        window.draw(ballBatch);
+        window.display();
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // --threaded: physics runs on its own thread, the window only sees snapshots
+    // --record <file>: every Step's positions go to file (TrajectoryRecorder)
+    // --replay <file>: play such a file back instead of simulating
+    bool threaded = false;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threaded") == 0) threaded = true;
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+    }
+
     const int width = 800;
     const int height = 600;
 
     sf::RenderWindow window(sf::VideoMode({width, height}), "Matt is epic");
     window.setFramerateLimit(60);
+    if (replayPath) return Replay(window, replayPath);
 
     PhysicsWorld world;
+    world.ReserveBodies(4096);  // spawning/despawning below this never allocates
+    world.SetSleepEnabled(true);  // settled piles stop costing anything
+    world.SetAdaptiveSubsteps(2, 16);  // 2..16 steps per 60 fps frame, as many as the motion needs
+    world.SetContinuousCollision(true);  // fast balls get swept, so they don't push the substeps up
+    BallBatch ballBatch;  // all balls in one draw call
     std::vector<std::unique_ptr<Ball>> myBalls; //only pointers get moved
     //so that we can allocate each Ball at a stable address
     //Only unique_ptr are moved, but the Balls aren't moved
@@ -46,6 +103,7 @@ int main() {
     // UI panels
     InfoPanel infoPanel(font);
     CounterPanel counterPanel(font, static_cast<float>(width));
+    ProfilerPanel profilerPanel(font, {static_cast<float>(width) - 265.f, 80.f});  // F3 to toggle
     
     int floorCount = 1;
     Ball* hoveredBall = nullptr;
@@ -59,90 +117,166 @@ int main() {
     world.AddPinConstraint(&anchorBall->physics, anchorBall->physics.position);
     
     // Connect with spring
-    auto* springConstraint = world.AddSpringConstraint(
-        &anchorBall->physics, &swingBall->physics, 0.3f, 0.05f);
+    world.AddSpringConstraint(&anchorBall->physics, &swingBall->physics, 0.3f, 0.05f);
     
-    Spring spring(&anchorBall->physics, &swingBall->physics, springConstraint,
-                  sf::Color(255, 200, 100), 2.f, 12);
+    SpringBatch springBatch(sf::Color(255, 200, 100), 12);  // draws every SpringConstraint in the world
     
     myBalls.push_back(std::move(anchorBall));
     myBalls.push_back(std::move(swingBall));
 
+    // Outlives physics, so the physics thread is gone before the file is closed
+    TrajectoryRecorder recorder;
+    if (recordPath && !recorder.Open(recordPath)) std::cerr << "can't write trajectory " << recordPath << std::endl;
+
+    // From here on the world is only touched through physics.Post(), in both modes
+    PhysicsThread physics(world);
+    if (recorder.IsOpen()) physics.Post([&recorder](PhysicsWorld& w) { w.SetRecorder(&recorder); });
+    if (threaded) physics.Start();
+
+    // Removed balls stay alive until the physics side has let go of them
+    struct RetiredBall {
+        std::unique_ptr<Ball> ball;
+        std::uint64_t removedAt;
+    };
+    std::vector<RetiredBall> retiredBalls;
+    std::vector<std::unique_ptr<Ball>> freeBalls;   // recycled by the next click instead of new/delete
+
+    // Off-screen balls leave in one RemoveObjects per wave. A wave's list has to stay
+    // put until the physics side has run it, so a few of them take turns.
+    struct RemovalWave {
+        std::vector<Object*> objects;
+        std::uint64_t removedAt = 0;   // free again once commandsApplied reaches it
+    };
+    std::vector<RemovalWave> removalWaves(4);
+    for (RemovalWave& wave : removalWaves) wave.objects.reserve(4096);
+    myBalls.reserve(4096);
+    retiredBalls.reserve(4096);
+    freeBalls.reserve(4096);
+    std::uint64_t lastSteps = 0;
+    physics.SetCullBounds({0.f, 0.f}, {static_cast<float>(width), static_cast<float>(height) + 200.f});  // Extra margin below
+
+    // Swap-and-pop, so the list never shifts
+    auto listBall = [&](std::unique_ptr<Ball> ball) {
+        ball->listIndex = myBalls.size();
+        myBalls.push_back(std::move(ball));
+    };
+    auto unlistBall = [&](Ball* ball) {
+        const std::size_t index = ball->listIndex;
+        std::unique_ptr<Ball> owned = std::move(myBalls[index]);
+        if (index + 1 != myBalls.size()) {
+            myBalls[index] = std::move(myBalls.back());
+            myBalls[index]->listIndex = index;
+        }
+        myBalls.pop_back();
+        owned->listIndex = Ball::NotListed;
+        return owned;
+    };
+    for (std::size_t i = 0; i < myBalls.size(); ++i) myBalls[i]->listIndex = i;
+
     sf::Clock clock;
 
     while (window.isOpen()) {
         while (const auto event = window.pollEvent()) {
             if (event->is<sf::Event::Closed>()) window.close();
 
+            if (const auto* key = event->getIf<sf::Event::KeyPressed>()) {
+                if (key->code == sf::Keyboard::Key::F3) profilerPanel.toggle();
+            }
+
             if (event->is<sf::Event::MouseButtonPressed>()) {
                 const auto* mouse = event->getIf<sf::Event::MouseButtonPressed>();
                 if (mouse->button == sf::Mouse::Button::Left) {
-                    auto ball = std::make_unique<Ball>(static_cast<float>(mouse->position.x), static_cast<float>(mouse->position.y), 25.f, sf::Color(220, 120, 100));
-                    world.AddObject(&ball->physics);
-                    myBalls.push_back(std::move(ball));
+                    const float x = static_cast<float>(mouse->position.x);
+                    const float y = static_cast<float>(mouse->position.y);
+                    std::unique_ptr<Ball> ball;
+                    if (!freeBalls.empty()) {
+                        ball = std::move(freeBalls.back());
+                        freeBalls.pop_back();
+                        ball->Reset(x, y, 25.f, sf::Color(220, 120, 100));
+                    } else {
+                        ball = std::make_unique<Ball>(x, y, 25.f, sf::Color(220, 120, 100));
+                    }
+                    Object* object = &ball->physics;
+                    physics.Post([object](PhysicsWorld& w) { w.AddObject(object); });
+                    listBall(std::move(ball));
                 }
             }
         }
 
         const float dt = clock.restart().asSeconds();
-
-        for(int i=0; i<8; i++) {
-            world.Step(dt / 8.f);
-        }
+        if (!threaded) physics.Pump(dt);
+        const RenderSnapshot& snapshot = physics.Latest();
+        const int steps = static_cast<int>(snapshot.steps - lastSteps);
+        lastSteps = snapshot.steps;
         
-        // Remove balls that are off-screen
-        for (auto it = myBalls.begin(); it != myBalls.end(); ) {
-            float r = (*it)->GetRadius();
-            sf::Vector2f pos = (*it)->physics.position;
-            
-            bool offScreen = (pos.x + r < 0) || (pos.x - r > width) ||
-                             (pos.y + r < 0) || (pos.y - r > height + 200);  // Extra margin below
-            
-            if (offScreen) {
-                world.RemoveObject(&(*it)->physics);
-                it = myBalls.erase(it);
+        // Remove balls that are off-screen (the snapshot already lists them). If every wave
+        // is still in flight they wait a frame; they'll still be outside.
+        auto wave = std::find_if(removalWaves.begin(), removalWaves.end(),
+                                 [&](const RemovalWave& w) { return w.removedAt <= snapshot.commandsApplied; });
+        if (!snapshot.outside.empty() && wave != removalWaves.end()) {
+            const std::size_t firstRetired = retiredBalls.size();
+            wave->objects.clear();
+            for (BodyHandle body : snapshot.outside) {
+                Ball* ball = Ball::FromSnapshot(snapshot, body);
+                if (!ball || ball->listIndex == Ball::NotListed) continue;   // not a ball, or removal already posted
+                wave->objects.push_back(&ball->physics);
+                retiredBalls.push_back({unlistBall(ball), 0});
+            }
+            if (!wave->objects.empty()) {
+                // One pointer fits std::function's inline storage, so posting doesn't allocate
+                const std::vector<Object*>* objects = &wave->objects;
+                wave->removedAt = physics.Post([objects](PhysicsWorld& w) { w.RemoveObjects(*objects); });
+                for (std::size_t i = firstRetired; i < retiredBalls.size(); ++i) retiredBalls[i].removedAt = wave->removedAt;
+            }
+        }
+        for (auto it = retiredBalls.begin(); it != retiredBalls.end(); ) {
+            if (snapshot.commandsApplied >= it->removedAt) {
+                freeBalls.push_back(std::move(it->ball));
+                it = retiredBalls.erase(it);
             } else {
                 ++it;
             }
         }
         
-        // Check for hover
+        // Check for hover, answered by a world query on the physics side
         sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-        sf::Vector2f mousePosF(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
+        physics.SetPickPoint({static_cast<float>(mousePos.x), static_cast<float>(mousePos.y)});
         hoveredBall = nullptr;
         
-        for (auto& ball : myBalls) {
-            sf::Vector2f diff = ball->physics.position - mousePosF;
-            float distSq = diff.x * diff.x + diff.y * diff.y;
-            float radius = ball->GetRadius();
-            if (distSq < radius * radius) {
-                hoveredBall = ball.get();
+        for (BodyHandle body : snapshot.picked) {
+            Ball* ball = Ball::FromSnapshot(snapshot, body);
+            if (ball && ball->listIndex != Ball::NotListed) {
+                ball->renderBody = body;
+                hoveredBall = ball;
                 break;
             }
         }
         
         // Update UI
         if (hoveredBall) {
-            infoPanel.update(&hoveredBall->physics, hoveredBall->GetRadius());
+            const BodyHandle body = hoveredBall->renderBody;
+            infoPanel.update(snapshot.Position(body), snapshot.Velocity(body), snapshot.masses[body.id], hoveredBall->shape.getRadius());
         } else {
             infoPanel.hide();
         }
         counterPanel.update(myBalls.size(), floorCount);
+        profilerPanel.update(snapshot.stats, dt * 1000.f, steps);
         
         // Render
         window.clear(bgColor);
         window.draw(grid);
         window.draw(floor);
 
-        for (auto& ball : myBalls) {
-            ball->render(window);
-        }
+        ballBatch.update(snapshot, myBalls);
+        window.draw(ballBatch);
         
-        spring.render(window);
+        springBatch.update(snapshot);
+        window.draw(springBatch);
         
         if (fontLoaded) {
             window.draw(counterPanel);
             window.draw(infoPanel);
+            window.draw(profilerPanel);
         }
 
         window.display();
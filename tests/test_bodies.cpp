@@ -0,0 +1,354 @@
+//World owned bodies: handles, SoA storage and the AddObject compat layer
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "PhysicsWorld.h"
+
+TEST(BodyStoreTest, HandlesSurviveRemoval) {
+    BodyStore store;
+    BodyDesc desc;
+
+    desc.position = {1.f, 0.f};
+    BodyHandle a = store.Add(desc);
+    desc.position = {2.f, 0.f};
+    BodyHandle b = store.Add(desc);
+    desc.position = {3.f, 0.f};
+    BodyHandle c = store.Add(desc);
+
+    store.Remove(a);
+
+    EXPECT_FALSE(store.Contains(a));
+    ASSERT_TRUE(store.Contains(c));
+    EXPECT_FLOAT_EQ(store.positions[store.IndexOf(b)].x, 2.f);
+    EXPECT_FLOAT_EQ(store.positions[store.IndexOf(c)].x, 3.f);
+    EXPECT_EQ(store.Size(), 2u);
+}
+
+TEST(PhysicsWorldBodies, BodyFallsUnderGravity) {
+    PhysicsWorld world;
+
+    BodyDesc desc;
+    desc.position = {100.f, 100.f};
+    desc.collider = MakeCircleCollider(10.f);
+    BodyHandle ball = world.AddBody(desc);
+
+    for (int i = 0; i < 10; ++i) {
+        world.Step(1.f / 60.f);
+    }
+
+    EXPECT_GT(world.GetPosition(ball).y, 100.f);
+    EXPECT_FLOAT_EQ(world.GetPosition(ball).x, 100.f);
+}
+
+TEST(PhysicsWorldBodies, BodyLandsOnStaticBox) {
+    PhysicsWorld world;
+
+    BodyDesc floorDesc;
+    floorDesc.position = {400.f, 600.f};
+    floorDesc.isStatic = true;
+    floorDesc.collider = MakeAABBCollider(800.f, 100.f);
+    world.AddBody(floorDesc);
+
+    BodyDesc ballDesc;
+    ballDesc.position = {400.f, 500.f};
+    ballDesc.collider = MakeCircleCollider(20.f);
+    BodyHandle ball = world.AddBody(ballDesc);
+
+    for (int i = 0; i < 600; ++i) {
+        world.Step(1.f / 480.f);
+    }
+
+    // Floor top is at 550
+    EXPECT_LE(world.GetPosition(ball).y + 20.f, 551.f);
+}
+
+TEST(PhysicsWorldBodies, ObjectSeesStepResults) {
+    PhysicsWorld world;
+
+    Object obj;
+    obj.position = {100.f, 100.f};
+    obj.InitVerlet();
+    BodyHandle handle = world.AddObject(&obj);
+
+    EXPECT_EQ(obj.body, handle);
+
+    world.Step(1.f / 60.f);
+    EXPECT_GT(obj.position.y, 100.f);
+
+    // Edits made straight on the Object are picked up next step
+    obj.position = {300.f, 300.f};
+    obj.oldPosition = obj.position;
+    world.Step(1.f / 60.f);
+    EXPECT_FLOAT_EQ(world.GetPosition(handle).x, 300.f);
+}
+
+TEST(PhysicsWorldBodies, RemoveObjectInvalidatesHandle) {
+    PhysicsWorld world;
+
+    Object obj;
+    obj.InitVerlet();
+    BodyHandle handle = world.AddObject(&obj);
+    world.RemoveObject(&obj);
+
+    EXPECT_FALSE(world.IsValid(handle));
+    EXPECT_FALSE(obj.body.IsValid());
+    EXPECT_EQ(world.GetBodyCount(), 0u);
+}
+
+TEST(PhysicsWorldBodies, ConstraintToRemovedBodyIsSkipped) {
+    PhysicsWorld world;
+
+    BodyDesc desc;
+    desc.position = {0.f, 0.f};
+    BodyHandle a = world.AddBody(desc);
+    desc.position = {100.f, 0.f};
+    BodyHandle b = world.AddBody(desc);
+
+    world.AddDistanceConstraint(a, b);
+    world.RemoveBody(a);
+
+    world.Step(1.f / 60.f);  // must not touch a's old slot
+    EXPECT_TRUE(world.IsValid(b));
+}
+
+TEST(BodyStoreTest, ReusedSlotLeavesOldHandleStale) {
+    BodyStore store;
+    BodyDesc desc;
+
+    BodyHandle a = store.Add(desc);
+    store.Remove(a);
+    desc.position = {7.f, 0.f};
+    BodyHandle b = store.Add(desc);
+
+    EXPECT_EQ(a.id, b.id);    // same slot...
+    EXPECT_NE(a, b);          // ...different generation
+    EXPECT_FALSE(store.Contains(a));
+    EXPECT_EQ(store.IndexOf(a), BodyStore::InvalidIndex);
+    ASSERT_TRUE(store.Contains(b));
+    EXPECT_FLOAT_EQ(store.positions[store.IndexOf(b)].x, 7.f);
+}
+
+TEST(BodyStoreTest, SwapRemoveMovesLastBodyIntoHole) {
+    BodyStore store;
+    BodyDesc desc;
+    std::vector<BodyHandle> handles;
+    for (int i = 0; i < 4; ++i) {
+        desc.position = {static_cast<float>(i), 0.f};
+        handles.push_back(store.Add(desc));
+    }
+
+    store.Remove(handles[1]);
+
+    EXPECT_EQ(store.IndexOf(handles[3]), 1u);
+    EXPECT_EQ(store.HandleAt(1), handles[3]);
+    for (int i : {0, 2, 3}) {
+        EXPECT_FLOAT_EQ(store.positions[store.IndexOf(handles[i])].x, static_cast<float>(i));
+    }
+}
+
+TEST(PhysicsWorldBodies, RemoveObjectsInOneBatch) {
+    PhysicsWorld world;
+
+    std::vector<Object> objects(5);
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        objects[i].position = {static_cast<float>(i) * 50.f, 0.f};
+        objects[i].InitVerlet();
+        world.AddObject(&objects[i]);
+    }
+    BodyHandle kept = objects[2].body;
+
+    std::vector<Object*> removed = {&objects[0], &objects[3], &objects[4], &objects[0]};  // duplicate is ignored
+    world.RemoveObjects(removed);
+
+    EXPECT_EQ(world.GetBodyCount(), 2u);
+    EXPECT_FALSE(objects[0].body.IsValid());
+    EXPECT_FALSE(objects[4].body.IsValid());
+    ASSERT_TRUE(world.IsValid(kept));
+    EXPECT_FLOAT_EQ(world.GetPosition(kept).x, 100.f);
+}
+
+TEST(PhysicsWorldBodies, ConstraintDoesNotFollowReusedSlot) {
+    PhysicsWorld world;
+
+    BodyDesc desc;
+    desc.position = {0.f, 0.f};
+    BodyHandle a = world.AddBody(desc);
+    desc.position = {100.f, 0.f};
+    BodyHandle b = world.AddBody(desc);
+    world.AddDistanceConstraint(a, b, 10.f);
+    world.RemoveBody(a);
+
+    desc.position = {500.f, 0.f};
+    BodyHandle c = world.AddBody(desc);   // lands in a's slot
+    ASSERT_EQ(c.id, a.id);
+
+    world.Step(1.f / 60.f);
+    EXPECT_FLOAT_EQ(world.GetPosition(b).x, 100.f);
+    EXPECT_FLOAT_EQ(world.GetPosition(c).x, 500.f);
+}
+
+TEST(BodyStoreTest, PermuteKeepsHandlesOnTheirBodies) {
+    BodyStore store;
+    BodyDesc desc;
+    std::vector<BodyHandle> handles;
+    for (int i = 0; i < 4; ++i) {
+        desc.position = {static_cast<float>(i), 0.f};
+        handles.push_back(store.Add(desc));
+    }
+
+    const std::uint32_t order[] = {3, 1, 0, 2};
+    store.Permute(order);
+
+    EXPECT_EQ(store.IndexOf(handles[3]), 0u);
+    EXPECT_EQ(store.HandleAt(3), handles[2]);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_FLOAT_EQ(store.positions[store.IndexOf(handles[i])].x, static_cast<float>(i));
+    }
+}
+
+TEST(BodyStoreTest, RestoreHandlesRejectsRepeatedFreeIds) {
+    BodyStore store;
+    store.Add(BodyDesc{});
+
+    // Slot 2 is in neither list, slot 1 is free twice: the counts still add up
+    const BodyStore::Slot slots[] = {{0, 0}, {BodyStore::InvalidIndex, 1}, {BodyStore::InvalidIndex, 1}};
+    const std::uint32_t ids[] = {0};
+    const std::uint32_t repeated[] = {1, 1};
+    EXPECT_FALSE(store.RestoreHandles(slots, ids, repeated));
+
+    const std::uint32_t freeIds[] = {2, 1};
+    ASSERT_TRUE(store.RestoreHandles(slots, ids, freeIds));
+    EXPECT_EQ(store.Add(BodyDesc{}).id, 1u);
+    EXPECT_EQ(store.Add(BodyDesc{}).id, 2u);
+}
+
+TEST(PhysicsWorldBodies, ReorderBodiesSortsByPosition) {
+    PhysicsWorld world;
+
+    // Two far apart clusters, spawned interleaved
+    std::vector<BodyHandle> handles;
+    for (int i = 0; i < 8; ++i) {
+        const float x = (i % 2 ? 1000.f : 0.f) + static_cast<float>(i / 2) * 25.f;
+        handles.push_back(world.AddBody({.position = {x, 0.f}, .collider = MakeCircleCollider(10.f)}));
+    }
+    DistanceConstraint* link = world.AddDistanceConstraint(handles[0], handles[1]);
+    const float length = link->restLength;
+
+    ASSERT_TRUE(world.ReorderBodies());
+    EXPECT_FALSE(world.ReorderBodies());   // already in order
+    EXPECT_EQ(world.GetReorderCount(), 1u);
+
+    // Each cluster is contiguous now
+    const BodyStore& bodies = world.GetBodies();
+    for (std::uint32_t i = 0; i < 4; ++i) EXPECT_LT(bodies.positions[i].x, 500.f);
+    for (std::uint32_t i = 4; i < 8; ++i) EXPECT_GT(bodies.positions[i].x, 500.f);
+
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(world.IsValid(handles[i]));
+        EXPECT_FLOAT_EQ(world.GetPosition(handles[i]).x, (i % 2 ? 1000.f : 0.f) + static_cast<float>(i / 2) * 25.f);
+    }
+    world.Step(1.f / 60.f);
+    EXPECT_NEAR(world.GetPosition(handles[1]).x - world.GetPosition(handles[0]).x, length, 1e-3f);
+}
+
+TEST(PhysicsWorldBodies, ReorderAfterRemovalKeepsContactsInRange) {
+    PhysicsWorld world;
+    world.SetSpatialReorder(2);
+    world.AddBody({.position = {200.f, 420.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+    std::vector<BodyHandle> handles;
+    for (int i = 0; i < 60; ++i) {
+        handles.push_back(world.AddBody({.position = {static_cast<float>(i % 10) * 21.f + 100.f, 400.f - static_cast<float>(i / 10) * 21.f},
+                                         .collider = MakeCircleCollider(10.f)}));
+    }
+    for (int i = 0; i < 120; ++i) world.Step(1.f / 120.f);
+    ASSERT_FALSE(world.GetContacts().empty());
+
+    // The first ten: their slots get filled from the end, so old contacts would point past it
+    world.RemoveBodies(std::span<const BodyHandle>(handles.data(), 10));
+    for (const Contact& contact : world.GetContacts()) {
+        EXPECT_LT(contact.bodyA, world.GetBodyCount());
+        EXPECT_LT(contact.bodyB, world.GetBodyCount());
+    }
+
+    world.Step(1.f / 120.f);
+    world.Step(1.f / 120.f);   // reorders, remapping the contacts
+    EXPECT_GT(world.GetReorderCount(), 0u);
+    for (std::size_t i = 10; i < handles.size(); ++i) EXPECT_TRUE(world.IsValid(handles[i]));
+}
+
+TEST(PhysicsWorldBodies, SpatialReorderIsDeterministic) {
+    auto run = [](int interval) {
+        PhysicsWorld world;
+        world.SetSpatialReorder(interval);
+        world.AddBody({.position = {200.f, 420.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+        std::vector<BodyHandle> handles;
+        for (int i = 0; i < 64; ++i) {
+            // Scattered spawn order so the first pass has work to do
+            const int j = (i * 37) % 64;
+            handles.push_back(world.AddBody({.position = {static_cast<float>(j % 8) * 22.f + 30.f, static_cast<float>(j / 8) * 22.f},
+                                             .collider = MakeCircleCollider(10.f)}));
+        }
+        for (int i = 0; i < 120; ++i) world.Step(1.f / 120.f);
+        std::vector<sf::Vector2f> positions;
+        for (BodyHandle h : handles) positions.push_back(world.GetPosition(h));
+        return std::pair{positions, world.GetReorderCount()};
+    };
+
+    const auto [first, firstPasses] = run(10);
+    const auto [second, secondPasses] = run(10);
+    EXPECT_GT(firstPasses, 0u);
+    EXPECT_EQ(firstPasses, secondPasses);
+    ASSERT_EQ(first.size(), second.size());
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(first[i].x, second[i].x);
+        EXPECT_EQ(first[i].y, second[i].y);
+    }
+}
+
+// Counts every global allocation, for the steady state test below.
+// noinline so the compiler can't pair these up with the builtin new/delete.
+static std::atomic<std::size_t> g_allocations{0};
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+TEST(PhysicsWorldBodies, ReservedSpawnDespawnDoesNotAllocate) {
+    PhysicsWorld world;
+    world.ReserveBodies(256);
+    world.ReserveConstraints<DistanceConstraint>(64);
+    world.AddBody({.position = {0.f, 520.f}, .isStatic = true, .collider = MakeAABBCollider(1000.f, 40.f)});
+
+    std::vector<BodyHandle> spawned;
+    spawned.reserve(128);
+    std::vector<DistanceConstraint*> links;
+    links.reserve(64);
+
+    auto cycle = [&] {
+        for (int i = 0; i < 128; ++i) {
+            spawned.push_back(world.AddBody({.position = {static_cast<float>(i % 16) * 30.f, static_cast<float>(i / 16) * 30.f},
+                                             .collider = MakeCircleCollider(10.f)}));
+        }
+        for (int i = 0; i + 1 < 128; i += 2) links.push_back(world.AddDistanceConstraint(spawned[i], spawned[i + 1]));
+        for (int i = 0; i < 4; ++i) world.Step(1.f / 480.f);
+
+        for (DistanceConstraint* c : links) world.RemoveConstraint(c);
+        world.RemoveBodies(spawned);
+        spawned.clear();
+        links.clear();
+    };
+
+    cycle();   // first pass sizes the per step buffers
+    cycle();
+
+    const std::size_t before = g_allocations.load();
+    for (int i = 0; i < 10; ++i) cycle();
+    EXPECT_EQ(g_allocations.load() - before, 0u);
+    EXPECT_EQ(world.GetBodyCount(), 1u);
+}
@@ -0,0 +1,468 @@
+//Broadphase: candidate pairs must match brute force exactly
+
+#include <gtest/gtest.h>
+#include "Broadphase.h"
+#include "PhysicsWorld.h"
+#include <random>
+
+// Random mix of small circles and a few big boxes
+std::vector<BroadphaseProxy> MakeRandomProxies(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(0.f, 800.f);
+    std::uniform_real_distribution<float> size(2.f, 30.f);
+
+    std::vector<BroadphaseProxy> proxies;
+    for (int i = 0; i < count; ++i) {
+        sf::Vector2f p = {pos(rng), pos(rng)};
+        sf::Vector2f half = (i % 25 == 0) ? sf::Vector2f{120.f, 20.f} : sf::Vector2f{size(rng), size(rng)};
+
+        BroadphaseProxy proxy;
+        proxy.min = p - half;
+        proxy.max = p + half;
+        proxy.isStatic = (i % 25 == 0);
+        proxy.enabled = (i % 17 != 0);
+        proxies.push_back(proxy);
+    }
+    return proxies;
+}
+
+TEST(BroadphaseTest, GridMatchesBruteForce) {
+    auto proxies = MakeRandomProxies(500, 1234);
+
+    BruteForceBroadphase brute;
+    UniformGridBroadphase grid;
+    std::vector<BodyPair> expected, actual;
+
+    brute.FindPairs(proxies, expected);
+    grid.FindPairs(proxies, actual);
+
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(BroadphaseTest, GridMatchesBruteForceWithSmallCells) {
+    auto proxies = MakeRandomProxies(300, 99);
+
+    BruteForceBroadphase brute;
+    UniformGridBroadphase grid;
+    grid.SetCellSize(7.f);  // Proxies span many cells -> dedupe has to work
+    std::vector<BodyPair> expected, actual;
+
+    brute.FindPairs(proxies, expected);
+    grid.FindPairs(proxies, actual);
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(BroadphaseTest, GridCellSizeFromLargestCollider) {
+    std::vector<BroadphaseProxy> proxies(2);
+    proxies[0].min = {0.f, 0.f};
+    proxies[0].max = {10.f, 10.f};
+    proxies[1].min = {100.f, 100.f};
+    proxies[1].max = {140.f, 110.f};
+
+    UniformGridBroadphase grid;
+    std::vector<BodyPair> pairs;
+    grid.FindPairs(proxies, pairs);
+
+    EXPECT_FLOAT_EQ(grid.GetCellSize(), 40.f);
+    EXPECT_TRUE(pairs.empty());
+}
+
+TEST(BroadphaseTest, StaticPairsAreSkipped) {
+    std::vector<BroadphaseProxy> proxies(2);
+    for (auto& p : proxies) {
+        p.min = {0.f, 0.f};
+        p.max = {10.f, 10.f};
+        p.isStatic = true;
+    }
+
+    UniformGridBroadphase grid;
+    std::vector<BodyPair> pairs;
+    grid.FindPairs(proxies, pairs);
+
+    EXPECT_TRUE(pairs.empty());
+}
+
+TEST(BroadphaseTest, WorldCanSwitchBroadphase) {
+    PhysicsWorld world;
+    EXPECT_EQ(world.GetBroadphaseType(), BroadphaseType::UniformGrid);
+
+    world.SetBroadphase(BroadphaseType::BruteForce);
+    EXPECT_EQ(world.GetBroadphaseType(), BroadphaseType::BruteForce);
+}
+
+TEST(BroadphaseTest, WorldsAgreeAcrossBroadphases) {
+    PhysicsWorld gridWorld, bruteWorld;
+    bruteWorld.SetBroadphase(BroadphaseType::BruteForce);
+
+    std::vector<Object> gridObjs(40), bruteObjs(40);
+    for (int i = 0; i < 40; ++i) {
+        for (auto* objs : {&gridObjs, &bruteObjs}) {
+            Object& o = (*objs)[i];
+            o.position = {100.f + (i % 8) * 30.f, 100.f + (i / 8) * 30.f};
+            o.InitVerlet();
+            o.SetCircleCollider(18.f);
+        }
+        gridWorld.AddObject(&gridObjs[i]);
+        bruteWorld.AddObject(&bruteObjs[i]);
+    }
+
+    for (int s = 0; s < 30; ++s) {
+        gridWorld.Step(1.f / 480.f);
+        bruteWorld.Step(1.f / 480.f);
+    }
+
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_FLOAT_EQ(gridObjs[i].position.x, bruteObjs[i].position.x);
+        EXPECT_FLOAT_EQ(gridObjs[i].position.y, bruteObjs[i].position.y);
+    }
+}
+
+// ============ SWEEP AND PRUNE ============
+
+TEST(SweepAndPruneTest, MatchesBruteForce) {
+    auto proxies = MakeRandomProxies(500, 777);
+
+    BruteForceBroadphase brute;
+    SweepAndPruneBroadphase sap;
+    std::vector<BodyPair> expected, actual;
+
+    brute.FindPairs(proxies, expected);
+    sap.FindPairs(proxies, actual);
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(SweepAndPruneTest, StaysCorrectAsProxiesMove) {
+    auto proxies = MakeRandomProxies(300, 5);
+
+    BruteForceBroadphase brute;
+    SweepAndPruneBroadphase sap;
+    std::vector<BodyPair> expected, actual;
+    sap.FindPairs(proxies, actual);
+
+    // Drift everything a bit each step, like substeps do
+    for (int step = 0; step < 20; ++step) {
+        for (size_t i = 0; i < proxies.size(); ++i) {
+            sf::Vector2f delta = {((i * 7 + step) % 5) - 2.f, ((i * 3 + step) % 5) - 2.f};
+            proxies[i].min += delta;
+            proxies[i].max += delta;
+        }
+        brute.FindPairs(proxies, expected);
+        sap.FindPairs(proxies, actual);
+        ASSERT_EQ(actual, expected) << "step " << step;
+    }
+}
+
+TEST(SweepAndPruneTest, StillSceneNeedsNoSwaps) {
+    auto proxies = MakeRandomProxies(200, 42);
+
+    SweepAndPruneBroadphase sap;
+    std::vector<BodyPair> pairs;
+    sap.FindPairs(proxies, pairs);
+    sap.FindPairs(proxies, pairs);
+
+    EXPECT_EQ(sap.GetLastSwapCount(), 0u);
+}
+
+// Spawning appends: the new endpoints get sorted into the kept list, no full rebuild
+TEST(SweepAndPruneTest, AddedProxiesAreInsertedNotRebuilt) {
+    auto proxies = MakeRandomProxies(200, 42);
+
+    BruteForceBroadphase brute;
+    SweepAndPruneBroadphase sap;
+    std::vector<BodyPair> expected, actual;
+    sap.FindPairs(proxies, actual);
+
+    BroadphaseProxy spawned;
+    spawned.min = {395.f, 395.f};
+    spawned.max = {405.f, 405.f};
+    proxies.push_back(spawned);
+    spawned.min.x += 380.f;
+    spawned.max.x += 380.f;
+    proxies.push_back(spawned);
+
+    brute.FindPairs(proxies, expected);
+    sap.FindPairs(proxies, actual);
+    EXPECT_EQ(actual, expected);
+
+    // Only the new endpoints moved, each past the old ones to its right (and maybe the
+    // other new ones); a rebuild would report 0
+    std::size_t toTheRight = 0;
+    for (std::size_t n = proxies.size() - 2; n < proxies.size(); ++n) {
+        for (float value : {proxies[n].min.x, proxies[n].max.x}) {
+            for (std::size_t i = 0; i + 2 < proxies.size(); ++i) {
+                if (!proxies[i].enabled) continue;
+                toTheRight += (proxies[i].min.x >= value) + (proxies[i].max.x >= value);
+            }
+        }
+    }
+    EXPECT_GT(sap.GetLastSwapCount(), 0u);
+    EXPECT_LE(sap.GetLastSwapCount(), toTheRight + 6);
+
+    sap.FindPairs(proxies, actual);
+    EXPECT_EQ(sap.GetLastSwapCount(), 0u);
+}
+
+TEST(SweepAndPruneTest, SpawnedBodyCollidesWithoutReset) {
+    PhysicsWorld world, brute;
+    world.SetBroadphase(BroadphaseType::SweepAndPrune);
+    brute.SetBroadphase(BroadphaseType::BruteForce);
+    for (PhysicsWorld* w : {&world, &brute}) {
+        w->AddBody({.position = {0.f, 300.f}, .isStatic = true, .collider = MakeAABBCollider(800.f, 20.f)});
+        for (int i = 0; i < 30; ++i) {
+            w->AddBody({.position = {-300.f + 20.f * i, 280.f}, .collider = MakeCircleCollider(8.f)});
+        }
+        for (int i = 0; i < 120; ++i) w->Step(1.f / 480.f);
+        w->AddBody({.position = {0.f, 270.f}, .collider = MakeCircleCollider(12.f)});   // on top of the row
+        for (int i = 0; i < 30; ++i) w->Step(1.f / 480.f);
+    }
+
+    ASSERT_EQ(world.GetBodyCount(), brute.GetBodyCount());
+    for (std::uint32_t i = 0; i < world.GetBodyCount(); ++i) {
+        const BodyHandle handle = world.GetBodies().HandleAt(i);
+        EXPECT_EQ(world.GetPosition(handle), brute.GetPosition(handle)) << "body " << i;
+    }
+}
+
+TEST(SweepAndPruneTest, ResetAfterBodyRemoved) {
+    PhysicsWorld world;
+    world.SetBroadphase(BroadphaseType::SweepAndPrune);
+
+    Object a, b, c;
+    a.position = {100.f, 100.f};
+    b.position = {130.f, 100.f};
+    c.position = {400.f, 100.f};
+    for (Object* o : {&a, &b, &c}) {
+        o->InitVerlet();
+        o->SetCircleCollider(20.f);
+        world.AddObject(o);
+    }
+
+    world.Step(1.f / 480.f);
+    world.RemoveObject(&a);
+
+    // c is now at index 1; a stale endpoint list would miss the new pair
+    c.position = {130.f, 100.f};
+    c.oldPosition = c.position;
+    b.oldPosition = b.position;
+    world.Step(1.f / 480.f);
+
+    EXPECT_GT(std::abs(c.position.x - b.position.x), 30.f);
+}
+
+// ============ STATIC LAYER ============
+
+TEST(StaticLayerTest, BVHMatchesPlainLoop) {
+    auto proxies = MakeRandomProxies(400, 99);
+    std::vector<std::uint32_t> indices;
+    for (std::uint32_t i = 0; i < proxies.size(); i += 2) indices.push_back(i);
+
+    StaticBVH bvh;
+    bvh.Build(proxies, indices);
+    ASSERT_EQ(bvh.Size(), indices.size());
+
+    std::vector<std::uint32_t> expected, actual;
+    for (float x = -40.f; x < 840.f; x += 53.f) {
+        const sf::Vector2f min = {x, x * 0.7f}, max = {x + 60.f, x * 0.7f + 90.f};
+        const BroadphaseProxy box{min, max};
+        expected.clear();
+        for (std::uint32_t i : indices) {
+            if (ProxiesOverlap(proxies[i], box)) expected.push_back(i);
+        }
+        actual.clear();
+        bvh.Query(min, max, actual);
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, expected) << "box at " << x;
+    }
+}
+
+// Rows of static platforms with balls dropped between them
+static void FillPlatforms(PhysicsWorld& world, std::vector<BodyHandle>& platforms) {
+    for (int i = 0; i < 200; ++i) {
+        const sf::Vector2f pos = {(i % 20) * 60.f + (i / 20 % 2) * 30.f, 200.f + (i / 20) * 50.f};
+        platforms.push_back(world.AddBody({.position = pos, .isStatic = true, .collider = MakeAABBCollider(40.f, 8.f)}));
+    }
+    for (int i = 0; i < 150; ++i) {
+        const sf::Vector2f pos = {(i % 30) * 40.f + 5.f, 150.f - (i / 30) * 20.f};
+        Collider collider = (i % 5 == 0) ? MakeAABBCollider(10.f, 10.f) : MakeCircleCollider(6.f);
+        world.AddBody({.position = pos, .collider = collider});
+    }
+}
+
+TEST(StaticLayerTest, BuiltOnceWhileStaticBodiesStayPut) {
+    PhysicsWorld world;
+    std::vector<BodyHandle> platforms;
+    FillPlatforms(world, platforms);
+
+    for (int i = 0; i < 60; ++i) world.Step(1.f / 240.f);
+    EXPECT_EQ(world.GetStaticLayerRebuilds(), 1u);
+    EXPECT_EQ(world.GetStaticLayer().Size(), platforms.size());
+
+    // Dynamic bodies coming and going don't touch it (the last body is dynamic too)
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    world.Step(1.f / 240.f);
+    world.RemoveBody(world.GetBodies().HandleAt(210));
+    world.Step(1.f / 240.f);
+    EXPECT_EQ(world.GetStaticLayerRebuilds(), 1u);
+
+    world.SetPosition(platforms[3], {-500.f, -500.f});
+    world.Step(1.f / 240.f);
+    EXPECT_EQ(world.GetStaticLayerRebuilds(), 2u);
+
+    world.RemoveBody(platforms[0]);
+    world.Step(1.f / 240.f);
+    EXPECT_EQ(world.GetStaticLayerRebuilds(), 3u);
+    EXPECT_EQ(world.GetStaticLayer().Size(), platforms.size() - 1);
+    EXPECT_TRUE(world.IsValid(ball));
+}
+
+TEST(StaticLayerTest, WorldsAgreeAcrossBroadphases) {
+    PhysicsWorld grid, brute, sap;
+    brute.SetBroadphase(BroadphaseType::BruteForce);
+    sap.SetBroadphase(BroadphaseType::SweepAndPrune);
+    std::vector<BodyHandle> platforms;
+    for (PhysicsWorld* world : {&grid, &brute, &sap}) FillPlatforms(*world, platforms);
+
+    for (int s = 0; s < 120; ++s) {
+        for (PhysicsWorld* world : {&grid, &brute, &sap}) world->Step(1.f / 240.f);
+    }
+
+    ASSERT_FALSE(grid.GetContacts().empty());
+    for (std::uint32_t i = 0; i < grid.GetBodyCount(); ++i) {
+        EXPECT_EQ(grid.GetBodies().positions[i], brute.GetBodies().positions[i]);
+        EXPECT_EQ(grid.GetBodies().positions[i], sap.GetBodies().positions[i]);
+    }
+}
+
+TEST(StaticLayerTest, MovedPlatformIsHitWhereItIsNow) {
+    PhysicsWorld world;
+    BodyHandle floor = world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(100.f, 20.f)});
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .bounciness = 0.f, .collider = MakeCircleCollider(10.f)});
+
+    for (int i = 0; i < 480; ++i) world.Step(1.f / 240.f);
+    EXPECT_NEAR(world.GetPosition(ball).y, 80.f, 1.f);   // resting on the floor
+
+    world.SetPosition(floor, {0.f, 300.f});
+    for (int i = 0; i < 480; ++i) world.Step(1.f / 240.f);
+    EXPECT_NEAR(world.GetPosition(ball).y, 280.f, 1.f);
+
+    world.RemoveBody(floor);
+    for (int i = 0; i < 120; ++i) world.Step(1.f / 240.f);
+    EXPECT_GT(world.GetPosition(ball).y, 300.f);
+}
+
+// ============ QUERIES ============
+
+static void FillQueryWorld(PhysicsWorld& world, std::vector<BodyHandle>& balls, BodyHandle& box) {
+    balls.clear();
+    for (int i = 0; i < 10; ++i) {
+        balls.push_back(world.AddBody({.position = {static_cast<float>(i) * 100.f, 0.f}, .isStatic = true,
+                                       .collider = MakeCircleCollider(10.f)}));
+    }
+    box = world.AddBody({.position = {500.f, 200.f}, .isStatic = true, .collider = MakeAABBCollider(100.f, 40.f)});
+    world.AddBody({.position = {300.f, 0.f}});   // no collider, never hit
+}
+
+TEST(QueryTest, PointHitsOnlyTheShapeUnderIt) {
+    std::vector<BodyHandle> balls;
+    BodyHandle box;
+    PhysicsWorld world;
+    FillQueryWorld(world, balls, box);
+    std::vector<BodyHandle> hits;
+
+    EXPECT_EQ(world.QueryPoint({305.f, 5.f}, hits), 1u);
+    EXPECT_EQ(hits[0], balls[3]);
+    EXPECT_EQ(world.QueryPoint({309.f, 9.f}, hits), 0u);   // inside the bounds, outside the circle
+    EXPECT_EQ(world.QueryPoint({540.f, 215.f}, hits), 1u);
+    EXPECT_EQ(hits[0], box);
+}
+
+TEST(QueryTest, AABBAndRadiusMatchBruteForce) {
+    std::vector<BodyHandle> balls;
+    BodyHandle box;
+    PhysicsWorld grid, brute;
+    FillQueryWorld(grid, balls, box);
+    FillQueryWorld(brute, balls, box);
+    brute.SetBroadphase(BroadphaseType::BruteForce);
+
+    std::vector<BodyHandle> a, b;
+    for (float x = -50.f; x < 1000.f; x += 37.f) {
+        grid.QueryAABB({x, -20.f}, {x + 150.f, 190.f}, a);
+        brute.QueryAABB({x, -20.f}, {x + 150.f, 190.f}, b);
+        EXPECT_EQ(a, b) << "aabb at " << x;
+
+        grid.QueryRadius({x, 100.f}, 120.f, a);
+        brute.QueryRadius({x, 100.f}, 120.f, b);
+        EXPECT_EQ(a, b) << "radius at " << x;
+    }
+
+    EXPECT_EQ(grid.QueryAABB({-1000.f, -1000.f}, {2000.f, 2000.f}, a), 11u);   // huge box takes the plain loop
+}
+
+TEST(QueryTest, QueriesSeeBodiesAfterTheyMove) {
+    PhysicsWorld world;
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    std::vector<BodyHandle> hits;
+    ASSERT_EQ(world.QueryPoint({0.f, 0.f}, hits), 1u);
+
+    for (int i = 0; i < 60; ++i) world.Step(1.f / 60.f);
+
+    const sf::Vector2f now = world.GetPosition(ball);
+    EXPECT_EQ(world.QueryPoint({0.f, 0.f}, hits), 0u);
+    EXPECT_EQ(world.QueryPoint(now, hits), 1u);
+}
+
+// After a Step queries reuse the grid FindPairs built, from before resolve pushed the
+// bodies apart; the answers have to match a grid rebuilt from where they are now
+TEST(QueryTest, QueriesAfterStepMatchARebuild) {
+    PhysicsWorld world;
+    world.AddBody({.position = {0.f, 120.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+    BodyHandle anchor = world.AddBody({.position = {1000.f, 0.f}, .isStatic = true, .collider = MakeCircleCollider(1.f)});
+    for (int i = 0; i < 12; ++i) {
+        const float x = -60.f + 11.f * static_cast<float>(i);
+        if (i % 2) world.AddBody({.position = {x, 100.f}, .collider = MakeAABBCollider(20.f, 20.f)});
+        else world.AddBody({.position = {x, 95.f}, .collider = MakeCircleCollider(10.f)});
+    }
+    world.Step(1.f / 60.f);   // heavily overlapping, resolve moves everything
+
+    std::vector<std::vector<BodyHandle>> before;
+    std::vector<BodyHandle> hits;
+    for (float x = -80.f; x < 80.f; x += 3.f) {
+        world.QueryPoint({x, 95.f}, hits);
+        before.push_back(hits);
+        world.QueryAABB({x, 80.f}, {x + 4.f, 84.f}, hits);
+        before.push_back(hits);
+    }
+
+    world.SetPosition(anchor, {1000.f, 0.f});   // marks the queries stale -> full rebuild
+    std::size_t k = 0;
+    for (float x = -80.f; x < 80.f; x += 3.f) {
+        world.QueryPoint({x, 95.f}, hits);
+        EXPECT_EQ(hits, before[k++]) << "point at " << x;
+        world.QueryAABB({x, 80.f}, {x + 4.f, 84.f}, hits);
+        EXPECT_EQ(hits, before[k++]) << "aabb at " << x;
+    }
+}
+
+TEST(QueryTest, RaycastReturnsClosestHit) {
+    std::vector<BodyHandle> balls;
+    BodyHandle box;
+    PhysicsWorld world;
+    FillQueryWorld(world, balls, box);
+    RaycastHit hit;
+
+    ASSERT_TRUE(world.Raycast({150.f, 0.f}, {1.f, 0.f}, 1000.f, hit));
+    EXPECT_EQ(hit.body, balls[2]);
+    EXPECT_NEAR(hit.distance, 40.f, 1e-3f);
+    EXPECT_NEAR(hit.normal.x, -1.f, 1e-3f);
+
+    ASSERT_TRUE(world.Raycast({500.f, 400.f}, {0.f, -2.f}, 1000.f, hit));   // not normalized
+    EXPECT_EQ(hit.body, box);
+    EXPECT_NEAR(hit.point.y, 220.f, 1e-3f);
+    EXPECT_NEAR(hit.normal.y, 1.f, 1e-3f);
+
+    EXPECT_FALSE(world.Raycast({150.f, 0.f}, {1.f, 0.f}, 30.f, hit));     // too short
+    EXPECT_FALSE(world.Raycast({150.f, 50.f}, {1.f, 0.f}, 1000.f, hit));  // passes between
+}
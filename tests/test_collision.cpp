@@ -159,3 +159,300 @@ TEST(ColliderTest, GetWrongColliderTypeReturnsNull) {
     EXPECT_NE(obj.GetCircleCollider(), nullptr);
 }
 
+
+TEST(ColliderTest, NoColliderByDefault) {
+    Object obj;
+    
+    EXPECT_FALSE(obj.collider);
+    EXPECT_EQ(obj.GetCircleCollider(), nullptr);
+    EXPECT_EQ(obj.GetAABBCollider(), nullptr);
+}
+
+TEST(ColliderTest, ColliderIsStoredByValue) {
+    Object a;
+    a.SetAABBCollider(40.f, 20.f);
+    
+    Object b = a;  // plain copy, no shared pointer
+    b.SetCircleCollider(5.f);
+    
+    ASSERT_NE(a.GetAABBCollider(), nullptr);
+    EXPECT_FLOAT_EQ(a.GetAABBCollider()->halfExtents.x, 20.f);
+    EXPECT_FLOAT_EQ(b.GetCircleCollider()->radius, 5.f);
+    EXPECT_FLOAT_EQ(a.collider.HalfExtents().y, 10.f);
+}
+
+// ============ NARROWPHASE TESTS ============
+
+TEST(NarrowphaseTest, DetectionDoesNotMoveBodies) {
+    BodyStore bodies;
+    bodies.Add({.position = {0.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+    bodies.Add({.position = {15.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+
+    Contact contact;
+    ASSERT_TRUE(DetectContact(bodies, 0, 1, contact));
+    EXPECT_EQ(contact.type, ContactType::CircleCircle);
+    EXPECT_FLOAT_EQ(contact.normal.x, 1.f);
+    EXPECT_FLOAT_EQ(contact.penetration, 5.f);
+    EXPECT_FLOAT_EQ(bodies.positions[1].x, 15.f);
+}
+
+TEST(NarrowphaseTest, BoxCirclePairPutsCircleFirst) {
+    BodyStore bodies;
+    bodies.Add({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(200.f, 20.f)});
+    bodies.Add({.position = {0.f, 85.f}, .collider = MakeCircleCollider(10.f)});
+
+    Contact contact;
+    ASSERT_TRUE(DetectContact(bodies, 0, 1, contact));
+    EXPECT_EQ(contact.type, ContactType::CircleAABB);
+    EXPECT_EQ(contact.bodyA, 1u);
+    EXPECT_FLOAT_EQ(contact.normal.y, 1.f);   // circle -> box (down into the floor)
+    EXPECT_NEAR(contact.penetration, 5.f, 0.001f);
+}
+
+TEST(NarrowphaseTest, PairsAreSortedIntoShapeBatches) {
+    BodyStore bodies;
+    bodies.Add({.position = {0.f, 0.f}, .collider = MakeAABBCollider(10.f, 10.f)});    // 0 box
+    bodies.Add({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});         // 1 circle
+    bodies.Add({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});         // 2 circle
+    bodies.Add({.position = {0.f, 0.f}, .collider = Collider{}});                       // 3 no collider
+
+    std::vector<BodyPair> pairs = {{0, 1}, {1, 2}, {0, 3}, {1, 0}, {0, 0}};
+    PairBatches batches;
+    SortPairsByShape(bodies, pairs, batches);
+
+    auto batch = [&](ContactType type) { return batches.views[static_cast<std::size_t>(type)]; };
+    ASSERT_EQ(batch(ContactType::CircleCircle).size(), 1u);
+    ASSERT_EQ(batch(ContactType::CircleAABB).size(), 2u);
+    ASSERT_EQ(batch(ContactType::AABBAABB).size(), 1u);
+    EXPECT_EQ(batches.Size(), 4u);   // the one without a collider is dropped
+
+    // Circle first in every CircleAABB pair, input order kept
+    EXPECT_EQ(batch(ContactType::CircleAABB)[0].a, 1u);
+    EXPECT_EQ(batch(ContactType::CircleAABB)[0].b, 0u);
+    EXPECT_EQ(batch(ContactType::CircleAABB)[1].a, 1u);
+    EXPECT_EQ(batch(ContactType::CircleAABB)[1].b, 0u);
+}
+
+TEST(NarrowphaseTest, SingleBatchIsAViewOfThePairs) {
+    BodyStore bodies;
+    for (int i = 0; i < 3; ++i) bodies.Add({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    bodies.Add({.position = {0.f, 0.f}, .collider = MakeAABBCollider(10.f, 10.f)});   // 3 box
+
+    std::vector<BodyPair> pairs = {{0, 1}, {0, 2}, {1, 2}};
+    PairBatches batches;
+    SortPairsByShape(bodies, pairs, batches);
+
+    const auto circles = batches.views[static_cast<std::size_t>(ContactType::CircleCircle)];
+    EXPECT_EQ(circles.data(), pairs.data());   // nothing copied
+    EXPECT_EQ(circles.size(), 3u);
+    EXPECT_EQ(batches.Size(), 3u);
+
+    // A run of one batch, then something else: the run keeps its place ahead of the rest
+    pairs = {{0, 1}, {0, 2}, {0, 3}, {1, 2}};
+    SortPairsByShape(bodies, pairs, batches);
+    const auto sorted = batches.views[static_cast<std::size_t>(ContactType::CircleCircle)];
+    ASSERT_EQ(sorted.size(), 3u);
+    EXPECT_NE(sorted.data(), pairs.data());
+    EXPECT_EQ(sorted[1].b, 2u);
+    EXPECT_EQ(sorted[2].a, 1u);
+    EXPECT_EQ(batches.views[static_cast<std::size_t>(ContactType::CircleAABB)].size(), 1u);
+    EXPECT_EQ(batches.Size(), 4u);
+}
+
+TEST(NarrowphaseTest, StepContactsAreGroupedByType) {
+    PhysicsWorld world;
+    world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+    for (int i = 0; i < 10; ++i) {
+        Collider collider = (i % 3 == 0) ? MakeAABBCollider(12.f, 12.f) : MakeCircleCollider(8.f);
+        world.AddBody({.position = {-100.f + i * 14.f, 86.f}, .collider = collider});
+    }
+
+    world.Step(1.f / 120.f);
+
+    const auto& contacts = world.GetContacts();
+    ASSERT_FALSE(contacts.empty());
+    for (std::size_t i = 1; i < contacts.size(); ++i) {
+        EXPECT_LE(contacts[i - 1].type, contacts[i].type);
+    }
+}
+
+std::vector<sf::Vector2f> RunPile(bool parallel, unsigned threads) {
+    PhysicsWorld world;
+    world.SetParallelNarrowphase(parallel);
+    world.SetThreadCount(threads);
+
+    world.AddBody({.position = {500.f, 620.f}, .isStatic = true, .collider = MakeAABBCollider(1000.f, 40.f)});
+    std::vector<BodyHandle> balls;
+    for (int i = 0; i < 2000; ++i) {
+        sf::Vector2f pos = {20.f + (i % 80) * 12.f + (i / 80 % 2) * 5.f, 600.f - (i / 80) * 12.f};
+        Collider collider = (i % 7 == 0) ? MakeAABBCollider(12.f, 12.f) : MakeCircleCollider(7.f);
+        balls.push_back(world.AddBody({.position = pos, .collider = collider}));
+    }
+
+    for (int i = 0; i < 30; ++i) world.Step(1.f / 120.f);
+
+    std::vector<sf::Vector2f> result;
+    for (BodyHandle b : balls) result.push_back(world.GetPosition(b));
+    return result;
+}
+
+TEST(NarrowphaseTest, ParallelMatchesSerialExactly) {
+    auto serial = RunPile(false, 1);
+    auto parallel = RunPile(true, 4);
+
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].x, parallel[i].x);
+        EXPECT_EQ(serial[i].y, parallel[i].y);
+    }
+}
+
+TEST(NarrowphaseTest, ContactsAreExposedAfterStep) {
+    PhysicsWorld world;
+    world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+    world.AddBody({.position = {15.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+    world.AddBody({.position = {500.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+
+    world.Step(1.f / 60.f);
+
+    ASSERT_EQ(world.GetContacts().size(), 1u);
+    EXPECT_EQ(world.GetContacts()[0].bodyA, 0u);
+    EXPECT_EQ(world.GetContacts()[0].bodyB, 1u);
+}
+
+TEST(NarrowphaseTest, ContactBufferIsReused) {
+    PhysicsWorld world;
+    world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+    for (int i = 0; i < 10; ++i) {
+        world.AddBody({.position = {-100.f + i * 20.f, 85.f}, .collider = MakeCircleCollider(8.f)});
+    }
+
+    for (int i = 0; i < 30; ++i) world.Step(1.f / 120.f);
+    const Contact* buffer = world.GetContacts().data();
+    ASSERT_FALSE(world.GetContacts().empty());
+
+    for (int i = 0; i < 30; ++i) world.Step(1.f / 120.f);
+    EXPECT_EQ(world.GetContacts().data(), buffer);
+}
+
+// Row of overlapping circles against a static box, returns the total overlap left after one Step
+float RemainingOverlap(int contactIterations) {
+    PhysicsWorld world;
+    world.SetContactIterations(contactIterations);
+    world.AddBody({.position = {0.f, 0.f}, .isStatic = true, .collider = MakeAABBCollider(20.f, 200.f)});
+    for (int i = 0; i < 6; ++i) {
+        world.AddBody({.position = {16.f + i * 14.f, 0.f}, .collider = MakeCircleCollider(8.f)});
+    }
+
+    world.Step(1.f / 120.f);
+
+    float total = 0.f;
+    Contact contact;
+    const BodyStore& bodies = world.GetBodies();
+    for (std::uint32_t a = 0; a < bodies.Size(); ++a) {
+        for (std::uint32_t b = a + 1; b < bodies.Size(); ++b) {
+            if (DetectContact(bodies, a, b, contact)) total += contact.penetration;
+        }
+    }
+    return total;
+}
+
+TEST(NarrowphaseTest, MoreContactIterationsLeaveLessOverlap) {
+    float single = RemainingOverlap(1);
+    float several = RemainingOverlap(8);
+
+    EXPECT_GT(single, 0.f);
+    EXPECT_LT(several, single * 0.75f);
+}
+
+// ============ CONTINUOUS COLLISION ============
+
+// One fixed step of 1/60 with the ball at 6000 units/s: 100 units per step past a 4 unit floor
+static bool FastBallFallsThrough(bool ccd) {
+    PhysicsWorld world;
+    world.SetContinuousCollision(ccd);
+    world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 4.f)});
+    BodyHandle ball = world.AddBody({.position = {0.f, 30.f}, .collider = MakeCircleCollider(3.f)});
+    world.SetVelocity(ball, {0.f, 6000.f}, 1.f / 60.f);
+    for (int i = 0; i < 20; ++i) world.Step(1.f / 60.f);
+    return world.GetPosition(ball).y > 100.f;
+}
+
+TEST(ContinuousCollisionTest, FastCircleStopsAtThinAABB) {
+    EXPECT_TRUE(FastBallFallsThrough(false));
+    EXPECT_FALSE(FastBallFallsThrough(true));
+}
+
+TEST(ContinuousCollisionTest, StopsAtTimeOfImpactAndBounces) {
+    PhysicsWorld world;
+    world.SetContinuousCollision(true);
+    world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 4.f)});
+    BodyHandle ball = world.AddBody({.position = {0.f, 30.f}, .collider = MakeCircleCollider(3.f)});
+    world.SetVelocity(ball, {0.f, 6000.f}, 1.f / 60.f);
+    world.Step(1.f / 60.f);
+
+    // Touching the top of the floor (98 - radius), now heading back up
+    EXPECT_EQ(world.GetSweptCount(), 1u);
+    EXPECT_NEAR(world.GetPosition(ball).y, 95.f, 0.01f);
+    const BodyStore& bodies = world.GetBodies();
+    const std::uint32_t index = bodies.IndexOf(ball);
+    EXPECT_LT(bodies.positions[index].y - bodies.oldPositions[index].y, 0.f);
+    ASSERT_EQ(world.GetContacts().size(), 1u);
+    EXPECT_FLOAT_EQ(world.GetContacts()[0].normal.y, 1.f);   // circle -> box
+}
+
+TEST(ContinuousCollisionTest, FastCirclesDontPassThroughEachOther) {
+    auto crossed = [](bool ccd) {
+        PhysicsWorld world;
+        world.SetContinuousCollision(ccd);
+        BodyHandle a = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(4.f)});
+        BodyHandle b = world.AddBody({.position = {50.f, 0.f}, .collider = MakeCircleCollider(4.f)});
+        world.SetVelocity(a, {1800.f, 0.f}, 1.f / 60.f);    // 30 per step each way
+        world.SetVelocity(b, {-1800.f, 0.f}, 1.f / 60.f);
+        for (int i = 0; i < 3; ++i) world.Step(1.f / 60.f);
+        return world.GetPosition(a).x > world.GetPosition(b).x;
+    };
+
+    EXPECT_TRUE(crossed(false));
+    EXPECT_FALSE(crossed(true));
+}
+
+// Clipping a box corner diagonally: the contact normal comes from the rounded corner
+TEST(ContinuousCollisionTest, CornerHitUsesCornerNormal) {
+    PhysicsWorld world;
+    world.SetContinuousCollision(true);
+    world.AddBody({.position = {0.f, 0.f}, .isStatic = true, .collider = MakeAABBCollider(20.f, 20.f)});
+    BodyHandle ball = world.AddBody({.position = {-60.f, -60.f}, .collider = MakeCircleCollider(4.f)});
+    world.SetVelocity(ball, {6000.f, 6000.f}, 1.f / 60.f);   // straight through the box in one step
+    world.Step(1.f / 60.f);
+
+    ASSERT_EQ(world.GetSweptCount(), 1u);
+    ASSERT_FALSE(world.GetContacts().empty());
+    const sf::Vector2f normal = world.GetContacts()[0].normal;
+    EXPECT_NEAR(normal.x, normal.y, 0.05f);
+    EXPECT_GT(normal.x, 0.5f);
+    EXPECT_LT(world.GetPosition(ball).x, -10.f);
+}
+
+// Slow bodies are under the threshold, so CCD on changes nothing for them
+TEST(ContinuousCollisionTest, SlowBodiesUnaffected) {
+    auto run = [](bool ccd) {
+        PhysicsWorld world;
+        world.SetContinuousCollision(ccd);
+        world.AddBody({.position = {0.f, 200.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+        for (int i = 0; i < 40; ++i) {
+            world.AddBody({.position = {-100.f + (i % 10) * 20.f, 150.f - (i / 10) * 20.f}, .collider = MakeCircleCollider(8.f)});
+        }
+        for (int i = 0; i < 120; ++i) world.Step(1.f / 480.f);
+        EXPECT_EQ(world.GetSweptCount(), 0u);
+        return world.GetBodies().positions;
+    };
+
+    const auto without = run(false);
+    const auto with = run(true);
+    ASSERT_EQ(with.size(), without.size());
+    for (std::size_t i = 0; i < with.size(); ++i) {
+        EXPECT_EQ(with[i].x, without[i].x);
+        EXPECT_EQ(with[i].y, without[i].y);
+    }
+}
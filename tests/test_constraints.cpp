@@ -221,3 +221,306 @@ TEST(PhysicsWorldConstraints, ConstraintsAreSolved) {
     EXPECT_NEAR(dist, 100.f, 5.f);  // Allow some tolerance due to gravity
 }
 
+
+// ============ PARALLEL (COLORED) SOLVER TESTS ============
+
+// size x size grid of bodies linked to their right/bottom neighbours, top row pinned
+std::vector<BodyHandle> BuildCloth(PhysicsWorld& world, int size, float spacing) {
+    std::vector<BodyHandle> bodies;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            BodyDesc desc;
+            desc.position = {100.f + x * spacing, 100.f + y * spacing};
+            bodies.push_back(world.AddBody(desc));
+        }
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            BodyHandle b = bodies[y * size + x];
+            if (x + 1 < size) world.AddDistanceConstraint(b, bodies[y * size + x + 1]);
+            if (y + 1 < size) world.AddDistanceConstraint(b, bodies[(y + 1) * size + x]);
+        }
+    }
+    for (int x = 0; x < size; ++x) {
+        world.AddPinConstraint(bodies[x], world.GetPosition(bodies[x]));
+    }
+    return bodies;
+}
+
+std::vector<sf::Vector2f> RunCloth(ConstraintSolverMode mode, unsigned threads) {
+    PhysicsWorld world;
+    world.SetConstraintSolverMode(mode);
+    world.SetThreadCount(threads);
+    auto bodies = BuildCloth(world, 30, 10.f);
+
+    for (int i = 0; i < 20; ++i) {
+        world.Step(1.f / 480.f);
+    }
+
+    std::vector<sf::Vector2f> result;
+    for (BodyHandle b : bodies) result.push_back(world.GetPosition(b));
+    return result;
+}
+
+TEST(ParallelConstraintSolver, GridNeedsFewColors) {
+    PhysicsWorld world;
+    BuildCloth(world, 10, 10.f);
+
+    // Horizontal + vertical links, pins on top: greedy coloring should manage with few
+    EXPECT_GE(world.GetConstraintColorCount(), 2u);
+    EXPECT_LE(world.GetConstraintColorCount(), 5u);
+}
+
+TEST(ParallelConstraintSolver, DeterministicAcrossThreadCounts) {
+    auto one = RunCloth(ConstraintSolverMode::ParallelColored, 1);
+    auto two = RunCloth(ConstraintSolverMode::ParallelColored, 2);
+    auto four = RunCloth(ConstraintSolverMode::ParallelColored, 4);
+
+    ASSERT_EQ(one.size(), four.size());
+    for (size_t i = 0; i < one.size(); ++i) {
+        EXPECT_EQ(one[i], two[i]) << "body " << i;
+        EXPECT_EQ(one[i], four[i]) << "body " << i;
+    }
+}
+
+TEST(ParallelConstraintSolver, HoldsClothTogetherLikeSequential) {
+    auto sequential = RunCloth(ConstraintSolverMode::Sequential, 1);
+    auto colored = RunCloth(ConstraintSolverMode::ParallelColored, 4);
+
+    // Different solve order, so not identical - but close
+    for (size_t i = 0; i < sequential.size(); ++i) {
+        EXPECT_NEAR(colored[i].x, sequential[i].x, 2.f);
+        EXPECT_NEAR(colored[i].y, sequential[i].y, 2.f);
+    }
+}
+
+TEST(JacobiConstraintSolver, DeterministicAcrossThreadCounts) {
+    auto one = RunCloth(ConstraintSolverMode::Jacobi, 1);
+    auto four = RunCloth(ConstraintSolverMode::Jacobi, 4);
+
+    ASSERT_EQ(one.size(), four.size());
+    for (size_t i = 0; i < one.size(); ++i) {
+        EXPECT_EQ(one[i], four[i]) << "body " << i;
+    }
+}
+
+TEST(JacobiConstraintSolver, HoldsClothTogetherLikeSequential) {
+    auto sequential = RunCloth(ConstraintSolverMode::Sequential, 1);
+    auto jacobi = RunCloth(ConstraintSolverMode::Jacobi, 4);
+
+    // Averaging converges slower than Gauss-Seidel, but the cloth still hangs the same
+    for (size_t i = 0; i < sequential.size(); ++i) {
+        EXPECT_NEAR(jacobi[i].x, sequential[i].x, 2.f);
+        EXPECT_NEAR(jacobi[i].y, sequential[i].y, 2.f);
+    }
+}
+
+TEST(JacobiConstraintSolver, OverRelaxationConvergesFaster) {
+    // One stretched link between two free bodies: both move halfway per iteration
+    auto stretch = [](float relaxation) {
+        PhysicsWorld world;   // gravity moves all three the same, lengths don't care
+        world.SetConstraintSolverMode(ConstraintSolverMode::Jacobi);
+        world.SetJacobiRelaxation(relaxation);
+        world.SetConstraintIterations(1);
+        BodyHandle a = world.AddBody({.position = {0.f, 0.f}});
+        BodyHandle b = world.AddBody({.position = {10.f, 0.f}});
+        BodyHandle c = world.AddBody({.position = {40.f, 0.f}});   // 20 units too long in total
+        world.AddDistanceConstraint(a, b, 10.f);
+        world.AddDistanceConstraint(b, c, 10.f);
+        world.Step(1.f / 480.f);
+        sf::Vector2f d = world.GetPosition(c) - world.GetPosition(a);
+        return std::abs(std::sqrt(d.x * d.x + d.y * d.y) - 20.f);
+    };
+
+    EXPECT_LT(stretch(1.5f), stretch(1.f));
+}
+
+TEST(JacobiConstraintSolver, PinsStillEndOnTheirAnchor) {
+    PhysicsWorld world;
+    world.SetConstraintSolverMode(ConstraintSolverMode::Jacobi);
+    auto bodies = BuildCloth(world, 8, 10.f);
+    for (int i = 0; i < 30; ++i) world.Step(1.f / 480.f);
+
+    for (int x = 0; x < 8; ++x) {
+        EXPECT_EQ(world.GetPosition(bodies[x]), sf::Vector2f(100.f + static_cast<float>(x) * 10.f, 100.f));
+    }
+}
+
+// ============ XPBD + EARLY EXIT TESTS ============
+
+// Chain of 10 hanging from a static body; returns how far the end sags past the rest
+// length, averaged over the last 200 steps so the bounce doesn't matter
+float ChainSag(int iterations, bool xpbd) {
+    PhysicsWorld world;
+    world.SetConstraintIterations(iterations);
+    world.SetXPBDEnabled(xpbd);
+
+    BodyHandle previous = world.AddBody({.position = {0.f, 0.f}, .isStatic = true});
+    for (int i = 1; i <= 10; ++i) {
+        BodyHandle body = world.AddBody({.position = {0.f, static_cast<float>(i) * 10.f}});
+        DistanceConstraint* c = world.AddDistanceConstraint(previous, body, 10.f);
+        c->stiffness = 0.1f;
+        c->compliance = 1e-4f;
+        previous = body;
+    }
+
+    float sag = 0.f;
+    for (int i = 0; i < 1200; ++i) {
+        world.Step(1.f / 480.f);
+        if (i >= 1000) sag += world.GetPosition(previous).y - 100.f;
+    }
+    return sag / 200.f;
+}
+
+TEST(XPBDConstraints, StiffnessDoesNotDependOnIterations) {
+    const float pbdFew = ChainSag(4, false);
+    const float pbdMany = ChainSag(16, false);
+    const float xpbdFew = ChainSag(4, true);
+    const float xpbdMany = ChainSag(16, true);
+
+    // Stiffness-based: more iterations = visibly stiffer chain
+    EXPECT_GT(pbdFew, pbdMany * 1.5f);
+    // Compliance-based: about the same sag either way
+    EXPECT_GT(xpbdMany, 0.f);
+    EXPECT_NEAR(xpbdFew, xpbdMany, xpbdMany * 0.25f);
+}
+
+TEST(XPBDConstraints, ZeroComplianceIsRigid) {
+    PhysicsWorld world;
+    world.SetXPBDEnabled(true);
+    BodyHandle anchor = world.AddBody({.position = {0.f, 0.f}, .isStatic = true});
+    BodyHandle bob = world.AddBody({.position = {30.f, 0.f}});
+    world.AddDistanceConstraint(anchor, bob, 30.f);
+
+    for (int i = 0; i < 480; ++i) world.Step(1.f / 480.f);
+    sf::Vector2f d = world.GetPosition(bob) - world.GetPosition(anchor);
+    EXPECT_NEAR(std::sqrt(d.x * d.x + d.y * d.y), 30.f, 0.01f);
+}
+
+TEST(ConstraintEarlyExit, ConvergedSceneRunsFewerIterations) {
+    PhysicsWorld world;
+    world.SetConstraintIterations(20);
+    world.SetConstraintTolerance(0.05f);
+    auto bodies = BuildCloth(world, 10, 10.f);
+    (void)bodies;
+
+    // Starts exactly at rest length, so there's hardly anything to fix
+    for (int i = 0; i < 10; ++i) world.Step(1.f / 480.f);
+    EXPECT_LT(world.GetLastConstraintIterations(), 20);
+    EXPECT_GE(world.GetLastConstraintIterations(), 1);
+
+    world.SetConstraintTolerance(0.f);
+    world.Step(1.f / 480.f);
+    EXPECT_EQ(world.GetLastConstraintIterations(), 20);
+}
+
+TEST(ConstraintEarlyExit, StretchedSceneUsesAllIterations) {
+    for (ConstraintSolverMode mode : {ConstraintSolverMode::Sequential, ConstraintSolverMode::ParallelColored,
+                                      ConstraintSolverMode::Jacobi}) {
+        PhysicsWorld world;
+        world.SetConstraintSolverMode(mode);
+        world.SetThreadCount(2);
+        world.SetConstraintIterations(8);
+        world.SetConstraintTolerance(1e-3f);
+
+        BodyHandle previous = world.AddBody({.position = {0.f, 0.f}, .isStatic = true});
+        for (int i = 1; i <= 10; ++i) {
+            BodyHandle body = world.AddBody({.position = {static_cast<float>(i) * 20.f, 0.f}});
+            world.AddDistanceConstraint(previous, body, 10.f);   // twice too long
+            previous = body;
+        }
+        world.Step(1.f / 480.f);
+        EXPECT_EQ(world.GetLastConstraintIterations(), 8) << static_cast<int>(mode);
+    }
+}
+
+// ============ CONSTRAINT STORAGE TESTS ============
+
+TEST(ConstraintStorage, PointersStayValidAsMoreAreAdded) {
+    PhysicsWorld world;
+    BodyHandle a = world.AddBody({});
+    BodyHandle b = world.AddBody({});
+
+    SpringConstraint* first = world.AddSpringConstraint(a, b, 0.3f, 0.05f);
+    for (int i = 0; i < 2000; ++i) {
+        world.AddDistanceConstraint(a, b, 10.f);
+        world.AddSpringConstraint(a, b, 0.1f, 0.f);
+    }
+
+    EXPECT_FLOAT_EQ(first->stiffness, 0.3f);
+    EXPECT_FLOAT_EQ(first->damping, 0.05f);
+    EXPECT_EQ(world.GetConstraintCount(), 4001u);
+}
+
+TEST(ConstraintStorage, RemoveAndReuse) {
+    PhysicsWorld world;
+    BodyHandle a = world.AddBody({});
+    BodyHandle b = world.AddBody({});
+
+    DistanceConstraint* c1 = world.AddDistanceConstraint(a, b, 10.f);
+    DistanceConstraint* c2 = world.AddDistanceConstraint(a, b, 20.f);
+    world.RemoveConstraint(c1);
+    EXPECT_EQ(world.GetConstraintCount(), 1u);
+    EXPECT_FLOAT_EQ(c2->restLength, 20.f);
+
+    // Through the base pointer too
+    Constraint* base = c2;
+    world.RemoveConstraint(base);
+    EXPECT_EQ(world.GetConstraintCount(), 0u);
+}
+
+// Keeps a body on or above a line, registered without inheriting from Constraint
+struct FloorConstraint {
+    BodyHandle body;
+    float floorY;
+
+    void Solve(BodyStore& bodies) {
+        std::uint32_t i = bodies.IndexOf(body);
+        if (i == BodyStore::InvalidIndex) return;
+        if (bodies.positions[i].y > floorY) bodies.positions[i].y = floorY;
+    }
+};
+
+TEST(ConstraintStorage, CustomConstraintType) {
+    PhysicsWorld world;
+    world.RegisterConstraintType<FloorConstraint>();
+
+    BodyDesc desc;
+    desc.position = {0.f, 0.f};
+    BodyHandle ball = world.AddBody(desc);
+    FloorConstraint* floor = world.AddConstraint(FloorConstraint{ball, 50.f});
+
+    for (int i = 0; i < 120; ++i) {
+        world.Step(1.f / 60.f);
+    }
+    EXPECT_FLOAT_EQ(world.GetPosition(ball).y, 50.f);
+
+    world.RemoveConstraint(floor);
+    EXPECT_EQ(world.GetConstraintCount(), 0u);
+}
+
+TEST(ConstraintStorage, UniquePtrCompatOverload) {
+    PhysicsWorld world;
+
+    BodyDesc desc;
+    desc.position = {0.f, 0.f};
+    desc.isStatic = true;
+    BodyHandle pivot = world.AddBody(desc);
+    desc.position = {30.f, 0.f};
+    desc.isStatic = false;
+    BodyHandle bob = world.AddBody(desc);
+
+    std::unique_ptr<Constraint> link = std::make_unique<DistanceConstraint>(pivot, bob, 30.f, 1.0f);
+    Constraint* stored = world.AddConstraint(std::move(link));
+    ASSERT_NE(stored, nullptr);
+    EXPECT_EQ(stored->type, ConstraintType::Distance);
+    PinConstraint* pin = world.AddConstraint(std::make_unique<PinConstraint>(bob, sf::Vector2f{30.f, 0.f}));
+    EXPECT_EQ(world.GetConstraintCount(), 2u);
+
+    world.Step(1.f / 60.f);
+    EXPECT_NEAR(world.GetPosition(bob).x, 30.f, 1e-3f);
+
+    world.RemoveConstraint(pin);
+    world.RemoveConstraint(stored);
+    EXPECT_EQ(world.GetConstraintCount(), 0u);
+}
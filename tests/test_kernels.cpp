@@ -0,0 +1,65 @@
+//SIMD Verlet kernel has to match the scalar loop
+
+#include <gtest/gtest.h>
+#include "VerletKernels.h"
+#include <random>
+#include <vector>
+
+struct KernelBodies {
+    std::vector<sf::Vector2f> pos, old, acc;
+    std::vector<std::uint8_t> isStatic;
+};
+
+KernelBodies MakeKernelBodies(std::size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-500.f, 500.f);
+
+    KernelBodies b;
+    for (std::size_t i = 0; i < count; ++i) {
+        b.pos.push_back({dist(rng), dist(rng)});
+        b.old.push_back(b.pos.back() - sf::Vector2f{dist(rng) * 0.01f, dist(rng) * 0.01f});
+        b.acc.push_back({0.f, 0.f});
+        b.isStatic.push_back(i % 3 == 0 ? 1 : 0);
+    }
+    return b;
+}
+
+TEST(VerletKernelTest, MatchesScalar) {
+    // 37 -> exercises the scalar tail too
+    KernelBodies simd = MakeKernelBodies(37);
+    KernelBodies scalar = simd;
+    const sf::Vector2f gravity = {0.f, 1000.f};
+
+    for (int step = 0; step < 10; ++step) {
+        IntegrateVerlet(simd.pos.data(), simd.old.data(), simd.acc.data(), simd.isStatic.data(),
+                        simd.pos.size(), gravity, 1.f / 480.f);
+        IntegrateVerletScalar(scalar.pos.data(), scalar.old.data(), scalar.acc.data(), scalar.isStatic.data(),
+                              scalar.pos.size(), gravity, 1.f / 480.f);
+    }
+
+    for (std::size_t i = 0; i < simd.pos.size(); ++i) {
+        EXPECT_FLOAT_EQ(simd.pos[i].x, scalar.pos[i].x) << "body " << i << " (" << VerletKernelName() << ")";
+        EXPECT_FLOAT_EQ(simd.pos[i].y, scalar.pos[i].y) << "body " << i;
+        EXPECT_FLOAT_EQ(simd.old[i].y, scalar.old[i].y) << "body " << i;
+        EXPECT_FLOAT_EQ(simd.acc[i].y, scalar.acc[i].y) << "body " << i;
+    }
+}
+
+TEST(VerletKernelTest, StaticBodiesUntouched) {
+    KernelBodies b = MakeKernelBodies(16);
+    KernelBodies before = b;
+
+    IntegrateVerlet(b.pos.data(), b.old.data(), b.acc.data(), b.isStatic.data(),
+                    b.pos.size(), {0.f, 1000.f}, 1.f / 60.f);
+
+    for (std::size_t i = 0; i < b.pos.size(); ++i) {
+        if (!b.isStatic[i]) continue;
+        EXPECT_EQ(b.pos[i], before.pos[i]);
+        EXPECT_EQ(b.old[i], before.old[i]);
+        EXPECT_EQ(b.acc[i], before.acc[i]);
+    }
+}
+
+TEST(VerletKernelTest, EmptyIsFine) {
+    IntegrateVerlet(nullptr, nullptr, nullptr, nullptr, 0, {0.f, 1000.f}, 1.f / 60.f);
+}
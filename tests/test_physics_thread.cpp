@@ -0,0 +1,144 @@
+//Command queue, snapshot hand-off and the physics thread
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "PhysicsThread.h"
+
+TEST(SpscQueueTest, KeepsOrderAndReportsFull) {
+    SpscQueue<int, 4> queue;   // 3 usable slots
+    for (int i = 0; i < 3; ++i) EXPECT_TRUE(queue.TryPush(int(i)));
+    EXPECT_FALSE(queue.TryPush(99));
+
+    int value = -1;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.TryPop(value));
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SpscQueueTest, TwoThreadsSeeEveryItemInOrder) {
+    SpscQueue<int, 64> queue;
+    constexpr int Count = 100000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < Count; ++i) {
+            while (!queue.TryPush(int(i))) std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    int value;
+    while (expected < Count) {
+        if (!queue.TryPop(value)) continue;
+        ASSERT_EQ(value, expected);
+        ++expected;
+    }
+    producer.join();
+}
+
+TEST(TripleBufferTest, ReaderGetsLatestPublished) {
+    TripleBuffer<int> buffer;
+    buffer.Back() = 1;
+    buffer.Publish();
+    buffer.Back() = 2;
+    buffer.Publish();
+
+    EXPECT_EQ(buffer.Latest(), 2);   // 1 was skipped
+    EXPECT_EQ(buffer.Latest(), 2);   // nothing new -> same slot
+
+    buffer.Back() = 3;
+    buffer.Publish();
+    EXPECT_EQ(buffer.Latest(), 3);
+}
+
+TEST(PhysicsThreadTest, PumpAppliesCommandsAndPublishes) {
+    PhysicsWorld world;
+    world.SetFixedTimestep(1.f / 60.f);
+    PhysicsThread physics(world);
+
+    BodyHandle body;
+    const std::uint64_t seq = physics.Post([&](PhysicsWorld& w) {
+        body = w.AddBody({.position = {10.f, 20.f}, .collider = MakeCircleCollider(5.f)});
+    });
+    EXPECT_LT(physics.Latest().commandsApplied, seq);
+
+    physics.Pump(1.f / 60.f);
+    physics.Pump(1.f / 60.f);
+    const RenderSnapshot& snapshot = physics.Latest();
+
+    EXPECT_EQ(snapshot.commandsApplied, seq);
+    EXPECT_EQ(snapshot.steps, 2u);
+    ASSERT_TRUE(snapshot.Contains(body));
+    EXPECT_GT(snapshot.Position(body).y, 20.f);    // interpolated, so one step behind
+    EXPECT_GT(snapshot.Velocity(body).y, 0.f);
+}
+
+TEST(PhysicsThreadTest, SnapshotFindsLinkedObjects) {
+    PhysicsWorld world;
+    Object object;
+    object.position = {5.f, 5.f};
+    object.InitVerlet();
+    object.SetCircleCollider(2.f);
+    object.userData = &world;
+    world.AddObject(&object);
+
+    PhysicsThread physics(world);
+    const RenderSnapshot& snapshot = physics.Latest();
+
+    EXPECT_EQ(snapshot.FindLinked(&object), object.body);
+    EXPECT_FALSE(snapshot.FindLinked(nullptr).IsValid());
+    EXPECT_EQ(snapshot.userData[object.body.id], &world);   // copied, the render side never reads the Object
+}
+
+TEST(PhysicsThreadTest, ThreadRunsPostedCommands) {
+    PhysicsWorld world;
+    PhysicsThread physics(world);
+    physics.Start();
+    ASSERT_TRUE(physics.IsRunning());
+
+    const std::uint64_t seq = physics.Post([](PhysicsWorld& w) {
+        w.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    });
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (physics.Latest().commandsApplied < seq && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_GE(physics.Latest().commandsApplied, seq);
+    EXPECT_EQ(physics.Latest().bodyCount, 1u);
+
+    const std::uint64_t last = physics.Post([](PhysicsWorld& w) {
+        w.AddBody({.position = {50.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    });
+    physics.Stop();
+    EXPECT_FALSE(physics.IsRunning());
+    EXPECT_EQ(world.GetBodyCount(), 2u);   // safe to read again after Stop
+    EXPECT_EQ(physics.Latest().commandsApplied, last);   // Stop publishes what it applied
+    EXPECT_EQ(physics.Latest().bodyCount, 2u);
+}
+
+TEST(PhysicsThreadTest, SnapshotCarriesPickAndCullResults) {
+    PhysicsWorld world;
+    BodyHandle inside = world.AddBody({.position = {50.f, 50.f}, .isStatic = true, .collider = MakeCircleCollider(10.f)});
+    BodyHandle gone = world.AddBody({.position = {500.f, 50.f}, .collider = MakeCircleCollider(10.f)});
+    world.AddBody({.position = {900.f, 50.f}, .isStatic = true, .collider = MakeCircleCollider(10.f)});  // static, never culled
+
+    PhysicsThread physics(world);
+    physics.SetCullBounds({0.f, 0.f}, {200.f, 200.f});
+    physics.SetPickPoint({52.f, 48.f});
+    physics.Pump(0.f);
+
+    const RenderSnapshot& snapshot = physics.Latest();
+    ASSERT_EQ(snapshot.picked.size(), 1u);
+    EXPECT_EQ(snapshot.picked[0], inside);
+    ASSERT_EQ(snapshot.outside.size(), 1u);
+    EXPECT_EQ(snapshot.outside[0], gone);
+
+    physics.ClearPickPoint();
+    physics.Pump(0.f);
+    EXPECT_TRUE(physics.Latest().picked.empty());
+}
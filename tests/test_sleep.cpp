@@ -0,0 +1,192 @@
+//Sleeping bodies and islands
+
+#include <gtest/gtest.h>
+#include "PhysicsWorld.h"
+
+constexpr float SleepDt = 1.f / 480.f;
+
+// Static floor with its top edge at y = 500
+BodyHandle AddFloor(PhysicsWorld& world) {
+    return world.AddBody({.position = {0.f, 520.f}, .isStatic = true, .collider = MakeAABBCollider(1000.f, 40.f)});
+}
+
+void Settle(PhysicsWorld& world, int steps = 2000) {
+    for (int i = 0; i < steps; ++i) world.Step(SleepDt);
+}
+
+TEST(SleepTest, OffByDefault) {
+    PhysicsWorld world;
+    AddFloor(world);
+    BodyHandle ball = world.AddBody({.position = {0.f, 490.f}, .collider = MakeCircleCollider(10.f)});
+
+    Settle(world);
+
+    EXPECT_FALSE(world.IsAsleep(ball));
+    EXPECT_EQ(world.GetSleepingCount(), 0u);
+}
+
+TEST(SleepTest, RestingBallFallsAsleepAndStaysPut) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+    BodyHandle ball = world.AddBody({.position = {0.f, 480.f}, .collider = MakeCircleCollider(10.f)});
+
+    Settle(world);
+    ASSERT_TRUE(world.IsAsleep(ball));
+
+    sf::Vector2f resting = world.GetPosition(ball);
+    Settle(world, 100);
+    EXPECT_EQ(world.GetPosition(ball).x, resting.x);
+    EXPECT_EQ(world.GetPosition(ball).y, resting.y);
+    EXPECT_NEAR(resting.y, 490.f, 1.f);
+}
+
+TEST(SleepTest, FallingBallStaysAwake) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    world.SetSleepThreshold(15.f, 10);
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+
+    Settle(world, 200);
+
+    EXPECT_FALSE(world.IsAsleep(ball));
+}
+
+TEST(SleepTest, HitWakesTheWholeIsland) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+
+    // Two stacked boxes -> one island
+    BodyHandle bottom = world.AddBody({.position = {0.f, 490.f}, .collider = MakeAABBCollider(20.f, 20.f)});
+    BodyHandle top = world.AddBody({.position = {0.f, 470.f}, .collider = MakeAABBCollider(20.f, 20.f)});
+    BodyHandle loner = world.AddBody({.position = {300.f, 490.f}, .collider = MakeCircleCollider(10.f)});
+    Settle(world);
+    ASSERT_TRUE(world.IsAsleep(bottom));
+    ASSERT_TRUE(world.IsAsleep(top));
+    ASSERT_TRUE(world.IsAsleep(loner));
+
+    // Drop a ball on the top box only
+    world.AddBody({.position = {0.f, 400.f}, .collider = MakeCircleCollider(10.f)});
+    bool woke = false;
+    for (int i = 0; i < 400 && !woke; ++i) {
+        world.Step(SleepDt);
+        woke = !world.IsAsleep(top);
+        if (woke) {
+            EXPECT_FALSE(world.IsAsleep(bottom));
+        }
+    }
+
+    EXPECT_TRUE(woke);
+    EXPECT_TRUE(world.IsAsleep(loner));
+}
+
+TEST(SleepTest, ConstrainedBodiesShareAnIsland) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+
+    BodyHandle a = world.AddBody({.position = {0.f, 490.f}, .collider = MakeCircleCollider(10.f)});
+    BodyHandle b = world.AddBody({.position = {100.f, 490.f}, .collider = MakeCircleCollider(10.f)});
+    world.AddDistanceConstraint(a, b);
+    Settle(world);
+    ASSERT_TRUE(world.IsAsleep(a));
+    ASSERT_TRUE(world.IsAsleep(b));
+
+    world.WakeBody(a);
+
+    EXPECT_FALSE(world.IsAsleep(b));
+}
+
+TEST(SleepTest, MovingAnObjectWakesIt) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+
+    Object ball;
+    ball.position = {0.f, 490.f};
+    ball.InitVerlet();
+    ball.SetCircleCollider(10.f);
+    world.AddObject(&ball);
+    Settle(world);
+    ASSERT_TRUE(world.IsAsleep(ball.body));
+
+    ball.position = {0.f, 300.f};
+    ball.oldPosition = ball.position;
+    world.Step(SleepDt);
+
+    EXPECT_FALSE(world.IsAsleep(ball.body));
+    EXPECT_GT(ball.position.y, 300.f);   // falling again
+}
+
+TEST(SleepTest, NewConstraintOnlyWakesItsBodies) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+    BodyHandle left = world.AddBody({.position = {-200.f, 480.f}, .collider = MakeCircleCollider(10.f)});
+    BodyHandle right = world.AddBody({.position = {200.f, 480.f}, .collider = MakeCircleCollider(10.f)});
+    Settle(world);
+    ASSERT_TRUE(world.IsAsleep(left));
+    ASSERT_TRUE(world.IsAsleep(right));
+
+    BodyHandle anchor = world.AddBody({.position = {-200.f, 300.f}, .isStatic = true});
+    world.AddDistanceConstraint(anchor, left);
+
+    EXPECT_FALSE(world.IsAsleep(left));
+    EXPECT_TRUE(world.IsAsleep(right));
+}
+
+// Removal and reordering move bodies to new dense indices; the island lists must follow
+TEST(SleepTest, IslandsSurviveRemovalAndReorder) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+    std::vector<BodyHandle> balls;
+    for (int i = 0; i < 6; ++i) {
+        balls.push_back(world.AddBody({.position = {-300.f + 120.f * i, 480.f}, .collider = MakeCircleCollider(10.f)}));
+    }
+    world.AddDistanceConstraint(balls[4], balls[5]);
+    Settle(world);
+    ASSERT_EQ(world.GetSleepingCount(), 6u);
+
+    world.RemoveBody(balls[0]);
+    ASSERT_TRUE(world.ReorderBodies());
+    EXPECT_EQ(world.GetSleepingCount(), 5u);
+
+    world.WakeBody(balls[5]);
+    EXPECT_FALSE(world.IsAsleep(balls[4]));
+    EXPECT_FALSE(world.IsAsleep(balls[5]));
+    for (int i = 1; i < 4; ++i) EXPECT_TRUE(world.IsAsleep(balls[i]));
+    EXPECT_EQ(world.GetSleepingCount(), 3u);
+
+    // Back to sleep, and a second wake still finds the island
+    Settle(world);
+    ASSERT_EQ(world.GetSleepingCount(), 5u);
+    world.WakeBody(balls[2]);
+    EXPECT_FALSE(world.IsAsleep(balls[2]));
+    EXPECT_TRUE(world.IsAsleep(balls[4]));
+    EXPECT_EQ(world.GetSleepingCount(), 4u);
+}
+
+// Settled world: sleepers sit in the sleeping layer, which stays as it is, and nothing
+// goes through the broadphase or the narrowphase
+TEST(SleepTest, SettledWorldLeavesTheSleepingLayerAlone) {
+    PhysicsWorld world;
+    world.SetSleepEnabled(true);
+    AddFloor(world);
+    for (int i = 0; i < 20; ++i) {
+        world.AddBody({.position = {-400.f + 40.f * i, 490.f}, .collider = MakeCircleCollider(10.f)});
+    }
+    Settle(world);
+    ASSERT_EQ(world.GetSleepingCount(), 20u);
+    EXPECT_EQ(world.GetSleepingLayer().Size(), 20u);
+
+    const std::size_t rebuilds = world.GetSleepingLayerRebuilds();
+    Settle(world, 100);
+    EXPECT_EQ(world.GetSleepingLayerRebuilds(), rebuilds);
+    EXPECT_TRUE(world.GetContacts().empty());
+
+    // Still found by queries
+    std::vector<BodyHandle> hits;
+    EXPECT_EQ(world.QueryPoint(world.GetPosition(world.GetBodies().HandleAt(5)), hits), 1u);
+}
@@ -0,0 +1,137 @@
+//Binary world snapshots: save, mmap restore, bit-exact continuation
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "PhysicsWorld.h"
+
+static std::string SnapshotPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+// A bit of everything: static floor, circles, boxes, a chain, a spring and a pin
+static void BuildScene(PhysicsWorld& world) {
+    world.SetSleepEnabled(true);
+    world.SetContactIterations(2);
+    world.SetSpatialReorder(7);   // mid-interval at save time, the count has to carry over
+    world.AddBody({.position = {0.f, 520.f}, .isStatic = true, .collider = MakeAABBCollider(1000.f, 40.f)});
+    for (int i = 0; i < 40; ++i) {
+        const float x = static_cast<float>(i % 10) * 25.f - 120.f;
+        const float y = 400.f - static_cast<float>(i / 10) * 25.f;
+        world.AddBody({.position = {x, y}, .collider = i % 3 ? MakeCircleCollider(10.f) : MakeAABBCollider(18.f, 18.f)});
+    }
+
+    BodyHandle pivot = world.AddBody({.position = {300.f, 100.f}, .isStatic = true});
+    BodyHandle a = world.AddBody({.position = {330.f, 100.f}, .collider = MakeCircleCollider(5.f)});
+    BodyHandle b = world.AddBody({.position = {360.f, 90.f}, .collider = MakeCircleCollider(5.f)});
+    world.AddDistanceConstraint(pivot, a);
+    world.AddSpringConstraint(a, b, 0.4f, 0.05f);
+    world.AddPinConstraint(world.AddBody({.position = {-300.f, 50.f}, .collider = MakeCircleCollider(5.f)}), {-300.f, 40.f});
+
+    world.RemoveBody(world.AddBody({.position = {0.f, 0.f}}));   // leaves a free slot with a bumped generation
+}
+
+TEST(SnapshotTest, RestoredWorldContinuesBitExact) {
+    PhysicsWorld original;
+    BuildScene(original);
+    for (int i = 0; i < 300; ++i) original.Step(1.f / 480.f);
+
+    const std::string path = SnapshotPath("continue.pwsn");
+    ASSERT_TRUE(original.SaveSnapshot(path));
+
+    PhysicsWorld restored;
+    ASSERT_TRUE(restored.LoadSnapshot(path));
+    EXPECT_EQ(restored.GetBodyCount(), original.GetBodyCount());
+    EXPECT_EQ(restored.GetConstraintCount(), original.GetConstraintCount());
+    EXPECT_EQ(restored.GetSleepingCount(), original.GetSleepingCount());
+    EXPECT_EQ(restored.GetContactIterations(), 2);
+    EXPECT_EQ(restored.GetSpatialReorder(), 7);
+
+    for (int i = 0; i < 300; ++i) {
+        original.Step(1.f / 480.f);
+        restored.Step(1.f / 480.f);
+    }
+
+    const BodyStore& a = original.GetBodies();
+    const BodyStore& b = restored.GetBodies();
+    ASSERT_EQ(a.Size(), b.Size());
+    for (std::uint32_t i = 0; i < a.Size(); ++i) {
+        EXPECT_EQ(a.HandleAt(i), b.HandleAt(i));
+        EXPECT_EQ(a.positions[i].x, b.positions[i].x);
+        EXPECT_EQ(a.positions[i].y, b.positions[i].y);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, HandlesAndGenerationsSurvive) {
+    PhysicsWorld world;
+    BodyHandle gone = world.AddBody({.position = {1.f, 2.f}});
+    world.RemoveBody(gone);
+    BodyHandle reused = world.AddBody({.position = {3.f, 4.f}});
+    ASSERT_EQ(gone.id, reused.id);
+
+    const std::string path = SnapshotPath("handles.pwsn");
+    ASSERT_TRUE(world.SaveSnapshot(path));
+
+    PhysicsWorld restored;
+    ASSERT_TRUE(restored.LoadSnapshot(path));
+    EXPECT_FALSE(restored.IsValid(gone));
+    ASSERT_TRUE(restored.IsValid(reused));
+    EXPECT_EQ(restored.GetPosition(reused).x, 3.f);
+
+    BodyHandle next = restored.AddBody({});   // doesn't collide with a saved id
+    EXPECT_NE(next.id, reused.id);
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, LoadUnlinksObjects) {
+    PhysicsWorld empty;
+    const std::string path = SnapshotPath("empty.pwsn");
+    ASSERT_TRUE(empty.SaveSnapshot(path));
+
+    PhysicsWorld world;
+    Object obj;
+    obj.InitVerlet();
+    world.AddObject(&obj);
+    ASSERT_TRUE(world.LoadSnapshot(path));
+
+    EXPECT_FALSE(obj.body.IsValid());
+    EXPECT_EQ(world.GetBodyCount(), 0u);
+    world.Step(1.f / 60.f);   // must not touch obj
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, BadFilesLeaveTheWorldAlone) {
+    PhysicsWorld source;
+    BuildScene(source);
+    const std::string path = SnapshotPath("bad.pwsn");
+    ASSERT_TRUE(source.SaveSnapshot(path));
+
+    // Cut off halfway through the arrays
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+
+    PhysicsWorld world;
+    BodyHandle body = world.AddBody({.position = {7.f, 7.f}});
+    EXPECT_FALSE(world.LoadSnapshot(path));
+    EXPECT_FALSE(world.LoadSnapshot(SnapshotPath("does_not_exist.pwsn")));
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        bytes[4] ^= 0x7F;   // version
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    EXPECT_FALSE(world.LoadSnapshot(path));
+
+    ASSERT_TRUE(world.IsValid(body));
+    EXPECT_EQ(world.GetBodyCount(), 1u);
+    std::remove(path.c_str());
+}
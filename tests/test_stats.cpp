@@ -0,0 +1,50 @@
+//Step timings and counters
+
+#include <gtest/gtest.h>
+#include "PhysicsWorld.h"
+
+TEST(PhysicsStatsTest, HistoryWrapsAround) {
+    PhysicsStats stats(4);
+    for (int i = 0; i < 6; ++i) {
+        StepStats s;
+        s.contactsFound = static_cast<std::uint32_t>(i);
+        stats.Record(s);
+    }
+
+    EXPECT_EQ(stats.Count(), 4u);
+    EXPECT_EQ(stats.Last().contactsFound, 5u);
+    EXPECT_EQ(stats.Recent(3).contactsFound, 2u);
+    EXPECT_EQ(stats.Average().contactsFound, 3u);   // (2+3+4+5)/4, truncated
+}
+
+TEST(PhysicsStatsTest, StepRecordsCounters) {
+    if (!PhysicsStats::Enabled) GTEST_SKIP() << "stats compiled out";
+
+    PhysicsWorld world;
+    world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+    world.AddBody({.position = {15.f, 0.f}, .collider = MakeCircleCollider(10.f)});
+    world.AddBody({.position = {500.f, 0.f}, .isStatic = true, .collider = MakeCircleCollider(10.f)});
+
+    world.Step(1.f / 60.f);
+
+    const StepStats& last = world.GetStats().Last();
+    EXPECT_EQ(world.GetStats().Count(), 1u);
+    EXPECT_EQ(last.pairsTested, 1u);
+    EXPECT_EQ(last.contactsFound, 1u);
+    EXPECT_EQ(last.bodiesSkipped, 1u);
+    EXPECT_GE(last.totalMs, last.PhaseMs(StepPhase::Broadphase));
+}
+
+TEST(PhysicsStatsTest, ConstraintsCountedPerIteration) {
+    if (!PhysicsStats::Enabled) GTEST_SKIP() << "stats compiled out";
+
+    PhysicsWorld world;
+    world.SetConstraintIterations(3);
+    BodyHandle a = world.AddBody({.position = {0.f, 0.f}});
+    BodyHandle b = world.AddBody({.position = {10.f, 0.f}});
+    world.AddDistanceConstraint(a, b);
+
+    world.Step(1.f / 60.f);
+
+    EXPECT_EQ(world.GetStats().Last().constraintsSolved, 3u);
+}
@@ -0,0 +1,140 @@
+//Trajectory recorder: quantized round trip, chunk boundaries, handle reuse
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "PhysicsWorld.h"
+#include "TrajectoryRecorder.h"
+
+static std::string TrajectoryPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+static void BuildPile(PhysicsWorld& world) {
+    world.AddBody({.position = {0.f, 300.f}, .isStatic = true, .collider = MakeAABBCollider(800.f, 40.f)});
+    for (int i = 0; i < 60; ++i) {
+        const float x = static_cast<float>(i % 12) * 22.f - 130.f;
+        const float y = 200.f - static_cast<float>(i / 12) * 22.f;
+        world.AddBody({.position = {x, y}, .collider = i % 4 ? MakeCircleCollider(10.f) : MakeAABBCollider(16.f, 16.f)});
+    }
+}
+
+// Positions of every body after each step, straight from the world
+using Frames = std::vector<std::vector<sf::Vector2f>>;
+
+static Frames RecordSteps(PhysicsWorld& world, TrajectoryRecorder& recorder, const std::string& path, int steps) {
+    EXPECT_TRUE(recorder.Open(path));
+    world.SetRecorder(&recorder);
+    Frames frames;
+    for (int i = 0; i < steps; ++i) {
+        world.Step(1.f / 480.f);
+        frames.push_back(world.GetBodies().positions);
+    }
+    world.SetRecorder(nullptr);
+    recorder.Close();
+    return frames;
+}
+
+TEST(TrajectoryTest, ReplayMatchesWithinQuantum) {
+    PhysicsWorld world;
+    BuildPile(world);
+
+    TrajectoryRecorder recorder;
+    const std::string path = TrajectoryPath("pile.pwtr");
+    const Frames expected = RecordSteps(world, recorder, path, 200);
+    EXPECT_EQ(recorder.GetRecordedFrames(), 200u);
+    EXPECT_EQ(recorder.GetDroppedFrames(), 0u);
+
+    TrajectoryReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    const float tolerance = reader.GetQuantum() * 0.5f + 1e-4f;
+
+    TrajectoryFrame frame;
+    for (const auto& positions : expected) {
+        ASSERT_TRUE(reader.NextFrame(frame));
+        EXPECT_FLOAT_EQ(frame.dt, 1.f / 480.f);
+        ASSERT_EQ(frame.bodies.size(), positions.size());
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            EXPECT_EQ(frame.bodies[i].handle, world.GetBodies().HandleAt(static_cast<std::uint32_t>(i)));
+            EXPECT_NEAR(frame.bodies[i].position.x, positions[i].x, tolerance);
+            EXPECT_NEAR(frame.bodies[i].position.y, positions[i].y, tolerance);
+        }
+    }
+    EXPECT_FALSE(reader.NextFrame(frame));
+
+    // Shapes come through too, and Rewind starts over
+    ASSERT_TRUE(reader.Rewind());
+    ASSERT_TRUE(reader.NextFrame(frame));
+    EXPECT_EQ(frame.bodies[0].collider.type, ColliderType::AABB);
+    EXPECT_FLOAT_EQ(frame.bodies[0].collider.aabb.halfExtents.x, 400.f);
+    EXPECT_EQ(frame.bodies[2].collider.type, ColliderType::Circle);
+    EXPECT_FLOAT_EQ(frame.bodies[2].collider.circle.radius, 10.f);
+}
+
+// Tiny chunks: deltas run across chunk boundaries, keyframes every third chunk
+TEST(TrajectoryTest, SmallChunksDecodeAcrossBoundaries) {
+    PhysicsWorld world;
+    BuildPile(world);
+
+    TrajectoryRecorder recorder({.chunkBytes = 4096, .chunkCount = 63, .keyframeChunks = 3});
+    const std::string path = TrajectoryPath("chunks.pwtr");
+    const Frames expected = RecordSteps(world, recorder, path, 120);
+
+    TrajectoryReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    TrajectoryFrame frame;
+    std::size_t read = 0;
+    while (reader.NextFrame(frame)) {
+        // Dropped frames (writer behind) are skipped, so match by step count only when nothing dropped
+        if (recorder.GetDroppedFrames() == 0) {
+            for (std::size_t i = 0; i < frame.bodies.size(); ++i) {
+                EXPECT_NEAR(frame.bodies[i].position.x, expected[read][i].x, reader.GetQuantum());
+            }
+        }
+        ++read;
+    }
+    EXPECT_EQ(read, recorder.GetRecordedFrames());
+    EXPECT_EQ(read + recorder.GetDroppedFrames(), 120u);
+}
+
+// A removed body's slot gets reused with a new generation; the reader sees the new body
+TEST(TrajectoryTest, ReusedSlotIsANewBody) {
+    PhysicsWorld world;
+    BodyHandle first = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+
+    TrajectoryRecorder recorder;
+    const std::string path = TrajectoryPath("reuse.pwtr");
+    ASSERT_TRUE(recorder.Open(path));
+    world.SetRecorder(&recorder);
+    world.Step(1.f / 480.f);
+    world.RemoveBody(first);
+    BodyHandle second = world.AddBody({.position = {500.f, 0.f}, .collider = MakeAABBCollider(10.f, 10.f)});
+    world.Step(1.f / 480.f);
+    recorder.Close();
+
+    ASSERT_EQ(second.id, first.id);
+    TrajectoryReader reader;
+    ASSERT_TRUE(reader.Open(path));
+    TrajectoryFrame frame;
+    ASSERT_TRUE(reader.NextFrame(frame));
+    EXPECT_EQ(frame.bodies[0].handle, first);
+    ASSERT_TRUE(reader.NextFrame(frame));
+    ASSERT_EQ(frame.bodies.size(), 1u);
+    EXPECT_EQ(frame.bodies[0].handle, second);
+    EXPECT_EQ(frame.bodies[0].collider.type, ColliderType::AABB);
+    EXPECT_NEAR(frame.bodies[0].position.x, 500.f, reader.GetQuantum());
+}
+
+TEST(TrajectoryTest, RejectsOtherFiles) {
+    PhysicsWorld world;
+    BuildPile(world);
+    const std::string path = TrajectoryPath("not_a_trajectory.pwsn");
+    ASSERT_TRUE(world.SaveSnapshot(path));
+
+    TrajectoryReader reader;
+    EXPECT_FALSE(reader.Open(path));
+    EXPECT_FALSE(reader.Open(TrajectoryPath("missing.pwtr")));
+    TrajectoryFrame frame;
+    EXPECT_FALSE(reader.NextFrame(frame));
+}
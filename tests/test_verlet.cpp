@@ -83,3 +83,132 @@ TEST_F(VerletTest, SetVelocityWorks) {
     EXPECT_NEAR(actualVel.y, targetVel.y, 0.001f);
 }
 
+
+// ============ FIXED TIMESTEP TESTS ============
+
+TEST(FixedTimestepTest, RunsWholeStepsOnly) {
+    PhysicsWorld world;
+    world.SetFixedTimestep(1.f / 100.f);
+
+    EXPECT_EQ(world.Update(0.025f), 2);
+    EXPECT_NEAR(world.GetInterpolationAlpha(), 0.5f, 0.001f);
+    EXPECT_EQ(world.Update(0.005f), 1);   // leftover carries over
+    EXPECT_EQ(world.Update(0.001f), 0);
+}
+
+TEST(FixedTimestepTest, HitchIsCappedAtMaxSteps) {
+    PhysicsWorld world;
+    world.SetFixedTimestep(1.f / 100.f, 4);
+
+    EXPECT_EQ(world.Update(1.f), 4);
+    EXPECT_LT(world.GetInterpolationAlpha(), 1.f);
+    EXPECT_EQ(world.Update(0.f), 0);   // backlog was dropped, not queued
+}
+
+TEST(FixedTimestepTest, SameResultForAnyFrameRate) {
+    auto run = [](float frameDt, int frames) {
+        PhysicsWorld world;
+        world.SetFixedTimestep(1.f / 120.f);
+        BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+        for (int i = 0; i < frames; ++i) world.Update(frameDt);
+        return world.GetPosition(ball);
+    };
+
+    // 1 second either way, slightly over so float error can't drop the last step
+    sf::Vector2f at30 = run(1.f / 30.f + 1e-6f, 30);
+    sf::Vector2f at120 = run(1.f / 120.f + 1e-6f, 120);
+
+    EXPECT_EQ(at30.y, at120.y);
+}
+
+TEST(FixedTimestepTest, InterpolatesBetweenSteps) {
+    PhysicsWorld world;
+    world.SetFixedTimestep(1.f / 100.f);
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    world.SetVelocity(ball, {100.f, 0.f}, 1.f / 100.f);
+
+    world.Update(0.015f);   // one step + half a step left over
+
+    const BodyStore& bodies = world.GetBodies();
+    std::uint32_t index = bodies.IndexOf(ball);
+    float previous = bodies.previousPositions[index].x;
+    float current = bodies.positions[index].x;
+    EXPECT_NEAR(world.GetInterpolatedPosition(ball).x, (previous + current) * 0.5f, 0.01f);
+    EXPECT_LT(previous, current);
+}
+
+// ============ ADAPTIVE SUBSTEP TESTS ============
+
+TEST(AdaptiveSubstepTest, RestingSceneDropsToMinimum) {
+    PhysicsWorld world;
+    world.SetAdaptiveSubsteps(2, 16);
+    world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+    world.AddBody({.position = {0.f, 80.f}, .collider = MakeCircleCollider(10.f)});   // sitting on it
+
+    for (int i = 0; i < 120; ++i) world.Update(1.f / 60.f);
+    EXPECT_EQ(world.GetSubsteps(), 2);
+    EXPECT_FLOAT_EQ(world.GetFixedTimestep(), 1.f / 120.f);
+}
+
+TEST(AdaptiveSubstepTest, FastBodyRaisesSubstepsRightAway) {
+    PhysicsWorld world;
+    world.SetAdaptiveSubsteps(2, 16);
+    for (int i = 0; i < 60; ++i) world.Update(1.f / 60.f);   // nothing there, settles at 2
+    ASSERT_EQ(world.GetSubsteps(), 2);
+
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    world.SetVelocity(ball, {3000.f, 0.f}, world.GetFixedTimestep());   // 50 units a frame, 5x its size
+    world.Update(1.f / 60.f);
+    EXPECT_EQ(world.GetSubsteps(), 16);
+}
+
+TEST(AdaptiveSubstepTest, VelocitySurvivesStepChange) {
+    PhysicsWorld world;
+    world.SetAdaptiveSubsteps(2, 16);
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(5.f)});
+    world.SetVelocity(ball, {600.f, 0.f}, world.GetFixedTimestep());
+
+    const float before = world.GetPosition(ball).x;
+    world.Update(1.f / 60.f);   // substeps change before stepping
+    ASSERT_NE(world.GetSubsteps(), 8);
+
+    // Gravity is along y, so x moved at exactly the velocity set: 10 units in 1/60 s
+    EXPECT_NEAR(world.GetPosition(ball).x - before, 10.f, 0.01f);
+}
+
+TEST(AdaptiveSubstepTest, NoTunnelingThroughThinFloor) {
+    auto fallThrough = [](bool adaptive) {
+        PhysicsWorld world;
+        if (adaptive) world.SetAdaptiveSubsteps(2, 32);
+        else world.SetFixedTimestep(1.f / 120.f);   // the adaptive minimum, fixed
+
+        world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 4.f)});
+        BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(3.f)});
+        world.SetVelocity(ball, {0.f, 4000.f}, world.GetFixedTimestep());
+        for (int i = 0; i < 30; ++i) world.Update(1.f / 60.f);
+        return world.GetPosition(ball).y > 100.f;
+    };
+
+    EXPECT_TRUE(fallThrough(false));
+    EXPECT_FALSE(fallThrough(true));
+}
+
+// Same drop with CCD: the ball is swept instead, so substeps only ever come down
+TEST(AdaptiveSubstepTest, ContinuousCollisionKeepsSubstepsLow) {
+    PhysicsWorld world;
+    world.SetAdaptiveSubsteps(2, 32);
+    world.SetContinuousCollision(true);
+
+    world.AddBody({.position = {0.f, 100.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 4.f)});
+    BodyHandle ball = world.AddBody({.position = {0.f, 0.f}, .collider = MakeCircleCollider(3.f)});
+    world.SetVelocity(ball, {0.f, 4000.f}, world.GetFixedTimestep());
+    int substeps = world.GetSubsteps();
+    for (int i = 0; i < 30; ++i) {
+        world.Update(1.f / 60.f);
+        EXPECT_LE(world.GetSubsteps(), substeps) << "frame " << i;
+        substeps = world.GetSubsteps();
+    }
+
+    EXPECT_LT(world.GetPosition(ball).y, 100.f);
+    EXPECT_EQ(substeps, 2);
+}
@@ -0,0 +1,92 @@
+//WorldBatch: same results as stepping alone, packing, work stealing
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "PhysicsWorld.h"
+#include "WorldBatch.h"
+
+// Small pile on a floor plus a swinging chain; `variant` changes the bounciness
+static void BuildSweepWorld(PhysicsWorld& world, int variant, int balls = 12) {
+    world.AddBody({.position = {0.f, 200.f}, .isStatic = true, .collider = MakeAABBCollider(400.f, 20.f)});
+    const float bounciness = 0.1f + 0.8f * static_cast<float>(variant % 10) / 10.f;
+    for (int i = 0; i < balls; ++i) {
+        world.AddBody({.position = {-60.f + (i % 6) * 20.f, 100.f - (i / 6) * 20.f}, .bounciness = bounciness,
+                       .collider = MakeCircleCollider(8.f)});
+    }
+
+    BodyHandle previous = world.AddBody({.position = {150.f, 0.f}, .isStatic = true});
+    for (int k = 1; k <= 5; ++k) {
+        BodyHandle link = world.AddBody({.position = {150.f + k * 10.f, 0.f}});
+        world.AddDistanceConstraint(previous, link);
+        previous = link;
+    }
+}
+
+TEST(WorldBatchTest, MatchesSteppingEachWorldAlone) {
+    constexpr int Worlds = 40;
+    WorldBatch batch(4);
+    std::vector<PhysicsWorld> alone(Worlds);
+    for (int i = 0; i < Worlds; ++i) {
+        BuildSweepWorld(batch.AddWorld(), i);
+        alone[i].SetThreadCount(1);
+        BuildSweepWorld(alone[i], i);
+    }
+
+    batch.Step(1.f / 480.f, 300);
+    for (auto& world : alone) {
+        for (int s = 0; s < 300; ++s) world.Step(1.f / 480.f);
+    }
+
+    for (int i = 0; i < Worlds; ++i) {
+        const auto& expected = alone[i].GetBodies().positions;
+        const auto& actual = batch.GetWorld(i).GetBodies().positions;
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t b = 0; b < actual.size(); ++b) {
+            EXPECT_EQ(actual[b].x, expected[b].x) << "world " << i << " body " << b;
+            EXPECT_EQ(actual[b].y, expected[b].y) << "world " << i << " body " << b;
+        }
+    }
+
+    // Different bounciness, different outcome: the worlds really are separate
+    EXPECT_NE(batch.GetWorld(0).GetBodies().positions[1].y, batch.GetWorld(5).GetBodies().positions[1].y);
+}
+
+TEST(WorldBatchTest, PacksSmallWorldsAndIsolatesBigOnes) {
+    WorldBatch batch(2);
+    batch.SetPackBodies(100);
+    for (int i = 0; i < 20; ++i) BuildSweepWorld(batch.AddWorld(), i, 4);   // 11 bodies each
+    BuildSweepWorld(batch.AddWorld(), 0, 300);
+    for (int i = 0; i < 5; ++i) BuildSweepWorld(batch.AddWorld(), i, 4);
+
+    batch.Update(1.f / 60.f, 3);
+
+    PhysicsWorld alone;
+    BuildSweepWorld(alone, 0, 4);
+    int steps = 0;
+    for (int f = 0; f < 3; ++f) steps += alone.Update(1.f / 60.f);
+
+    // 9 small worlds per task: 20 -> 3 tasks, the big one alone, the last 5 in one
+    EXPECT_EQ(batch.GetTaskCount(), 5u);
+    for (std::size_t i = 0; i < batch.GetWorldCount(); ++i) {
+        EXPECT_EQ(batch.GetWorld(i).GetStats().Count(), static_cast<std::size_t>(steps)) << "world " << i;
+    }
+}
+
+TEST(WorldBatchTest, StealingRunsEveryIndexOnce) {
+    ThreadPool pool(4);
+    constexpr std::size_t Count = 1000;
+    std::vector<std::atomic<int>> visits(Count);
+    std::atomic<unsigned> threadsSeen{0};
+
+    // First items are far heavier, so the thread that owns them needs help
+    pool.ParallelForStealing(Count, [&](unsigned thread, std::size_t index) {
+        volatile float sink = 0.f;
+        for (int k = 0; k < (index < 50 ? 200000 : 100); ++k) sink = sink + 1.f;
+        visits[index].fetch_add(1);
+        threadsSeen.fetch_or(1u << thread);
+    });
+
+    for (std::size_t i = 0; i < Count; ++i) EXPECT_EQ(visits[i].load(), 1) << i;
+    EXPECT_EQ(threadsSeen.load(), 0xFu);
+}